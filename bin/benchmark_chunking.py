@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+import sys,os,argparse
+import time
+import random
+from larcv import larcv
+
+# This script writes synthetic sparse3d files with different HDF5 chunk sizes,
+# and measures how fast they read back, in order and in random order, for
+# several chunk cache sizes.  Use it to pick ChunkSize / ChunkCacheBytes
+# for the IOManager on a given file system.
+
+parser = argparse.ArgumentParser(description='LArCV3 chunking and chunk cache benchmark')
+
+parser.add_argument('-ne','--num-events',
+                    type=int, dest='nevents', default=500,
+                    help='integer, Number of events per file')
+
+parser.add_argument('-nv','--num-voxels',
+                    type=int, dest='nvoxels', default=2000,
+                    help='integer, Average number of voxels per event')
+
+parser.add_argument('-nr','--num-reads',
+                    type=int, dest='nreads', default=200,
+                    help='integer, Number of events to read per measurement')
+
+parser.add_argument('-cs','--chunk-sizes',
+                    type=int, dest='chunk_sizes', nargs='+', default=[0, 1000, 10000, 100000],
+                    help='list, Voxel chunk sizes to write (0 for the automatic choice)')
+
+parser.add_argument('-cb','--cache-bytes',
+                    type=int, dest='cache_bytes', nargs='+', default=[0, 4*1024*1024, 32*1024*1024],
+                    help='list, Chunk cache sizes in bytes to read with (0 for the HDF5 default)')
+
+parser.add_argument('-od','--output-dir',
+                    type=str, dest='output_dir', default='./',
+                    help='string, Directory for the synthetic files')
+
+args = parser.parse_args()
+
+
+def write_file(file_name, chunk_size):
+
+    io_manager = larcv.IOManager(larcv.IOManager.kWRITE)
+    io_manager.set_out_file(file_name)
+    io_manager.set_chunk_size("sparse3d", chunk_size)
+    io_manager.initialize()
+
+    meta = larcv.ImageMeta3D()
+    for dim in range(3):
+        meta.set_dimension(dim, 100., 512)
+    meta.set_projection_id(0)
+
+    rng = random.Random(0)
+    for i in range(args.nevents):
+        io_manager.set_id(1, 0, i)
+        ev_sparse = io_manager.get_data("sparse3d","bench")
+
+        n_voxels = rng.randint(args.nvoxels // 2, 3 * args.nvoxels // 2)
+        vs = larcv.VoxelSet()
+        for index in sorted(rng.sample(range(512**3), n_voxels)):
+            vs.emplace(index, rng.uniform(0, 10), False)
+        ev_sparse.set(vs, meta)
+        io_manager.save_entry()
+
+    io_manager.finalize()
+
+
+def read_file(file_name, cache_bytes, entries):
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(file_name)
+    io_manager.set_chunk_cache(cache_bytes)
+    io_manager.initialize()
+
+    start = time.time()
+    for entry in entries:
+        io_manager.read_entry(entry)
+        io_manager.get_data("sparse3d","bench")
+    elapsed = time.time() - start
+
+    io_manager.finalize()
+    return len(entries) / elapsed
+
+
+if __name__ == '__main__':
+
+    n_reads = min(args.nreads, args.nevents)
+    serial_entries = list(range(n_reads))
+    random_entries = random.Random(1).sample(range(args.nevents), n_reads)
+
+    print("{:>12} {:>10} {:>12} {:>18} {:>18}".format(
+        "chunk size", "file MB", "cache bytes", "serial events/s", "random events/s"))
+
+    for chunk_size in args.chunk_sizes:
+        file_name = os.path.join(args.output_dir, "benchmark_chunking_{}.h5".format(chunk_size))
+        write_file(file_name, chunk_size)
+        size_mb = os.path.getsize(file_name) / 1024.**2
+
+        for cache_bytes in args.cache_bytes:
+            serial_rate = read_file(file_name, cache_bytes, serial_entries)
+            random_rate = read_file(file_name, cache_bytes, random_entries)
+            print("{:>12} {:>10.1f} {:>12} {:>18.1f} {:>18.1f}".format(
+                chunk_size if chunk_size else "auto", size_mb, cache_bytes, serial_rate, random_rate))
+
+        os.remove(file_name)
@@ -0,0 +1,158 @@
+#!/usr/bin/env python
+import sys,os,argparse
+import time
+import random
+from larcv import larcv
+
+# This script writes a synthetic, chunked sparse3d file and reads one epoch of it
+# in several orders: serial, random blocks of a batch, fully random events, and
+# the ShardSampler's block shuffle (chunk-aligned groups, mixed in a window) for
+# a few window sizes.  For each it prints the read rate and two mixing metrics:
+#   step   - mean distance between consecutive entries, over that of a random
+#            order (about 1 for random access, about 0 for serial access)
+#   chunks - distinct chunks per batch over the batch size (1 when every entry
+#            of a batch comes from a chunk of its own)
+
+parser = argparse.ArgumentParser(description='LArCV3 shuffle locality benchmark')
+
+parser.add_argument('-ne','--num-events',
+                    type=int, dest='nevents', default=2000,
+                    help='integer, Number of events in the file')
+
+parser.add_argument('-nv','--num-voxels',
+                    type=int, dest='nvoxels', default=1000,
+                    help='integer, Average number of voxels per event')
+
+parser.add_argument('-nr','--num-reads',
+                    type=int, dest='nreads', default=500,
+                    help='integer, Number of events to read per measurement')
+
+parser.add_argument('-b','--batch-size',
+                    type=int, dest='batch_size', default=32,
+                    help='integer, Batch size for the random blocks and the chunks metric')
+
+parser.add_argument('-cs','--chunk-size',
+                    type=int, dest='chunk_size', default=20000,
+                    help='integer, Voxel chunk size to write (0 for the automatic choice)')
+
+parser.add_argument('-cb','--cache-bytes',
+                    type=int, dest='cache_bytes', default=16*1024*1024,
+                    help='integer, Chunk cache size in bytes to read with (0 for the HDF5 default)')
+
+parser.add_argument('-w','--windows',
+                    type=int, dest='windows', nargs='+', default=[2, 8, 32],
+                    help='list, Block shuffle windows, in groups')
+
+parser.add_argument('-od','--output-dir',
+                    type=str, dest='output_dir', default='./',
+                    help='string, Directory for the synthetic file')
+
+args = parser.parse_args()
+
+
+def write_file(file_name):
+
+    io_manager = larcv.IOManager(larcv.IOManager.kWRITE)
+    io_manager.set_out_file(file_name)
+    io_manager.set_chunk_size("sparse3d", args.chunk_size)
+    io_manager.initialize()
+
+    meta = larcv.ImageMeta3D()
+    for dim in range(3):
+        meta.set_dimension(dim, 100., 512)
+    meta.set_projection_id(0)
+
+    rng = random.Random(0)
+    for i in range(args.nevents):
+        io_manager.set_id(1, 0, i)
+        ev_sparse = io_manager.get_data("sparse3d","bench")
+
+        n_voxels = rng.randint(args.nvoxels // 2, 3 * args.nvoxels // 2)
+        vs = larcv.VoxelSet()
+        for index in sorted(rng.sample(range(512**3), n_voxels)):
+            vs.emplace(index, rng.uniform(0, 10), False)
+        ev_sparse.set(vs, meta)
+        io_manager.save_entry()
+
+    io_manager.finalize()
+
+
+def open_file(file_name):
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(file_name)
+    io_manager.set_chunk_cache(args.cache_bytes)
+    io_manager.initialize()
+    return io_manager
+
+
+def read_rate(file_name, entries):
+
+    io_manager = open_file(file_name)
+    start = time.time()
+    for entry in entries:
+        io_manager.read_entry(entry)
+        io_manager.get_data("sparse3d","bench")
+    elapsed = time.time() - start
+
+    io_manager.finalize()
+    return len(entries) / elapsed
+
+
+def mixing(order, group_size):
+
+    # Consecutive entries of a random permutation of n are n/3 apart on average:
+    n = len(order)
+    step = sum(abs(a - b) for a, b in zip(order[1:], order[:-1])) / (n - 1.) / (n / 3.)
+
+    n_batches = n // args.batch_size
+    chunks = 0
+    for i in range(n_batches):
+        batch = order[i * args.batch_size:(i + 1) * args.batch_size]
+        chunks += len(set(entry // group_size for entry in batch))
+    chunks /= float(n_batches * args.batch_size)
+    return step, chunks
+
+
+def block_shuffle(group_size, window):
+
+    cfg = larcv.PSet("ShardSampler")
+    cfg["GroupSize"] = str(group_size)
+    cfg["Window"]    = str(window * group_size)
+    cfg["Seed"]      = "1"
+    sampler = larcv.ShardSampler()
+    sampler.configure(cfg)
+    sampler.set_file_entries([args.nevents])
+    return list(sampler.entries())
+
+
+if __name__ == '__main__':
+
+    file_name = os.path.join(args.output_dir, "benchmark_shuffle.h5")
+    write_file(file_name)
+
+    io_manager = open_file(file_name)
+    group_size = io_manager.entries_per_chunk("sparse3d", "bench")
+    io_manager.finalize()
+    print("{} events, {} entries per chunk, batch size {}".format(
+        args.nevents, group_size, args.batch_size))
+
+    rng = random.Random(1)
+    orders = [("serial", list(range(args.nevents)))]
+
+    blocks = list(range(0, args.nevents - args.batch_size + 1, args.batch_size))
+    rng.shuffle(blocks)
+    orders.append(("random blocks", [start + i for start in blocks for i in range(args.batch_size)]))
+
+    orders.append(("random events", rng.sample(range(args.nevents), args.nevents)))
+
+    for window in args.windows:
+        orders.append(("block shuffle {}".format(window), block_shuffle(group_size, window)))
+
+    print("{:>20} {:>12} {:>8} {:>8}".format("order", "events/s", "step", "chunks"))
+    for name, order in orders:
+        rate = read_rate(file_name, order[:args.nreads])
+        step, chunks = mixing(order, group_size)
+        print("{:>20} {:>12.1f} {:>8.3f} {:>8.3f}".format(name, rate, step, chunks))
+
+    os.remove(file_name)
@@ -0,0 +1,112 @@
+#!/usr/bin/env python
+import sys,os,argparse
+import time
+import threading
+import numpy
+from larcv import larcv, data_generator
+
+# This script times independent IOManagers, one per thread and file, against
+# reading the same files one after the other.  read_entry and get_data release
+# the GIL, so the threads overlap as far as the (serialized) HDF5 calls allow:
+#   - sparse3d, read back voxel by voxel
+#   - tensor3d, read and downsampled (compress is GIL free too), where most of
+#     the work per entry is outside of HDF5
+# A speedup needs a free core per thread.
+
+parser = argparse.ArgumentParser(description='LArCV3 threaded read benchmark')
+
+parser.add_argument('-nt','--num-threads',
+                    type=int, dest='nthreads', nargs='+', default=[2, 4],
+                    help='list, Numbers of threads (and files) to read with')
+
+parser.add_argument('-ne','--num-events',
+                    type=int, dest='nevents', default=200,
+                    help='integer, Number of events per sparse file')
+
+parser.add_argument('-nd','--num-dense-events',
+                    type=int, dest='ndense', default=20,
+                    help='integer, Number of events per dense file')
+
+parser.add_argument('-s','--size',
+                    type=int, dest='size', default=64,
+                    help='integer, Voxels per side of the dense 3D tensors')
+
+parser.add_argument('-od','--output-dir',
+                    type=str, dest='output_dir', default='./',
+                    help='string, Directory for the synthetic files')
+
+args = parser.parse_args()
+
+
+def time_reads(read, file_names):
+
+    start = time.time()
+    for file_name in file_names:
+        read(file_name)
+    serial_time = time.time() - start
+
+    threads = [ threading.Thread(target=read, args=(file_name,)) for file_name in file_names ]
+    start = time.time()
+    for thread in threads: thread.start()
+    for thread in threads: thread.join()
+    threaded_time = time.time() - start
+
+    return serial_time, threaded_time
+
+
+def benchmark_sparse(n_threads):
+
+    file_names = [ os.path.join(args.output_dir, "benchmark_threaded_read_sparse_{}.h5".format(i))
+                   for i in range(n_threads) ]
+    for file_name in file_names:
+        voxel_set_list = data_generator.build_sparse_tensor(args.nevents, n_projections = 2)
+        data_generator.write_sparse_tensors(file_name, voxel_set_list, 3, 2)
+
+    serial_time, threaded_time = time_reads(
+        lambda file_name: data_generator.read_sparse_tensors(file_name, 3), file_names)
+
+    for file_name in file_names:
+        os.remove(file_name)
+    return serial_time, threaded_time
+
+
+def benchmark_dense(n_threads):
+
+    file_names = [ os.path.join(args.output_dir, "benchmark_threaded_read_dense_{}.h5".format(i))
+                   for i in range(n_threads) ]
+    for file_name in file_names:
+        images = [ [ numpy.random.random_sample([args.size]*3).astype("float32") ]
+                   for i in range(args.ndense) ]
+        data_generator.write_tensor(file_name, images, 3)
+
+    def read(file_name):
+        io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+        io_manager.add_in_file(file_name)
+        io_manager.initialize()
+        for i in range(io_manager.get_n_entries()):
+            io_manager.read_entry(i)
+            ev_tensor = io_manager.get_data("tensor3d","test")
+            ev_tensor.tensor(0).compress(2, larcv.kPoolAverage).compress(2, larcv.kPoolMax)
+        io_manager.finalize()
+
+    serial_time, threaded_time = time_reads(read, file_names)
+
+    for file_name in file_names:
+        os.remove(file_name)
+    return serial_time, threaded_time
+
+
+if __name__ == '__main__':
+
+    print("{:>10} {:>8} {:>10} {:>12} {:>8}".format(
+        "data", "threads", "serial s", "threaded s", "speedup"))
+
+    for n_threads in args.nthreads:
+        serial_time, threaded_time = benchmark_sparse(n_threads)
+        print("{:>10} {:>8} {:>10.3f} {:>12.3f} {:>8.2f}".format(
+            "sparse3d", n_threads, serial_time, threaded_time, serial_time / threaded_time))
+
+    for n_threads in args.nthreads:
+        serial_time, threaded_time = benchmark_dense(n_threads)
+        print("{:>10} {:>8} {:>10.3f} {:>12.3f} {:>8.2f}".format(
+            "tensor3d", n_threads, serial_time, threaded_time, serial_time / threaded_time))
@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+import sys,os,argparse
+import time
+import numpy
+import larcv
+from larcv import queueloader, data_generator
+from collections import OrderedDict
+
+# This script times the strided copies between numpy and larcv dense tensors:
+#   - larcv.Tensor3D from a C-ordered array, from its transpose, and from a
+#     strided slice, against numpy.ascontiguousarray of the same views
+#   - BatchFillerTensor3D filling dense batches (channels interleaved last),
+#     against numpy.stack of the same tensors
+# Rates are in MB of float32 output per second.
+
+parser = argparse.ArgumentParser(description='LArCV3 dense tensor copy benchmark')
+
+parser.add_argument('-s','--size',
+                    type=int, dest='size', default=128,
+                    help='integer, Voxels per side of the 3D tensors')
+
+parser.add_argument('-c','--channels',
+                    type=int, dest='channels', default=2,
+                    help='integer, Channels (projections) per event')
+
+parser.add_argument('-ne','--num-events',
+                    type=int, dest='nevents', default=20,
+                    help='integer, Number of events to write and read')
+
+parser.add_argument('-b','--batch-size',
+                    type=int, dest='batch_size', default=4,
+                    help='integer, Batch size to read')
+
+parser.add_argument('-od','--output-dir',
+                    type=str, dest='output_dir', default='./',
+                    help='string, Directory for the synthetic file')
+
+args = parser.parse_args()
+
+queue_io_cfg_template = '''
+{name}: {{
+  Verbosity:       3
+  EnableFilter:    false
+  RandomAccess:    0
+  RandomSeed:      0
+  InputFiles:      [{input_files}]
+  ProcessType:     ["BatchFillerTensor3D"]
+  ProcessName:     ["{name}_dense"]
+
+  ProcessList: {{
+    {name}_dense: {{
+      TensorProducer: "test"
+      TensorType: "dense"
+      Channels: {channels}
+    }}
+  }}
+}}
+'''
+
+
+def rate(n_bytes, function, repeat=5):
+    function()
+    start = time.time()
+    for i in range(repeat):
+        function()
+    return repeat * n_bytes / 1024.**2 / (time.time() - start)
+
+
+def benchmark_tensor():
+
+    array = numpy.random.random([args.size]*3).astype("float32")
+    views = [
+        ("C-ordered",      array),
+        ("transposed",     array.transpose()),
+        ("axes (1, 2, 0)", array.transpose(1, 2, 0)),
+        ("step 2 slice",   numpy.random.random([2*args.size]*3).astype("float32")[::2, ::2, ::2]),
+    ]
+
+    print("{:>16} {:>16} {:>16}".format("Tensor3D from", "larcv MB/s", "numpy MB/s"))
+    for name, view in views:
+        larcv_rate = rate(view.nbytes, lambda: larcv.Tensor3D(view))
+        numpy_rate = rate(view.nbytes, lambda: numpy.ascontiguousarray(view))
+        print("{:>16} {:>16.1f} {:>16.1f}".format(name, larcv_rate, numpy_rate))
+
+
+def benchmark_filler():
+
+    file_name = os.path.join(args.output_dir, "benchmark_transpose.h5")
+    images = data_generator.build_tensor(args.nevents, n_projections=args.channels,
+                                         dimension=3, shape=[args.size]*3)
+    data_generator.write_tensor(file_name, images, dimension=3)
+
+    config_file = os.path.join(args.output_dir, "benchmark_transpose.cfg")
+    with open(config_file, 'w') as _f:
+        _f.write(queue_io_cfg_template.format(name="benchmark_transpose", input_files=file_name,
+                                              channels=list(range(args.channels))))
+
+    io_config = {
+        'filler_name' : "benchmark_transpose",
+        'filler_cfg'  : config_file,
+        'verbosity'   : 3,
+        'make_copy'   : False
+    }
+    data_keys = OrderedDict({'image': 'benchmark_transpose_dense'})
+
+    li = queueloader.queue_interface(random_access_mode="serial_access")
+    li.prepare_manager('primary', io_config, args.batch_size, data_keys)
+
+    n_batches = args.nevents // args.batch_size
+    batch_bytes = 4 * args.batch_size * args.channels * args.size**3
+
+    start = time.time()
+    for i in range(n_batches):
+        li.fetch_minibatch_data('primary', pop=True)
+        li.prepare_next('primary')
+    filler_rate = n_batches * batch_bytes / 1024.**2 / (time.time() - start)
+
+    batch = images[:args.batch_size]
+    numpy_rate = rate(batch_bytes,
+        lambda: numpy.stack([numpy.stack(event, axis=-1) for event in batch]))
+
+    print("{:>16} {:>16} {:>16}".format("dense batches", "larcv MB/s", "numpy MB/s"))
+    print("{:>16} {:>16.1f} {:>16.1f}".format(
+        "{}^3 x {}".format(args.size, args.channels), filler_rate, numpy_rate))
+    print("(the larcv rate includes reading and decompressing the file)")
+
+    os.remove(file_name)
+    os.remove(config_file)
+
+
+if __name__ == '__main__':
+    benchmark_tensor()
+    benchmark_filler()
@@ -0,0 +1,40 @@
+#!/usr/bin/env python
+import argparse
+import time
+from larcv import larcv
+
+# This script inspects a list of larcv3 files once and writes a manifest of
+# them: entries per file, products, dataset sizes, and (unless disabled) the
+# voxels of every entry of the sparse products.  Give the manifest to the
+# IOManager (set_manifest, or Manifest in the configuration) and it no longer
+# opens every input file at initialize.  Rebuild it whenever the files change.
+
+parser = argparse.ArgumentParser(description='LArCV3 manifest generation')
+
+parser.add_argument('-il','--input-larcv', required=True,
+                    dest='larcv_fin', nargs='+',
+                    help='string or list, Input larcv file name[s] (Required)')
+
+parser.add_argument('-o','--output', required=True,
+                    type=str, dest='output',
+                    help='string, Output manifest file name (Required)')
+
+parser.add_argument('--no-voxel-counts',
+                    dest='voxel_counts', action='store_false',
+                    help='Do not count the voxels of every entry of sparse products')
+
+args = parser.parse_args()
+
+
+if __name__ == '__main__':
+
+    start = time.time()
+    manifest = larcv.Manifest()
+    manifest.build(args.larcv_fin, args.voxel_counts)
+    manifest.write(args.output)
+
+    print("Wrote {} with {} files and {} entries in {:.1f} s".format(
+        args.output, manifest.n_files(), manifest.offsets()[-1], time.time() - start))
+    for product in manifest.products():
+        counts = " (voxel counts)" if manifest.has_voxel_counts(product) else ""
+        print("  {} {}{}".format(product[0], product[1], counts))
@@ -7,6 +7,8 @@ class batch_pydata(object):
    _storage_id   = -1
    _dtype        = None
    _npy_data     = None
+   _npy_offsets  = None
+   _npy_coordinates = None
    _dim_data     = None
    _dim_dense    = None
    _time_copy    = 0
@@ -17,6 +19,8 @@ class batch_pydata(object):
       self._storage_id   = -1
       self._dtype        = dtype
       self._npy_data     = None
+      self._npy_offsets  = None
+      self._npy_coordinates = None
       self._dim_data     = None
       self._dim_dense    = None
       self._time_copy    = None
@@ -46,6 +50,8 @@ class batch_pydata(object):
          [type] -- [description]
       '''
       if shape is None:
+         if self._npy_offsets is not None:
+            return self._npy_data
          return numpy.reshape(self._npy_data, self._dim_data)
       elif shape == "dense":
          return self.as_dense(channels)
@@ -57,6 +63,14 @@ class batch_pydata(object):
    def dim(self):  
       return self._dim_data
 
+   def offsets(self):
+      '''First row of each entry of a ragged batch, plus the total (None if not ragged)'''
+      return self._npy_offsets
+
+   def coordinates(self):
+      '''int32 coordinates of each row of a ragged batch, batch index first (None if there are none)'''
+      return self._npy_coordinates
+
    def time_copy(self): 
       return self._time_copy
 
@@ -94,11 +108,28 @@ class batch_pydata(object):
 
 
 
+      # Ragged batches come shaped (total rows, row...), with offsets per entry:
+      if larcv_batchdata.is_ragged():
+         self._npy_offsets = larcv_batchdata.pyoffsets()
+         if self._make_copy:
+            self._npy_offsets = numpy.copy(self._npy_offsets)
+      else:
+         self._npy_offsets = None
+
+      # Sparse convolution batches also carry one row of int32 coordinates per data row:
+      if larcv_batchdata.coordinate_width() > 0:
+         self._npy_coordinates = larcv_batchdata.pycoordinates()
+         if self._make_copy:
+            self._npy_coordinates = numpy.copy(self._npy_coordinates)
+      else:
+         self._npy_coordinates = None
+
       self._time_copy = time.time() - ctime
 
 
       ctime = time.time()
-      self._npy_data = numpy.reshape(self._npy_data, self._dim_data)
+      if self._npy_offsets is None:
+         self._npy_data = numpy.reshape(self._npy_data, self._dim_data)
       # self._npy_data = self._npy_data.reshape(self._dim_data[0], int(self.batch_data_size()/self._dim_data[0]))
       self.time_data_conv = time.time() - ctime
 
@@ -119,8 +150,65 @@ class batch_pydata(object):
       # shape (batchsize, n_elements, 3 or 4) where the 3 or 4 
       # is if values are included or not
 
+      # Ragged data is (n_points, 4): (channel, x, y, value) in 2D, (x, y, z, value) in 3D
 
+      # Sparse convolution data is (n_points, features) with int32 coordinates
+      # (batch, x, y) or (batch, channel, x, y) in 2D, (batch, x, y, z) in 3D
 
+      if self._npy_coordinates is not None:
+         coords = self._npy_coordinates
+         if len(self._dense_dim) == 4:
+            # This is 2D
+            output_array = numpy.zeros(
+               [self._dense_dim[0], self._dense_dim[2], self._dense_dim[1], self._dense_dim[3]],
+               dtype=self._dtype)
+            if coords.shape[1] == 3:
+               output_array[coords[:,0], coords[:,2], coords[:,1], :] = self._npy_data
+            else:
+               output_array[coords[:,0], coords[:,3], coords[:,2], coords[:,1]] = self._npy_data[:,0]
+            if channels != "last":
+               output_array = numpy.ascontiguousarray(numpy.moveaxis(output_array, -1, 1))
+         else:
+            # This is 3D
+            output_array = numpy.zeros(list(self._dense_dim), dtype=self._dtype)
+            output_array[coords[:,0], coords[:,1], coords[:,2], coords[:,3], 0] = self._npy_data[:,0]
+            if channels != "last":
+               output_array = numpy.ascontiguousarray(numpy.moveaxis(output_array, -1, 1))
+         return output_array
+
+      if self._npy_offsets is not None:
+         batch_index = numpy.repeat(numpy.arange(len(self._npy_offsets) - 1),
+                                    numpy.diff(self._npy_offsets))
+         values = self._npy_data[:,-1]
+         if len(self._dense_dim) == 4:
+            # This is 2D
+            plane_index = numpy.int32(self._npy_data[:,0])
+            x_index     = numpy.int32(self._npy_data[:,1])
+            y_index     = numpy.int32(self._npy_data[:,2])
+            if channels == "last":
+               output_array = numpy.zeros(
+                  [self._dense_dim[0], self._dense_dim[2], self._dense_dim[1], self._dense_dim[3]],
+                  dtype=self._dtype)
+               output_array[batch_index, y_index, x_index, plane_index] = values
+            else:
+               output_array = numpy.zeros(
+                  [self._dense_dim[0], self._dense_dim[3], self._dense_dim[2], self._dense_dim[1]],
+                  dtype=self._dtype)
+               output_array[batch_index, plane_index, y_index, x_index] = values
+         else:
+            # This is 3D
+            x_index = numpy.int32(self._npy_data[:,0])
+            y_index = numpy.int32(self._npy_data[:,1])
+            z_index = numpy.int32(self._npy_data[:,2])
+            if channels == "last":
+               output_array = numpy.zeros(list(self._dense_dim), dtype=self._dtype)
+               output_array[batch_index, x_index, y_index, z_index, 0] = values
+            else:
+               output_array = numpy.zeros(
+                  [self._dense_dim[0], self._dense_dim[4], self._dense_dim[1], self._dense_dim[2], self._dense_dim[3]],
+                  dtype=self._dtype)
+               output_array[batch_index, 0, x_index, y_index, z_index] = values
+         return output_array
 
       if len(self._dim_data) == 4:
          # This is 2D
@@ -237,6 +325,10 @@ class batch_pydata(object):
       # shape (batchsize, n_elements, 3 or 4) where the 3 or 4 
       # is if values are included or not
 
+      # Sparse convolution batches already are (coordinates, features, batch_size):
+      if self._npy_coordinates is not None:
+         return (self._npy_coordinates, self._npy_data, self._dim_data[0])
+
       if len(self._dim_data) == 4:
          # This is 2D
          return None
@@ -7,10 +7,11 @@ random = Random()
 
 
  
-def write_tensor(file_name, event_image_list, dimension): 
+def write_tensor(file_name, event_image_list, dimension, meta_dictionary=False): 
 
     io_manager = larcv.IOManager(larcv.IOManager.kWRITE)
     io_manager.set_out_file(file_name)
+    io_manager.set_meta_dictionary(meta_dictionary)
     io_manager.initialize()
 
     for event in range(len(event_image_list)):
@@ -97,13 +98,17 @@ def build_tensor(rand_num_events, n_projections, dimension=2, shape=None):
 
     return event_image_list
 
-def write_sparse_clusters(file_name, voxel_set_array_list, dimension=2, n_projections=3):
+def write_sparse_clusters(file_name, voxel_set_array_list, dimension=2, n_projections=3, voxel_encoding=None,
+                          meta_dictionary=False):
 
 
     import copy
 
     io_manager = larcv.IOManager(larcv.IOManager.kWRITE)
     io_manager.set_out_file(file_name)
+    if voxel_encoding is not None:
+        io_manager.set_voxel_encoding(voxel_encoding)
+    io_manager.set_meta_dictionary(meta_dictionary)
     io_manager.initialize()
 
 
@@ -239,12 +244,20 @@ def build_sparse_cluster_list(rand_num_events, n_projections=3):
 
 
 
-def write_sparse_tensors(file_name, voxel_set_list, dimension, n_projections):
+def write_sparse_tensors(file_name, voxel_set_list, dimension, n_projections, voxel_encoding=None,
+                         meta_dictionary=False, chunk_size=0, index_chunk_size=0, write_buffer=(0, 0)):
 
 
     from copy import copy
     io_manager = larcv.IOManager(larcv.IOManager.kWRITE)
     io_manager.set_out_file(file_name)
+    if voxel_encoding is not None:
+        io_manager.set_voxel_encoding(voxel_encoding)
+    io_manager.set_meta_dictionary(meta_dictionary)
+    if chunk_size or index_chunk_size:
+        io_manager.set_chunk_size("sparse{}d".format(dimension), chunk_size, index_chunk_size)
+    # (bytes, entries) held before writing, see IOManager.set_write_buffer
+    io_manager.set_write_buffer(*write_buffer)
     io_manager.initialize()
 
     # For this test, the meta is pretty irrelevant as long as it is consistent
@@ -293,12 +306,13 @@ def write_sparse_tensors(file_name, voxel_set_list, dimension, n_projections):
 
     return
  
-def read_sparse_tensors(file_name, dimension):
+def read_sparse_tensors(file_name, dimension, chunk_cache_bytes=0):
 
 
 
     io_manager = larcv.IOManager(larcv.IOManager.kREAD)
     io_manager.add_in_file(file_name)
+    io_manager.set_chunk_cache(chunk_cache_bytes)
     io_manager.initialize()
 
 
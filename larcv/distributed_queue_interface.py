@@ -47,6 +47,7 @@ class queue_interface(object):
 
         self._queue_prev_entries = {}
         self._queue_next_entries = {}
+        self._block_samplers = {}
 
     def no_warnings(self):
         self._warning = False
@@ -93,11 +94,17 @@ class queue_interface(object):
             start_entry = numpy.random.randint(low=0, high=n_choices, size=1)
             next_entries = numpy.arange(minibatch_size) + start_entry
 
-        else:  # self._random_access == RandomAccess.random_events
+        elif self._random_access == RandomAccess.random_events:
             # Choose randomly, but require unique indexes:
             n_entries = self._queueloaders[mode].fetch_n_entries()
             next_entries = random.sample(range(n_entries), minibatch_size)
 
+        else:  # self._random_access == RandomAccess.block_shuffle
+            # Every entry once per epoch, in an order that reads each compressed chunk once:
+            if mode not in self._block_samplers:
+                self._block_samplers[mode] = self._queueloaders[mode].block_sampler(minibatch_size)
+            next_entries = self._block_samplers[mode].next_batch()
+
         next_entries = numpy.asarray(next_entries, dtype=numpy.int32)
         self._queue_next_entries[mode] = next_entries
 
@@ -183,19 +190,26 @@ class queue_interface(object):
         self._queueloaders.update({mode : io})
         self._minibatch_size[mode] = minibatch_size
 
+        # A ShardSampler gives every rank its own entries, without communicating per batch:
+        if io.has_shard_sampler():
+            comm_size = self._entry_comm.Get_size()
+            if minibatch_size % comm_size != 0:
+                raise Exception("Minibatch size {} is not divisible by the {} ranks.".format(minibatch_size, comm_size))
+            io.set_shard(self._entry_comm.Get_rank(), comm_size, minibatch_size // comm_size)
+
         # Queue loaders are manually triggered IO, not always running, so
         # there is no "start_manager" function.  Everything is manual.
         # First, tell it what the entries for the first batch to read:
         self.prepare_next(mode)
 
-        while self._queueloaders[mode].is_reading():
-            # print(self._queueloaders[mode].is_reading())
-            time.sleep(0.01)
-
-        # Then, we promote those entries to the "current" batch:
+        # Then, we promote those entries to the "current" batch.
+        # The pop blocks until the batch is ready:
         io.pop_current_data()
         io.next(store_entries=True,store_event_ids=True)
-        self.prepare_next(mode)
+
+        # Keep as many batches in flight as the queue allows:
+        for i in range(io.queue_depth()):
+            self.prepare_next(mode)
 
         # Note that there is no "next" data pipelined yet.
 
@@ -224,16 +238,24 @@ class queue_interface(object):
 
 
         '''
-        # Which events should we read?
-        if set_entries is None:
-            set_entries = self.coordinate_next_batch_indexes(mode, comm=self._entry_comm)
-            # set_entries = self.get_next_batch_indexes(mode, self._minibatch_size[mode])
-
-        # If set entries is still none, escape:
-        if set_entries is None:
+        # Nothing to do if the queue is already full:
+        if self._queueloaders[mode].n_pending() >= self._queueloaders[mode].queue_depth():
             return
 
-        self._queueloaders[mode].set_next_batch(set_entries)
+        # Which events should we read?  A sampler in the configuration chooses them itself.
+        if self._queueloaders[mode].has_sampler():
+            if set_entries is not None:
+                self._queueloaders[mode].set_next_batch(set_entries)
+        else:
+            if set_entries is None:
+                set_entries = self.coordinate_next_batch_indexes(mode, comm=self._entry_comm)
+                # set_entries = self.get_next_batch_indexes(mode, self._minibatch_size[mode])
+
+            # If set entries is still none, escape:
+            if set_entries is None:
+                return
+
+            self._queueloaders[mode].set_next_batch(set_entries)
         self._queueloaders[mode].prepare_next()
 
         self._count[mode] = 0
@@ -261,9 +283,7 @@ class queue_interface(object):
 
 
         if pop:
-            # This function will pop the data
-            while self._queueloaders[mode].is_reading():
-                time.sleep(0.01)
+            # This function will pop the data, waiting for it if needed
             self._queueloaders[mode].pop_current_data()
         else:
             if self._warning:
@@ -278,6 +298,13 @@ class queue_interface(object):
                 self._data_keys[mode][key]).data(
                 shape=data_shape, channels=channels)
             # this_data[key] = numpy.reshape(this_data[key], self._dims[mode][key])
+            # Ragged batches also hand out the first row of each entry,
+            # and sparse convolution batches the coordinates of each row:
+            batch = self._queueloaders[mode].fetch_data(self._data_keys[mode][key])
+            if batch.offsets() is not None:
+                this_data[key + '_offsets'] = batch.offsets()
+            if batch.coordinates() is not None:
+                this_data[key + '_coordinates'] = batch.coordinates()
 
         if fetch_meta_data:
             this_data['entries'] = self._queueloaders[mode].fetch_entries()
@@ -7,6 +7,8 @@ class RandomAccess(Enum):
     random_blocks = 1 
     # Read every event randomly from file:
     random_events = 2 
+    # Shuffle chunk-aligned groups of events, then mix them in a window:
+    block_shuffle = 3
 
 class ReadOption(Enum):
     # Use only the specified root rank to read the data, 
@@ -28,6 +28,7 @@ class queue_interface(object):
 
         self._queue_prev_entries = {}
         self._queue_next_entries = {}
+        self._block_samplers = {}
         self._count = {}
 
         if seed is not None:
@@ -83,11 +84,17 @@ class queue_interface(object):
             start_entry = numpy.random.randint(low=0, high=n_choices, size=1)
             next_entries = numpy.arange(minibatch_size) + start_entry
 
-        else:  # self._random_access == RandomAccess.random_events
+        elif self._random_access == RandomAccess.random_events:
             # Choose randomly, but require unique indexes:
             n_entries = self._queueloaders[mode].fetch_n_entries()
             next_entries = random.sample(range(n_entries), minibatch_size)
 
+        else:  # self._random_access == RandomAccess.block_shuffle
+            # Every entry once per epoch, in an order that reads each compressed chunk once:
+            if mode not in self._block_samplers:
+                self._block_samplers[mode] = self._queueloaders[mode].block_sampler(minibatch_size)
+            next_entries = self._block_samplers[mode].next_batch()
+
 
         self._queue_next_entries[mode] = next_entries
 
@@ -150,18 +157,10 @@ class queue_interface(object):
         # there is no "start_manager" function.  Everything is manual.
         # First, tell it what the entries for the first batch to read:
 
-        # start = time.time()
-        # print(self._queueloaders[mode].is_reading())
         self.prepare_next(mode)
-        # print(self._queueloaders[mode].is_reading())
-        # end = time.time()
-
-        # print(end - start)
-        # Then, we promote those entries to the "current" batch:
-        while self._queueloaders[mode].is_reading():
-            # print(self._queueloaders[mode].is_reading())
-            time.sleep(0.01)
 
+        # Then, we promote those entries to the "current" batch.
+        # The pop blocks until the batch is ready:
         io.pop_current_data()
         io.next(store_entries=True,store_event_ids=True)
 
@@ -176,7 +175,10 @@ class queue_interface(object):
             self._dims[mode][key] = self._queueloaders[mode].fetch_data(self._data_keys[mode][key]).dim()
 
         end = time.time()
-        self.prepare_next(mode)
+
+        # Keep as many batches in flight as the queue allows:
+        for i in range(io.queue_depth()):
+            self.prepare_next(mode)
 
         # Print out how long it took to start IO:
         if self._verbose:
@@ -214,11 +216,16 @@ class queue_interface(object):
 
 
         '''
-        # Which events should we read?
-        if set_entries is None:
+        # Nothing to do if the queue is already full:
+        if self._queueloaders[mode].n_pending() >= self._queueloaders[mode].queue_depth():
+            return
+
+        # Which events should we read?  A Sampler in the configuration chooses them itself.
+        if set_entries is None and not self._queueloaders[mode].has_sampler():
             set_entries = self.get_next_batch_indexes(mode, self._minibatch_size[mode])
 
-        self._queueloaders[mode].set_next_batch(set_entries)
+        if set_entries is not None:
+            self._queueloaders[mode].set_next_batch(set_entries)
         self._queueloaders[mode].prepare_next()
 
         self._count[mode] = 0
@@ -240,9 +247,7 @@ class queue_interface(object):
                 print("To quiet this warning, call prepare_next before fetch_minibatch_data or call queueloader.no_warnings()")
 
         if pop:
-            # This function will pop the data
-            while self._queueloaders[mode].is_reading():
-                time.sleep(0.001)
+            # This function will pop the data, waiting for it if needed
             self._queueloaders[mode].pop_current_data()
         else:
             if self._warning:
@@ -260,6 +265,13 @@ class queue_interface(object):
                 self._data_keys[mode][key]).data(
                 shape=data_shape, channels=channels)
             # this_data[key] = numpy.reshape(this_data[key], self._dims[mode][key])
+            # Ragged batches also hand out the first row of each entry,
+            # and sparse convolution batches the coordinates of each row:
+            batch = self._queueloaders[mode].fetch_data(self._data_keys[mode][key])
+            if batch.offsets() is not None:
+                this_data[key + '_offsets'] = batch.offsets()
+            if batch.coordinates() is not None:
+                this_data[key + '_coordinates'] = batch.coordinates()
 
         if fetch_meta_data:
             this_data['entries'] = self._queueloaders[mode].fetch_entries()
@@ -328,7 +340,7 @@ class larcv_queueio (object):
         self._event_ids = None
 
     def reset(self):
-        while self.is_reading(): time.sleep(0.01)
+        # The QueueProcessor waits for any batch in flight before resetting
         if self._proc: self._proc.reset()
 
     def __del__(self):
@@ -391,8 +403,6 @@ class larcv_queueio (object):
         self._proc.set_next_batch(batch_indexes)
 
     def batch_process(self):
-        while self.is_reading():
-            time.sleep(0.01)
         self._proc.batch_process()
 
 
@@ -402,9 +412,35 @@ class larcv_queueio (object):
     def is_reading(self,storage_id=None):
         return self._proc.is_reading()
 
-    def pop_current_data(self):
-        # Promote the "next" data to current in C++ and release current
-        self._proc.pop_current_data()
+    def pop_current_data(self, blocking=True):
+        # Promote the oldest prepared data to current in C++ and release current
+        return self._proc.pop_current_data(blocking)
+
+    def queue_depth(self):
+        return self._proc.queue_depth()
+
+    def has_sampler(self):
+        return self._proc.has_sampler()
+
+    def has_shard_sampler(self):
+        return self._proc.has_shard_sampler()
+
+    def set_shard(self, shard, n_shards, batch_size=0):
+        self._proc.set_shard(shard, n_shards, batch_size)
+
+    def block_sampler(self, batch_size):
+        # A single-shard larcv.ShardSampler, in groups of the input's entries per chunk:
+        cfg = larcv.PSet("ShardSampler")
+        cfg["GroupSize"] = "0"
+        cfg["Seed"]      = str(numpy.random.randint(2**31))
+        sampler = larcv.ShardSampler()
+        sampler.configure(cfg)
+        sampler.set_input(self._proc.pd().io())
+        sampler.set_shard(0, 1, batch_size)
+        return sampler
+
+    def n_pending(self):
+        return self._proc.n_pending()
 
     def next(self,store_entries=False,store_event_ids=False):
 
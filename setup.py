@@ -47,7 +47,7 @@ setup(
         'Source Code': 'https://github.com/DeepLearnPhysics/larcv3'
     },
     url='https://github.com/DeepLearnPhysics/larcv3',
-    scripts=['bin/merge_larcv3_files.py', 'bin/run_processor.py'],
+    scripts=['bin/merge_larcv3_files.py', 'bin/run_processor.py', 'bin/make_manifest.py'],
     packages=['larcv','src/pybind11'],
     install_requires=[
         'numpy',
@@ -13,7 +13,7 @@ static DownsampleProcessFactory
 
 
 Downsample::Downsample(const std::string name)
-    : ProcessBase(name) {}
+    : ProcessBase(name), _levels(1) {}
 
 void Downsample::configure_labels(const PSet& cfg) {
   _input_producer_v.clear();
@@ -100,7 +100,17 @@ void Downsample::configure(const PSet& cfg) {
     _pool_types_v.push_back(downsample);
   }
 
+  _levels = cfg.get<size_t>("Levels", 1);
+  if (_levels == 0) {
+    LARCV_CRITICAL() << "Levels must be at least 1" << std::endl;
+    throw larbys();
+  }
+
+}
 
+std::string Downsample::level_producer(const std::string & output_producer, size_t level) const {
+  if (level == 0) return output_producer;
+  return output_producer + "_" + std::to_string(level);
 }
 
 void Downsample::initialize() {}
@@ -124,7 +134,9 @@ bool Downsample::process(IOManager& mgr) {
 
     if (product == "sparse2d"){
       auto const & ev_input  = mgr.get_data<larcv3::EventSparseTensor2D>(producer);
-      auto       & ev_output = mgr.get_data<larcv3::EventSparseTensor2D>(output_producer);
+      std::vector<larcv3::EventSparseTensor2D*> ev_output_v;
+      for (size_t level = 0; level < _levels; level ++)
+        ev_output_v.push_back(&mgr.get_data<larcv3::EventSparseTensor2D>(level_producer(output_producer, level)));
 
       for (size_t i = 0; i < ev_input.as_vector().size(); i ++ ){
         auto const & sparse_object = ev_input.sparse_tensor(i);
@@ -146,13 +158,17 @@ bool Downsample::process(IOManager& mgr) {
         else if(i < _pool_types_v.size() ){
           pool = _pool_types_v[i];
         }
-        SparseTensor2D compressed = sparse_object.compress(downsample, larcv3::PoolType_t(pool));
-        ev_output.emplace(std::move(compressed));
+        // All levels of the pyramid in one sweep:
+        auto compressed_v = sparse_object.compress_levels(downsample, _levels, larcv3::PoolType_t(pool));
+        for (size_t level = 0; level < _levels; level ++)
+          ev_output_v[level]->emplace(std::move(compressed_v[level]));
       }
     }
     if (product == "sparse3d"){
       auto const & ev_input  = mgr.get_data<larcv3::EventSparseTensor3D>(producer);
-      auto       & ev_output = mgr.get_data<larcv3::EventSparseTensor3D>(output_producer);
+      std::vector<larcv3::EventSparseTensor3D*> ev_output_v;
+      for (size_t level = 0; level < _levels; level ++)
+        ev_output_v.push_back(&mgr.get_data<larcv3::EventSparseTensor3D>(level_producer(output_producer, level)));
 
       for (size_t i = 0; i < ev_input.as_vector().size(); i ++ ){
         auto sparse_object = ev_input.as_vector().at(i);
@@ -175,8 +191,10 @@ bool Downsample::process(IOManager& mgr) {
           pool = _pool_types_v[i];
         }
         
-        SparseTensor3D compressed = sparse_object.compress(downsample, larcv3::PoolType_t(pool));
-        ev_output.emplace(std::move(compressed));
+        // All levels of the pyramid in one sweep:
+        auto compressed_v = sparse_object.compress_levels(downsample, _levels, larcv3::PoolType_t(pool));
+        for (size_t level = 0; level < _levels; level ++)
+          ev_output_v[level]->emplace(std::move(compressed_v[level]));
 
       }
     }
@@ -45,6 +45,8 @@ namespace larcv3 {
 
     void configure_labels(const PSet&);
 
+    std::string level_producer(const std::string & output_producer, size_t level) const;
+
     // List of input producers:
     std::vector<std::string> _input_producer_v;
     // List of input datatypes:
@@ -55,6 +57,9 @@ namespace larcv3 {
     std::vector<size_t>       _downsamples_v;
     // Pooling Types
     std::vector<int> _pool_types_v;
+    // Number of pyramid levels, each downsampled again from the one before.
+    // Level 0 goes to the output producer, level k > 0 to "<output producer>_<k>"
+    size_t _levels;
 
   };
 
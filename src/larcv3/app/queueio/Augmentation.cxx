@@ -0,0 +1,153 @@
+#ifndef __LARCV3THREADIO_AUGMENTATION_CXX
+#define __LARCV3THREADIO_AUGMENTATION_CXX
+
+#include "Augmentation.h"
+#include "larcv3/core/base/larbys.h"
+
+namespace larcv3 {
+
+  VoxelMap::VoxelMap(const AugmentTransform& transform, const size_t* extents, size_t n_dims)
+    : dimension(std::min(n_dims, size_t(3)))
+    , seed(transform.dropout_seed)
+    , threshold(0)
+  {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      source[axis] = axis;
+      sign[axis]   = 1;
+      offset[axis] = 0;
+      extent[axis] = axis < dimension ? extents[axis] : 1;
+    }
+
+    for (size_t axis = 0; axis < dimension; ++axis) {
+      if (!transform.flip[axis]) continue;
+      sign[axis]   = -sign[axis];
+      offset[axis] = extent[axis] - 1 - offset[axis];
+    }
+
+    // Each quarter turn takes (a, b) to (n_a - 1 - b, a):
+    size_t a = transform.plane[0], b = transform.plane[1];
+    if (a < dimension && b < dimension && a != b) {
+      for (size_t turn = 0; turn < transform.quarter_turns % 4; ++turn) {
+        size_t source_a = source[a];
+        long   sign_a   = sign[a];
+        long   offset_a = offset[a];
+        source[a] = source[b];
+        sign[a]   = -sign[b];
+        offset[a] = extent[a] - 1 - offset[b];
+        source[b] = source_a;
+        sign[b]   = sign_a;
+        offset[b] = offset_a;
+      }
+    }
+
+    for (size_t axis = 0; axis < dimension; ++axis) offset[axis] += transform.shift[axis];
+
+    // A voxel is dropped when the hash of its id is under the threshold:
+    if (transform.dropout > 0)
+      threshold = uint64_t(double(transform.dropout) * 18446744073709551616.0);
+
+    identity = !threshold;
+    for (size_t axis = 0; axis < dimension; ++axis)
+      identity &= source[axis] == axis && sign[axis] == 1 && offset[axis] == 0;
+  }
+
+  Augmentation::Augmentation(std::string name)
+    : larcv_base(name)
+    , _rotate(false)
+    , _dropout(0.)
+    , _seed(0)
+  {}
+
+  void Augmentation::configure(const PSet& cfg)
+  {
+    set_verbosity( (msg::Level_t)(cfg.get<unsigned short>("Verbosity", logger().level())) );
+
+    _flip_v   = cfg.get<std::vector<size_t> >("Flip", std::vector<size_t>());
+    _rotate   = cfg.get<bool>("Rotate", false);
+    _plane_v  = cfg.get<std::vector<size_t> >("RotationPlane", std::vector<size_t>{0, 1});
+    _shift_v  = cfg.get<std::vector<size_t> >("MaxShift", std::vector<size_t>());
+    _dropout  = cfg.get<float>("Dropout", 0.);
+    _seed     = cfg.get<unsigned int>("Seed", 0);
+
+    for (auto const& axis : _flip_v) {
+      if (axis >= 3) {
+        LARCV_CRITICAL() << "Can't flip axis " << axis << ", there are at most 3" << std::endl;
+        throw larbys();
+      }
+    }
+    if (_plane_v.size() != 2 || _plane_v[0] == _plane_v[1] || _plane_v[0] >= 3 || _plane_v[1] >= 3) {
+      LARCV_CRITICAL() << "RotationPlane must be two different axes" << std::endl;
+      throw larbys();
+    }
+    if (_shift_v.size() > 3) {
+      LARCV_CRITICAL() << "MaxShift has " << _shift_v.size() << " axes, there are at most 3" << std::endl;
+      throw larbys();
+    }
+    if (_dropout < 0 || _dropout >= 1) {
+      LARCV_CRITICAL() << "Dropout must be in [0, 1), not " << _dropout << std::endl;
+      throw larbys();
+    }
+  }
+
+  bool Augmentation::enabled() const
+  {
+    bool shift = false;
+    for (auto const& max_shift : _shift_v) shift |= max_shift > 0;
+    return !_flip_v.empty() || _rotate || shift || _dropout > 0;
+  }
+
+  AugmentTransform Augmentation::draw(std::mt19937_64& generator) const
+  {
+    AugmentTransform transform;
+    for (auto const& axis : _flip_v)
+      transform.flip[axis] = generator() & 1;
+    if (_rotate) {
+      transform.quarter_turns = generator() % 4;
+      transform.plane[0] = _plane_v[0];
+      transform.plane[1] = _plane_v[1];
+    }
+    for (size_t axis = 0; axis < _shift_v.size(); ++axis) {
+      int max_shift = _shift_v[axis];
+      transform.shift[axis] = std::uniform_int_distribution<int>(-max_shift, max_shift)(generator);
+    }
+    transform.dropout = _dropout;
+    transform.dropout_seed = generator();
+    return transform;
+  }
+
+}
+
+#include <pybind11/stl.h>
+
+void init_augmentation(pybind11::module m){
+
+  pybind11::class_<larcv3::AugmentTransform> transform(m, "AugmentTransform");
+  transform.def(pybind11::init<>());
+  transform.def_readwrite("quarter_turns", &larcv3::AugmentTransform::quarter_turns);
+  transform.def_readwrite("dropout",       &larcv3::AugmentTransform::dropout);
+  transform.def_readwrite("dropout_seed",  &larcv3::AugmentTransform::dropout_seed);
+  transform.def_property_readonly("flip",  [](const larcv3::AugmentTransform& t) {
+    return std::vector<bool>(t.flip, t.flip + 3); });
+  transform.def_property_readonly("plane", [](const larcv3::AugmentTransform& t) {
+    return std::vector<size_t>(t.plane, t.plane + 2); });
+  transform.def_property_readonly("shift", [](const larcv3::AugmentTransform& t) {
+    return std::vector<int>(t.shift, t.shift + 3); });
+
+  using Class = larcv3::Augmentation;
+  pybind11::class_<Class> augmentation(m, "Augmentation");
+
+  augmentation.def(pybind11::init<std::string>(),
+    pybind11::arg("name") = "Augmentation");
+
+  augmentation.def("configure",      &Class::configure);
+  augmentation.def("enabled",        &Class::enabled);
+  augmentation.def("flip",           &Class::flip);
+  augmentation.def("rotate",         &Class::rotate);
+  augmentation.def("rotation_plane", &Class::rotation_plane);
+  augmentation.def("max_shift",      &Class::max_shift);
+  augmentation.def("dropout",        &Class::dropout);
+  augmentation.def("seed",           &Class::seed);
+
+}
+
+#endif
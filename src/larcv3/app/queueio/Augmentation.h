@@ -0,0 +1,253 @@
+/**
+ * \file Augmentation.h
+ *
+ * \ingroup ThreadIO
+ *
+ * \brief Class def header for the augmentation stage of the QueueProcessor
+ *
+ * @author cadams
+ */
+
+/** \addtogroup ThreadIO
+
+    @{*/
+#ifndef __LARCV3THREADIO_AUGMENTATION_H
+#define __LARCV3THREADIO_AUGMENTATION_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+#include "larcv3/core/base/larcv_base.h"
+#include "larcv3/core/base/PSet.h"
+#include "larcv3/core/base/StridedCopy.h"
+#include "larcv3/core/dataformat/ImageMeta.h"
+
+namespace larcv3 {
+
+  /**
+     \struct AugmentTransform
+     \brief One entry's draw of the augmentation.  Every filler of the entry applies the
+     same one: the axes are flipped first, then turned, then shifted, and voxels that
+     leave the grid or are dropped out are removed.
+  */
+  struct AugmentTransform {
+    AugmentTransform()
+      : flip{false, false, false}
+      , quarter_turns(0)
+      , plane{0, 1}
+      , shift{0, 0, 0}
+      , dropout(0.)
+      , dropout_seed(0)
+    {}
+
+    bool     flip[3];        ///< Reverse the axis
+    size_t   quarter_turns;  ///< Quarter turns in the rotation plane, from plane[1] towards plane[0]
+    size_t   plane[2];       ///< Axes of the rotation plane
+    int      shift[3];       ///< Translation in voxels, after the flips and turns
+    float    dropout;        ///< Fraction of the voxels removed
+    uint64_t dropout_seed;   ///< Which voxels: every filler removes the same voxel ids
+  };
+
+  /**
+     \struct VoxelMap
+     \brief An AugmentTransform on a grid of given extents.  Voxel x goes to
+     y[axis] = sign[axis] * x[source[axis]] + offset[axis], and is kept if y is on the
+     grid and its id (on the original grid) survives the dropout.
+  */
+  struct VoxelMap {
+    VoxelMap(const AugmentTransform& transform, const size_t* extents, size_t n_dims);
+
+    template <size_t dimension>
+    VoxelMap(const AugmentTransform& transform, const ImageMeta<dimension>& meta)
+      : VoxelMap(transform, meta.number_of_voxels(), dimension) {}
+
+    /// Whether voxel id survives the dropout
+    inline bool keep(size_t id) const {
+      uint64_t z = seed + (uint64_t(id) + 1) * 0x9E3779B97F4A7C15ULL;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return (z ^ (z >> 31)) >= threshold;
+    }
+
+    /// Moves the coordinates x to y, and tells if they are still on the grid
+    template <class T>
+    inline bool move(const T* x, T* y) const {
+      bool inside = true;
+      for (size_t axis = 0; axis < dimension; ++axis) {
+        long value = sign[axis] * long(x[source[axis]]) + offset[axis];
+        inside &= (value >= 0) & (value < extent[axis]);
+        y[axis] = T(value);
+      }
+      return inside;
+    }
+
+    size_t   dimension;
+    size_t   source[3];
+    long     sign[3];
+    long     offset[3];
+    long     extent[3];
+    uint64_t seed;
+    uint64_t threshold;
+    bool     identity;
+  };
+
+  /**
+     \brief Applies map to n_rows voxel rows in place, in a single pass.  Each row is
+     row_width values with the coordinates starting at first_axis; ids are the voxel ids
+     the rows were unravelled from.  Rows that leave the grid or are dropped out are
+     removed, and the others packed to the front, along with their feature_width features
+     if there are any.  The compaction has no branches, every row is written where the
+     next kept one goes.  Returns the number of rows kept.
+  */
+  template <class T, class F>
+  size_t augment_rows(const VoxelMap& map, const size_t* ids, size_t n_rows,
+                      T* rows, size_t row_width, size_t first_axis,
+                      F* features, size_t feature_width)
+  {
+    if (map.identity) return n_rows;
+    size_t kept = 0;
+    T moved[3];
+    for (size_t i_row = 0; i_row < n_rows; ++i_row) {
+      const T* row = rows + i_row * row_width;
+      bool keep = map.move(row + first_axis, moved) & map.keep(ids[i_row]);
+      T* out = rows + kept * row_width;
+      for (size_t k = 0; k < row_width; ++k) out[k] = row[k];
+      for (size_t axis = 0; axis < map.dimension; ++axis) out[first_axis + axis] = moved[axis];
+      for (size_t k = 0; k < feature_width; ++k)
+        features[kept * feature_width + k] = features[i_row * feature_width + k];
+      kept += keep;
+    }
+    return kept;
+  }
+
+  /// augment_rows for rows without separate features
+  template <class T>
+  size_t augment_rows(const VoxelMap& map, const size_t* ids, size_t n_rows,
+                      T* rows, size_t row_width, size_t first_axis)
+  {
+    return augment_rows(map, ids, n_rows, rows, row_width, first_axis, (T*)nullptr, 0);
+  }
+
+  /**
+     \brief Copies dense row-major inputs into output, as the channels (last, interleaved)
+     of the augmented tensor.  The flips and turns are strides of one strided_copy of the
+     box of input voxels that stays on the grid; the rest of the output is empty_value,
+     and so are the voxels dropped out.
+  */
+  template <class T>
+  void augment_copy(const VoxelMap& map, const std::vector<const T*>& inputs, T* output, T empty_value)
+  {
+    const size_t n_dims = map.dimension;
+    const size_t n_channels = inputs.size();
+    std::vector<size_t> extents(map.extent, map.extent + n_dims);
+    auto in_strides  = row_major_strides(extents);
+    auto out_strides = row_major_strides(extents, n_channels);
+    size_t n_voxels = 1;
+    for (auto const& extent : extents) n_voxels *= extent;
+
+    // The box of input voxels that lands on the grid, and where its corner goes:
+    std::vector<size_t> shape(n_dims);
+    std::vector<std::ptrdiff_t> write_strides(n_dims);
+    std::ptrdiff_t in_offset = 0, out_offset = 0;
+    size_t n_box = 1;
+    for (size_t axis = 0; axis < n_dims; ++axis) {
+      size_t source = map.source[axis];
+      long first = map.sign[axis] > 0 ? -map.offset[axis] : map.offset[axis] - map.extent[axis] + 1;
+      long last  = first + map.extent[axis];
+      first = std::max(first, 0L);
+      last  = std::min(last, map.extent[source]);
+      if (last <= first) {
+        std::fill(output, output + n_voxels * n_channels, empty_value);
+        return;
+      }
+      shape[source] = last - first;
+      write_strides[source] = map.sign[axis] * out_strides[axis];
+      in_offset  += first * in_strides[source];
+      out_offset += (map.sign[axis] * first + map.offset[axis]) * out_strides[axis];
+      n_box *= last - first;
+    }
+
+    if (n_box < n_voxels) std::fill(output, output + n_voxels * n_channels, empty_value);
+    std::vector<const T*> corners;
+    for (auto const* input : inputs) corners.push_back(input + in_offset);
+    strided_copy(corners, in_strides, output + out_offset, write_strides, 1, shape);
+
+    if (!map.threshold) return;
+    // Empty the dropped voxels, walking the output in order:
+    std::vector<long> y(n_dims, 0);
+    for (size_t i_voxel = 0; i_voxel < n_voxels; ++i_voxel) {
+      size_t id = 0;
+      bool inside = true;
+      for (size_t axis = 0; axis < n_dims; ++axis) {
+        // x[source] from y[axis], since sign is +-1:
+        long x = map.sign[axis] * (y[axis] - map.offset[axis]);
+        inside &= (x >= 0) & (x < map.extent[map.source[axis]]);
+        id += x * in_strides[map.source[axis]];
+      }
+      if (inside && !map.keep(id))
+        std::fill(output + i_voxel * n_channels, output + (i_voxel + 1) * n_channels, empty_value);
+      for (size_t axis = n_dims; axis > 0; --axis) {
+        if (++y[axis - 1] < map.extent[axis - 1]) break;
+        y[axis - 1] = 0;
+      }
+    }
+  }
+
+  /**
+     \class Augmentation
+     \brief The augmentation stage of a QueueProcessor, configured by its Augment block.
+
+     For every entry one AugmentTransform is drawn, from the generator of the worker that
+     processes it, and every filler applies it to its output.  Flip lists the axes that
+     are each reversed with probability 1/2, Rotate turns by 0 to 3 quarter turns in the
+     RotationPlane (default [0, 1]), MaxShift is the largest translation along each axis
+     in voxels, and Dropout the fraction of voxels removed, the same ones for every
+     filler.  A turn in a plane that is not square, or a shift, crops whatever leaves
+     the grid.
+  */
+  class Augmentation : public larcv_base {
+
+  public:
+
+    /// Default constructor
+    Augmentation(std::string name = "Augmentation");
+
+    /// Default destructor
+    ~Augmentation() {}
+
+    void configure(const PSet& cfg);
+
+    /// True if any transform is configured
+    bool enabled() const;
+
+    /// Draw the transform of one entry
+    AugmentTransform draw(std::mt19937_64& generator) const;
+
+    inline const std::vector<size_t>& flip() const { return _flip_v; }
+    inline bool rotate() const { return _rotate; }
+    inline const std::vector<size_t>& rotation_plane() const { return _plane_v; }
+    inline const std::vector<size_t>& max_shift() const { return _shift_v; }
+    inline float dropout() const { return _dropout; }
+    inline unsigned int seed() const { return _seed; }
+
+  private:
+
+    std::vector<size_t> _flip_v;
+    bool _rotate;
+    std::vector<size_t> _plane_v;
+    std::vector<size_t> _shift_v;
+    float _dropout;
+    unsigned int _seed;
+  };
+
+}
+
+#ifdef LARCV_INTERNAL
+#include <pybind11/pybind11.h>
+void init_augmentation(pybind11::module m);
+#endif
+
+#endif
+/** @} */ // end of doxygen group
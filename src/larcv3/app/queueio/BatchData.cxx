@@ -5,50 +5,205 @@
 #include "larcv3/core/base/larcv_logger.h"
 #include "larcv3/core/base/larbys.h"
 #include <sstream>
+#include <algorithm>
 
 namespace larcv3 {
 
+  template<class T>
+  BatchData<T>::BatchData(const BatchData<T>& other)
+    : _data(std::make_shared<std::vector<T> >(*other._data))
+    , _dim(other._dim)
+    , _dense_dim(other._dense_dim)
+    , _entry_data_v(other._entry_data_v)
+    , _offsets(std::make_shared<std::vector<int64_t> >(*other._offsets))
+    , _entry_coordinates_v(other._entry_coordinates_v)
+    , _coordinates(std::make_shared<std::vector<int> >(*other._coordinates))
+    , _coordinate_width(other._coordinate_width)
+    , _current_size(other._current_size.load())
+    , _filled_entries(other._filled_entries.load())
+    , _ragged(other._ragged)
+    , _state(other._state.load())
+  {}
+
+  template<class T>
+  BatchData<T>::BatchData(BatchData<T>&& other)
+    : _data(std::move(other._data))
+    , _dim(std::move(other._dim))
+    , _dense_dim(std::move(other._dense_dim))
+    , _entry_data_v(std::move(other._entry_data_v))
+    , _offsets(std::move(other._offsets))
+    , _entry_coordinates_v(std::move(other._entry_coordinates_v))
+    , _coordinates(std::move(other._coordinates))
+    , _coordinate_width(other._coordinate_width)
+    , _current_size(other._current_size.load())
+    , _filled_entries(other._filled_entries.load())
+    , _ragged(other._ragged)
+    , _state(other._state.load())
+  {
+    other._data        = std::make_shared<std::vector<T> >();
+    other._offsets     = std::make_shared<std::vector<int64_t> >();
+    other._coordinates = std::make_shared<std::vector<int> >();
+  }
+
+  template<class T>
+  BatchData<T>& BatchData<T>::operator=(const BatchData<T>& other)
+  {
+    _data           = std::make_shared<std::vector<T> >(*other._data);
+    _dim            = other._dim;
+    _dense_dim      = other._dense_dim;
+    _entry_data_v   = other._entry_data_v;
+    _offsets        = std::make_shared<std::vector<int64_t> >(*other._offsets);
+    _entry_coordinates_v = other._entry_coordinates_v;
+    _coordinates    = std::make_shared<std::vector<int> >(*other._coordinates);
+    _coordinate_width = other._coordinate_width;
+    _current_size   = other._current_size.load();
+    _filled_entries = other._filled_entries.load();
+    _ragged         = other._ragged;
+    _state          = other._state.load();
+    return *this;
+  }
+
+  template<class T>
+  BatchData<T>& BatchData<T>::operator=(BatchData<T>&& other)
+  {
+    _data           = std::move(other._data);
+    _dim            = std::move(other._dim);
+    _dense_dim      = std::move(other._dense_dim);
+    _entry_data_v   = std::move(other._entry_data_v);
+    _offsets        = std::move(other._offsets);
+    _entry_coordinates_v = std::move(other._entry_coordinates_v);
+    _coordinates    = std::move(other._coordinates);
+    _coordinate_width = other._coordinate_width;
+    _current_size   = other._current_size.load();
+    _filled_entries = other._filled_entries.load();
+    _ragged         = other._ragged;
+    _state          = other._state.load();
+    other._data     = std::make_shared<std::vector<T> >();
+    other._offsets  = std::make_shared<std::vector<int64_t> >();
+    other._coordinates = std::make_shared<std::vector<int> >();
+    return *this;
+  }
+
   template<class T>
   const std::vector<T>& BatchData<T>::data() const
   {
     if (_state != BatchDataState_t::kBatchStateFilled) {
-      LARCV_SCRITICAL() << "Current batch state: " << (int)_state
+      LARCV_SCRITICAL() << "Current batch state: " << (int)_state.load()
                         << " not ready to expose data!" << std::endl;
       throw larbys();
     }
-    return _data;
+    return *_data;
   }
 
   template<class T>
   pybind11::array_t<T> BatchData<T>::pydata()
   {
     if (_state != BatchDataState_t::kBatchStateFilled) {
-      LARCV_SCRITICAL() << "Current batch state: " << (int)_state
+      LARCV_SCRITICAL() << "Current batch state: " << (int)_state.load()
+                        << " not ready to expose data!" << std::endl;
+      throw larbys();
+    }
+
+    // The array is a view of the buffer, shaped like the batch.  Its base capsule
+    // holds a reference to the buffer, which pins it until numpy lets go:
+    std::vector<size_t> dimensions(_dim.begin(), _dim.end());
+    if (_ragged && !dimensions.empty()) dimensions.front() = _offsets->back();
+    else if (data_size(true) != _data->size()) dimensions.assign(1, _data->size());
+
+    auto owner = new std::shared_ptr<std::vector<T> >(_data);
+    pybind11::capsule base(owner, [](void * ptr) {
+      delete reinterpret_cast<std::shared_ptr<std::vector<T> > *>(ptr);
+    });
+
+    return pybind11::array_t<T>(dimensions, _data->data(), base);
+
+  }
+
+  template<class T>
+  pybind11::array_t<int64_t> BatchData<T>::pyoffsets()
+  {
+    auto const & offsets = this->offsets();
+
+    auto owner = new std::shared_ptr<std::vector<int64_t> >(_offsets);
+    pybind11::capsule base(owner, [](void * ptr) {
+      delete reinterpret_cast<std::shared_ptr<std::vector<int64_t> > *>(ptr);
+    });
+
+    return pybind11::array_t<int64_t>(offsets.size(), offsets.data(), base);
+  }
+
+  template<class T>
+  pybind11::array_t<int> BatchData<T>::pycoordinates()
+  {
+    auto const & coordinates = this->coordinates();
+
+    std::vector<size_t> dimensions = {coordinates.size() / std::max(_coordinate_width, size_t(1)),
+                                      _coordinate_width};
+
+    auto owner = new std::shared_ptr<std::vector<int> >(_coordinates);
+    pybind11::capsule base(owner, [](void * ptr) {
+      delete reinterpret_cast<std::shared_ptr<std::vector<int> > *>(ptr);
+    });
+
+    return pybind11::array_t<int>(dimensions, coordinates.data(), base);
+  }
+
+  template<class T>
+  const std::vector<int>& BatchData<T>::coordinates() const
+  {
+    if (_state != BatchDataState_t::kBatchStateFilled) {
+      LARCV_SCRITICAL() << "Current batch state: " << (int)_state.load()
                         << " not ready to expose data!" << std::endl;
       throw larbys();
     }
+    return *_coordinates;
+  }
 
-    // First, create the buffer object:
-    // Cast the dimensions to std::array:
-    std::array<size_t, 1> dimensions;
-    dimensions[0] = _data.size();
-    // Allocate a spot to store the data:
-    auto array = pybind11::array_t<T>(
-        // _meta.number_of_voxels()[0],
-        dimensions,
-        {},
-        &(_data[0])
-      );
-  
-    return array;
+  template<class T>
+  void BatchData<T>::set_coordinate_width(size_t width)
+  {
+    if (_coordinate_width == width) return;
+    if (width && !_ragged) {
+      LARCV_SCRITICAL() << "Only ragged batches carry coordinates!" << std::endl;
+      throw larbys();
+    }
+    if (_state == BatchDataState_t::kBatchStateFilling) {
+      LARCV_SCRITICAL() << "Cannot change the coordinate width of a batch while it is filled!" << std::endl;
+      throw larbys();
+    }
+    _coordinate_width = width;
+    reset_data();
+  }
 
+  template<class T>
+  const std::vector<int64_t>& BatchData<T>::offsets() const
+  {
+    if (_state != BatchDataState_t::kBatchStateFilled) {
+      LARCV_SCRITICAL() << "Current batch state: " << (int)_state.load()
+                        << " not ready to expose data!" << std::endl;
+      throw larbys();
+    }
+    return *_offsets;
+  }
+
+  template<class T>
+  void BatchData<T>::set_ragged(bool ragged)
+  {
+    if (_ragged == ragged) return;
+    if (_state == BatchDataState_t::kBatchStateFilling) {
+      LARCV_SCRITICAL() << "Cannot change a batch to or from ragged while it is filled!" << std::endl;
+      throw larbys();
+    }
+    _ragged = ragged;
+    if (!_ragged) _coordinate_width = 0;
+    reset_data();
   }
 
   template<class T>
   size_t BatchData<T>::data_size(bool calculate) const
   {
     if (_dim.empty()) return 0;
-    if (!calculate && !_data.empty()) return _data.size();
+    if (!calculate && !_data->empty()) return _data->size();
     size_t length = 1;
     for (auto const& dim : _dim) length *= dim;
     return length;
@@ -129,11 +284,15 @@ namespace larcv3 {
   {
     if (_state != BatchDataState_t::kBatchStateFilling &&
         _state != BatchDataState_t::kBatchStateEmpty) {
-      LARCV_SERROR() << "Current batch state: " << (int)(_state)
+      LARCV_SERROR() << "Current batch state: " << (int)(_state.load())
                      << " not ready for filling data..." << std::endl;
       return;
     }
-    _state = BatchDataState_t::kBatchStateFilling;
+    if (_ragged) {
+      set_entry_data(entry_data, _filled_entries);
+      return;
+    }
+    mark_filling();
 
     size_t entry_size = entry_data_size();
     if ( (_current_size + entry_size) > data_size() ) {
@@ -146,22 +305,192 @@ namespace larcv3 {
 
     size_t entry_idx = 0;
     while (entry_idx < entry_data.size()) {
-      _data[_current_size] = entry_data[entry_idx];
+      (*_data)[_current_size] = entry_data[entry_idx];
       ++entry_idx;
       ++_current_size;
     }
     // _data = std::move(entry_data);
     // _current_size = entry_data.size();
-    if (_current_size == _data.size()){
+    if (_current_size == _data->size()){
+      _state = BatchDataState_t::kBatchStateFilled;
+    }
+  }
+
+  template<class T>
+  void BatchData<T>::set_entry_data(const std::vector<T>& entry_data, size_t entry)
+  {
+    if (_state != BatchDataState_t::kBatchStateFilling &&
+        _state != BatchDataState_t::kBatchStateEmpty) {
+      LARCV_SERROR() << "Current batch state: " << (int)(_state.load())
+                     << " not ready for filling data..." << std::endl;
+      return;
+    }
+    if (_ragged) {
+      set_entry_data(entry_data, std::vector<int>(), entry);
+      return;
+    }
+    mark_filling();
+
+    size_t entry_size = entry_data_size();
+    if ( (entry + 1) * entry_size > data_size() ) {
+      LARCV_SERROR() << "Entry " << entry
+                     << " with entry data size (" << entry_size
+                     << ") exceeds data buffer size (" << data_size()
+                     << std::endl;
+      return;
+    }
+
+    size_t n = std::min(entry_data.size(), entry_size);
+    std::copy(entry_data.begin(), entry_data.begin() + n, _data->begin() + entry * entry_size);
+
+    // Only the writer completing the buffer sees the total:
+    if ( (_current_size += n) == _data->size()){
+      _state = BatchDataState_t::kBatchStateFilled;
+    }
+  }
+
+  template<class T>
+  void BatchData<T>::set_entry_data(const std::vector<T>& entry_data,
+                                    const std::vector<int>& entry_coordinates, size_t entry)
+  {
+    if (_state != BatchDataState_t::kBatchStateFilling &&
+        _state != BatchDataState_t::kBatchStateEmpty) {
+      LARCV_SERROR() << "Current batch state: " << (int)(_state.load())
+                     << " not ready for filling data..." << std::endl;
+      return;
+    }
+    if (!_ragged) {
+      LARCV_SCRITICAL() << "Only ragged batches carry coordinates!" << std::endl;
+      throw larbys();
+    }
+    mark_filling();
+
+    size_t row_size = entry_data_size();
+    if (entry >= _entry_data_v.size() || entry_data.size() % row_size) {
+      LARCV_SERROR() << "Entry " << entry << " (of " << _entry_data_v.size()
+                     << ") with entry data size (" << entry_data.size()
+                     << ") is not a whole number of rows of size " << row_size
+                     << std::endl;
+      return;
+    }
+    size_t n_rows = entry_data.size() / row_size;
+    if (entry_coordinates.size() != n_rows * _coordinate_width) {
+      LARCV_SERROR() << "Entry " << entry << " has " << n_rows << " rows but "
+                     << entry_coordinates.size() << " coordinates (width "
+                     << _coordinate_width << ")" << std::endl;
+      return;
+    }
+    _entry_data_v[entry] = entry_data;
+    if (_coordinate_width) _entry_coordinates_v[entry] = entry_coordinates;
+    // Only the writer completing the batch sees the total, and joins the entries:
+    if (++_filled_entries == _entry_data_v.size()) join_entries();
+  }
+
+  template<class T>
+  T* BatchData<T>::entry_buffer(size_t entry, size_t n_rows)
+  {
+    if (_state != BatchDataState_t::kBatchStateFilling &&
+        _state != BatchDataState_t::kBatchStateEmpty) {
+      LARCV_SCRITICAL() << "Current batch state: " << (int)(_state.load())
+                        << " not ready for filling data..." << std::endl;
+      throw larbys();
+    }
+    mark_filling();
+
+    size_t entry_size = entry_data_size();
+    if (_ragged) {
+      if (entry >= _entry_data_v.size()) {
+        LARCV_SCRITICAL() << "Entry " << entry << " is out of the batch of "
+                          << _entry_data_v.size() << std::endl;
+        throw larbys();
+      }
+      _entry_data_v[entry].resize(n_rows * entry_size);
+      if (_coordinate_width) _entry_coordinates_v[entry].resize(n_rows * _coordinate_width);
+      return _entry_data_v[entry].data();
+    }
+    if ( (entry + 1) * entry_size > _data->size() ) {
+      LARCV_SCRITICAL() << "Entry " << entry << " with entry data size (" << entry_size
+                        << ") exceeds data buffer size (" << _data->size() << ")" << std::endl;
+      throw larbys();
+    }
+    return _data->data() + entry * entry_size;
+  }
+
+  template<class T>
+  int* BatchData<T>::entry_coordinates(size_t entry)
+  {
+    if (!_coordinate_width || entry >= _entry_coordinates_v.size()) {
+      LARCV_SCRITICAL() << "Entry " << entry << " has no coordinates in this batch!" << std::endl;
+      throw larbys();
+    }
+    return _entry_coordinates_v[entry].data();
+  }
+
+  template<class T>
+  void BatchData<T>::fill_entry(size_t entry)
+  {
+    // Only the writer completing the batch sees the total:
+    if (_ragged) {
+      if (++_filled_entries == _entry_data_v.size()) join_entries();
+    }
+    else if ( (_current_size += entry_data_size()) == _data->size() ) {
       _state = BatchDataState_t::kBatchStateFilled;
     }
   }
 
+  template <class T>
+  void BatchData<T>::join_entries()
+  {
+    size_t row_size = entry_data_size();
+    size_t total = 0;
+    _offsets->resize(_entry_data_v.size() + 1);
+    for (size_t entry = 0; entry < _entry_data_v.size(); ++entry) {
+      (*_offsets)[entry] = total / row_size;
+      total += _entry_data_v[entry].size();
+    }
+    _offsets->back() = total / row_size;
+
+    _data->resize(total);
+    auto output = _data->begin();
+    for (auto const & entry_data : _entry_data_v)
+      output = std::copy(entry_data.begin(), entry_data.end(), output);
+
+    if (_coordinate_width) {
+      _coordinates->resize(_offsets->back() * _coordinate_width);
+      auto coordinates = _coordinates->begin();
+      for (auto const & entry_coordinates : _entry_coordinates_v)
+        coordinates = std::copy(entry_coordinates.begin(), entry_coordinates.end(), coordinates);
+    }
+
+    _current_size = total;
+    _state = BatchDataState_t::kBatchStateFilled;
+  }
+
+  template <class T>
+  void BatchData<T>::mark_filling()
+  {
+    // Concurrent writers race to leave the empty state, only one of them moves it:
+    auto empty = BatchDataState_t::kBatchStateEmpty;
+    _state.compare_exchange_strong(empty, BatchDataState_t::kBatchStateFilling);
+  }
+
+  template <class T>
+  void BatchData<T>::unpin()
+  {
+    if (_data.use_count() > 1) _data = std::make_shared<std::vector<T> >();
+    if (_offsets.use_count() > 1) _offsets = std::make_shared<std::vector<int64_t> >();
+    if (_coordinates.use_count() > 1) _coordinates = std::make_shared<std::vector<int> >();
+  }
+
   template <class T>
   void BatchData<T>::reset()
   {
-    _data.clear(); _dim.clear();
+    unpin();
+    _data->clear(); _dim.clear();
+    _entry_data_v.clear(); _offsets->clear();
+    _entry_coordinates_v.clear(); _coordinates->clear();
     _current_size = 0;
+    _filled_entries = 0;
     _state = BatchDataState_t::kBatchStateEmpty;
   }
 
@@ -170,12 +499,26 @@ namespace larcv3 {
   {
     if (_state == BatchDataState_t::kBatchStateFilling) {
       LARCV_SERROR() << "Cannot reset batch (is in kBatchStateFilling state! size "
-                     << _current_size << "/" << _data.size() << ")" << std::endl;
+                     << _current_size << "/" << _data->size() << ")" << std::endl;
       return;
     }
     LARCV_SINFO() << "Resetting batch data status to " << (int)(BatchDataState_t::kBatchStateEmpty) << std::endl;
-    _data.resize(data_size(true));
+    // Views of the last batch keep their buffer, this batch is written to a new one:
+    unpin();
+    if (_ragged) {
+      // Entries keep their capacity from batch to batch:
+      _data->clear();
+      _entry_data_v.resize(_dim.empty() ? 0 : _dim.front());
+      for (auto & entry_data : _entry_data_v) entry_data.clear();
+      _coordinates->clear();
+      _entry_coordinates_v.resize(_coordinate_width ? _entry_data_v.size() : 0);
+      for (auto & entry_coordinates : _entry_coordinates_v) entry_coordinates.clear();
+    }
+    else {
+      _data->resize(data_size(true));
+    }
     _current_size = 0;
+    _filled_entries = 0;
     _state = BatchDataState_t::kBatchStateEmpty;
   }
 
@@ -220,11 +563,22 @@ void init_batchdata_(pybind11::module m){
     batch_data.def("entry_data_size",    &Class::entry_data_size);
     batch_data.def("set_dim",            &Class::set_dim);
     batch_data.def("set_dense_dim",      &Class::set_dense_dim);
-    batch_data.def("set_entry_data",     &Class::set_entry_data);
+    batch_data.def("set_entry_data",     (void (Class::*)(const std::vector<T>&))(&Class::set_entry_data));
+    batch_data.def("set_entry_data",     (void (Class::*)(const std::vector<T>&, size_t))(&Class::set_entry_data));
+    batch_data.def("set_entry_data",     (void (Class::*)(const std::vector<T>&, const std::vector<int>&, size_t))(&Class::set_entry_data));
     batch_data.def("reset",              &Class::reset);
     batch_data.def("reset_data",         &Class::reset_data);
     batch_data.def("is_filled",          &Class::is_filled);
     batch_data.def("state",              &Class::state);
+    batch_data.def("n_views",            &Class::n_views);
+    batch_data.def("set_ragged",         &Class::set_ragged);
+    batch_data.def("is_ragged",          &Class::is_ragged);
+    batch_data.def("offsets",            &Class::offsets);
+    batch_data.def("pyoffsets",          &Class::pyoffsets);
+    batch_data.def("set_coordinate_width", &Class::set_coordinate_width);
+    batch_data.def("coordinate_width",   &Class::coordinate_width);
+    batch_data.def("coordinates",        &Class::coordinates);
+    batch_data.def("pycoordinates",      &Class::pycoordinates);
 
 /*
 
@@ -15,7 +15,10 @@
 #define __LARCV3THREADIO_BATCHDATA_H
 
 #include <iostream>
+#include <cstdint>
 #include <vector>
+#include <atomic>
+#include <memory>
 #include "QueueIOTypes.h"
 #include "larcv3/core/pyutil/PyUtils.h"
 
@@ -37,35 +40,91 @@ namespace larcv3 {
 
     /// Default constructor
     BatchData()
-      : _current_size(0)
+      : _data(std::make_shared<std::vector<T> >())
+      , _offsets(std::make_shared<std::vector<int64_t> >())
+      , _coordinates(std::make_shared<std::vector<int> >())
+      , _coordinate_width(0)
+      , _current_size(0)
+      , _filled_entries(0)
+      , _ragged(false)
       , _state(BatchDataState_t::kBatchStateUnknown)
     {}
 
     /// Default destructor
     ~BatchData() {}
 
+    // Copy and move are written out since the fill counters and state are atomic
+    BatchData(const BatchData<T>& other);
+    BatchData(BatchData<T>&& other);
+    BatchData<T>& operator=(const BatchData<T>& other);
+    BatchData<T>& operator=(BatchData<T>&& other);
+
     const std::vector<T>& data() const;
 
     // Writeable access to data:
-    std::vector<T> & writeable_data() {return _data;}
+    std::vector<T> & writeable_data() {return *_data;}
 
 #ifdef LARCV_INTERNAL
+    // Zero-copy numpy view of the data, shaped as dim().  The view keeps the buffer
+    // alive, so it stays valid after the batch is popped and refilled.
     pybind11::array_t<T> pydata();
+    // Zero-copy numpy view of offsets(), which like pydata() keeps its buffer alive.
+    pybind11::array_t<int64_t> pyoffsets();
+    // Zero-copy numpy view of coordinates(), shaped (rows, coordinate_width()).
+    pybind11::array_t<int> pycoordinates();
 #endif
 
+    // A ragged batch takes any number of rows, each shaped as dim()[1:], per entry,
+    // instead of a fixed block.  dim()[0] stays the number of entries; the data is
+    // the rows of all entries, concatenated in entry order once the batch is full.
+    void set_ragged(bool ragged);
+    inline bool is_ragged() const { return _ragged; }
+    // First row of each entry of a filled ragged batch, and the total number of rows
+    const std::vector<int64_t>& offsets() const;
+
+    // A ragged batch can carry a second, int32 array alongside the data: one row of
+    // coordinate_width() integers per data row (for example, the batch index and
+    // voxel coordinates of each row of features).  0 means there is none.
+    void set_coordinate_width(size_t width);
+    inline size_t coordinate_width() const { return _coordinate_width; }
+    // Coordinate rows of a filled ragged batch, in the same order as the data rows
+    const std::vector<int>& coordinates() const;
+
+    // Number of views (from pydata) that still hold this batch's buffer.
+    // A pinned buffer is never written again: the next fill gets a new one.
+    inline size_t n_views() const { return _data.use_count() - 1; }
+
     inline const std::vector<int>& dim() const { return _dim; }
     inline const std::vector<int>& dense_dim() const { return _dense_dim; }
 
     // Data size is number of elements regardless of the size of each element
+    // (for a ragged batch, the size of a fixed batch of one row per entry)
     size_t data_size(bool calculate=false) const;
 
     inline size_t current_data_size() const { return _current_size; }
 
+    // Elements per entry, or per row of a ragged batch
     size_t entry_data_size() const;
 
     void set_dim(const std::vector<int>& dim);
     void set_dense_dim(const std::vector<int>& dense_dim);
     void set_entry_data(const std::vector<T>& entry_data);
+    // Write the data of one entry at its position in the batch.  Writes to
+    // distinct entries may happen concurrently once the buffer is sized.
+    // A ragged batch takes any whole number of rows here.
+    void set_entry_data(const std::vector<T>& entry_data, size_t entry);
+    // Same as above, for a ragged batch with coordinates: one coordinate row per data row.
+    void set_entry_data(const std::vector<T>& entry_data,
+                        const std::vector<int>& entry_coordinates, size_t entry);
+
+    // Direct filling, without a staging vector: the writable slot of one entry in the
+    // batch buffer, entry_data_size() elements, or n_rows rows of a ragged batch (and
+    // as many coordinate rows at entry_coordinates()).  Its contents are left over from
+    // an earlier batch until written; fill_entry() marks the entry done.  Slots of
+    // distinct entries may be written concurrently once the buffer is sized.
+    T* entry_buffer(size_t entry, size_t n_rows = 0);
+    int* entry_coordinates(size_t entry);
+    void fill_entry(size_t entry);
 
     void reset();
     void reset_data();
@@ -74,19 +133,37 @@ namespace larcv3 {
     { return ( _state == BatchDataState_t::kBatchStateFilled ); }
 
     inline BatchDataState_t state() const
-    { return _state; }
+    { return _state.load(); }
 
   private:
-    // This holds the data for this instance, and is changed often
-    std::vector<T>   _data;
+    // Move an empty batch to filling; safe to call from every concurrent writer
+    void mark_filling();
+    // Give this batch a buffer of its own if views still hold the current one
+    void unpin();
+    // Concatenate the rows of all entries of a ragged batch into _data
+    void join_entries();
+
+    // This holds the data for this instance, and is changed often.
+    // It is shared with the numpy views handed out by pydata.
+    std::shared_ptr<std::vector<T> > _data;
     // This holds the dimensions of the container for readout data (including sparse),
     // and is static. _data is flattened and this provides reshaping information
     std::vector<int> _dim;
     // This holds the dense shape of this data, in the case that the data is sparse
     // In the case that the data is dense, this matches _dim.
     std::vector<int> _dense_dim;
-    size_t _current_size;
-    BatchDataState_t _state;
+    // Ragged batches: each entry's rows until the batch is full, then the offsets
+    // (shared with the views handed out by pyoffsets)
+    std::vector<std::vector<T> > _entry_data_v;
+    std::shared_ptr<std::vector<int64_t> > _offsets;
+    // Ragged batches with coordinates: the same, for the int32 coordinate rows
+    std::vector<std::vector<int> > _entry_coordinates_v;
+    std::shared_ptr<std::vector<int> > _coordinates;
+    size_t _coordinate_width;
+    std::atomic<size_t> _current_size;
+    std::atomic<size_t> _filled_entries;
+    bool _ragged;
+    std::atomic<BatchDataState_t> _state;
   };
 }
 
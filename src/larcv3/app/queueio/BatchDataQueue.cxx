@@ -4,58 +4,119 @@
 #include "BatchDataQueue.h"
 #include "larcv3/core/base/larcv_logger.h"
 #include "larcv3/core/base/larbys.h"
+#include "larcv3/core/base/larcv_base.h"
+#include <chrono>
 
 namespace larcv3 {
 
-
-
-
-
-
   template <class T>
-  BatchDataQueue<T>::BatchDataQueue()
+  BatchDataQueue<T>::BatchDataQueue(size_t depth)
   {
+    set_depth(depth);
   }
 
   template <class T>
   void BatchDataQueue<T>::reset()
   {
-    
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto & slot : _slot_v) slot.reset();
+    // The consumer starts on the last slot so the producer starts on the first:
+    _current = _slot_v.size() - 1;
+    _n_ready = 0;
+    _n_popped = 0;
+    _n_blocked_pops = 0;
+    _blocked_time = 0;
+    _free_cv.notify_all();
   }
 
+  template <class T>
+  void BatchDataQueue<T>::set_depth(size_t depth)
+  {
+    if (depth == 0) {
+      LARCV_SCRITICAL() << "BatchDataQueue depth must be at least 1!" << std::endl;
+      throw larbys();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _slot_v.clear();
+      _slot_v.resize(depth + 1);
+    }
+    reset();
+  }
+
+  template <class T>
+  BatchDataState_t BatchDataQueue<T>::next_state() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slot_v[(_current + 1) % _slot_v.size()].state();
+  }
 
   template <class T>
   bool BatchDataQueue<T>::is_next_ready () const
   {
-    return _data_next.is_filled();
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _n_ready > 0;
+  }
+
+  template <class T>
+  size_t BatchDataQueue<T>::n_ready () const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _n_ready;
   }
 
-  
   template <class T>
   const BatchData<T>& BatchDataQueue<T>::get_batch () const
   {
-    return _data_current;
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slot_v[_current];
   }
 
   template <class T>
   BatchData<T>& BatchDataQueue<T>::get_next_writeable()
   {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // The producer may not write over the consumer's slot:
+    _free_cv.wait(lock, [this]{ return _n_ready + 1 < _slot_v.size(); });
+    return _slot_v[(_current + _n_ready + 1) % _slot_v.size()];
+  }
 
-    return _data_next;
+  template <class T>
+  void BatchDataQueue<T>::push()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_n_ready + 1 >= _slot_v.size()) {
+      LARCV_SCRITICAL() << "Cannot push a batch into a full queue!" << std::endl;
+      throw larbys();
+    }
+    _n_ready ++;
+    _ready_cv.notify_one();
   }
 
   template <class T>
   void BatchDataQueue<T>::set_next_data  (const std::vector<T>& source)
   {
-    _data_next.set_entry_data(source);
+    get_next_writeable().set_entry_data(source);
   }
 
   template <class T>
-  void BatchDataQueue<T>::pop(){
-    _data_current = std::move(_data_next);
-    _data_next.reset_data();
+  bool BatchDataQueue<T>::pop(bool blocking){
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_n_ready == 0) {
+      if (!blocking) return false;
+      _n_blocked_pops ++;
+      auto start = std::chrono::steady_clock::now();
+      _ready_cv.wait(lock, [this]{ return _n_ready > 0; });
+      _blocked_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    // The old current slot is handed back to the producer as is.  Numpy views of
+    // it (BatchData::pydata) keep its buffer, the producer refills a new one.
+    _current = (_current + 1) % _slot_v.size();
+    _n_ready --;
+    _n_popped ++;
+    _free_cv.notify_one();
+    return true;
   }
-
 }
 
 template class larcv3::BatchDataQueue<short>;
@@ -73,10 +134,20 @@ void init_batchdataqueue(pybind11::module m){
     pybind11::class_<Class> batch_data_queue(m, classname.c_str());
     batch_data_queue.def(pybind11::init<>());
     batch_data_queue.def("reset",          &Class::reset);
+    batch_data_queue.def("depth",          &Class::depth);
     batch_data_queue.def("next_state",     &Class::next_state);
     batch_data_queue.def("is_next_ready",  &Class::is_next_ready);
-    batch_data_queue.def("get_batch",      &Class::get_batch);
-    batch_data_queue.def("pop",            &Class::pop);
+    // By reference, so python sees the slot itself rather than a copy of the batch:
+    batch_data_queue.def("get_batch",      &Class::get_batch,
+      pybind11::return_value_policy::reference_internal);
+    // A blocking pop waits on the producer, which needs the GIL to be free:
+    batch_data_queue.def("pop",            &Class::pop,
+      pybind11::arg("blocking")=true,
+      larcv3::release_gil());
+    batch_data_queue.def("n_ready",        &Class::n_ready);
+    batch_data_queue.def("n_popped",       &Class::n_popped);
+    batch_data_queue.def("n_blocked_pops", &Class::n_blocked_pops);
+    batch_data_queue.def("blocked_time",   &Class::blocked_time);
 
 
 }
@@ -15,29 +15,40 @@
 #define __LARCV3THREADIO_BATCHDATAQUEUE_H
 
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
 #include "BatchData.h"
 
 namespace larcv3 {
   /**
      \class BatchDataQueue
-     User defined class BatchDataQueue ... these comments are used to generate
-     doxygen documentation!
+     A ring of BatchData slots shared by one producer (the QueueProcessor) and one
+     consumer.  The consumer holds the "current" slot until the next pop, the
+     producer writes the "next" slot, and up to depth() filled batches can wait
+     between them.
   */
   template <class T>
   class BatchDataQueue {
 
   public:
     /// Default constructor
-    BatchDataQueue();
+    BatchDataQueue(size_t depth=1);
 
     /// Default destructor
     ~BatchDataQueue(){}
 
+    BatchDataQueue(const BatchDataQueue<T>&) = delete;
+    BatchDataQueue<T>& operator=(const BatchDataQueue<T>&) = delete;
+
     void reset();
 
+    // Number of batches that can be filled ahead of the current one.
+    // Changing it drops all data in the queue.
+    void set_depth(size_t depth);
+    inline size_t depth() const { return _slot_v.size() - 1; }
+
     // Return detailed state of the next batch
-    inline BatchDataState_t next_state() const
-    { return _data_next.state(); }
+    BatchDataState_t next_state() const;
 
     // Return whether the next batch of data is ready to go or not:
     bool is_next_ready () const;
@@ -47,23 +58,45 @@ namespace larcv3 {
     // pop is called.
     const BatchData<T>& get_batch  () const;
 
-    // Pop moves _data_next into _data_current and resets _data_next.
-    void pop();
+    // Pop releases the current batch and makes the oldest filled batch current.
+    // If blocking, waits for a filled batch, otherwise returns false if there is none.
+    bool pop(bool blocking=true);
 
-
-    // Writeable access to the next batch of data
+    // Writeable access to the next batch of data.  Blocks while the ring is full.
     BatchData<T>& get_next_writeable();
 
+    // Mark the next batch as filled and move the producer to the following slot
+    void push();
+
     // Set the data for the next batch
     void set_next_data  (const std::vector<T>& source);
 
+    // Queue statistics:
+    // Number of filled batches waiting to be popped
+    size_t n_ready() const;
+    // Number of batches popped since the last reset
+    inline size_t n_popped() const { return _n_popped; }
+    // Number of pops that had to wait for the producer
+    inline size_t n_blocked_pops() const { return _n_blocked_pops; }
+    // Total time (seconds) pops spent waiting for the producer
+    inline double blocked_time() const { return _blocked_time; }
 
   private:
-    larcv3::BatchData<T> _data_current;
-    larcv3::BatchData<T> _data_next;
 
-  };
+    // Ring of slots.  _current is the consumer's slot, the _n_ready slots after it are
+    // filled, and the one after those is where the producer writes.
+    std::vector<larcv3::BatchData<T> > _slot_v;
+    size_t _current;
+    size_t _n_ready;
+
+    size_t _n_popped;
+    size_t _n_blocked_pops;
+    double _blocked_time;
 
+    mutable std::mutex _mutex;
+    std::condition_variable _ready_cv;
+    std::condition_variable _free_cv;
+  };
 }
 
 #ifdef LARCV_INTERNAL
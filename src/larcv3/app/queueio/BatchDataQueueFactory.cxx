@@ -2,6 +2,7 @@
 #define __LARCV3THREADIO_BATCHDATAQUEUEFACTORY_CXX
 
 #include "BatchDataQueueFactory.h"
+#include "larcv3/core/base/larcv_base.h"
 
 namespace larcv3 {
 
@@ -82,11 +83,11 @@ void init_batchdataqueuefactory(pybind11::module m){
     std::string classname = "BatchDataQueueFactory" + larcv3::as_string<T>();
     pybind11::class_<Class> batch_data_queue(m, classname.c_str());
     batch_data_queue.def(pybind11::init<>());
-    batch_data_queue.def("get",              &Class::get);
+    batch_data_queue.def("get",              &Class::get, pybind11::return_value_policy::reference);
     batch_data_queue.def("exist_queue",      &Class::exist_queue);
     batch_data_queue.def("is_next_ready",    &Class::is_next_ready);
-    batch_data_queue.def("get_queue",        &Class::get_queue);
-    batch_data_queue.def("pop_all",          &Class::pop_all);
+    batch_data_queue.def("get_queue",        &Class::get_queue, pybind11::return_value_policy::reference);
+    batch_data_queue.def("pop_all",          &Class::pop_all, larcv3::release_gil());
     batch_data_queue.def("make_queue",       &Class::make_queue);
 
 }
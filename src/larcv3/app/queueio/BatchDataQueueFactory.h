@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <map>
+#include <tuple>
 #include "BatchDataQueue.h"
 #include "larcv3/core/base/larcv_logger.h"
 #include "larcv3/core/base/larbys.h"
@@ -59,7 +60,10 @@ namespace larcv3 {
         LARCV_SERROR() << "Queue name " << name << " already present..." << std::endl;
         return false;
       }
-      _queue_m.emplace(std::make_pair(name, BatchDataQueue<T>()));
+      // Queues hold their own locks and can not be copied, so build in place:
+      _queue_m.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(name),
+                       std::forward_as_tuple());
       return true;
     }
 
@@ -5,6 +5,7 @@
 #include "larcv3/core/dataformat/EventTensor.h"
 #include "larcv3/core/dataformat/EventParticle.h"
 #include <random>
+#include <algorithm>
 
 namespace larcv3 {
 
@@ -94,12 +95,14 @@ namespace larcv3 {
       if (label != kINVALID_SIZE) break;
     }
     LARCV_DEBUG() << "Found PDG code " << pdg << " (class=" << label << ")" << std::endl;
-    _entry_data.resize(_num_class, 0);
-    for (auto& v : _entry_data) v = 0;
-    _entry_data.at(label) = 1.;
-
-
-    set_entry_data(_entry_data);
+    if (label == kINVALID_SIZE) {
+      LARCV_CRITICAL() << "PDG code " << pdg << " is not in the PdgClassList" << std::endl;
+      throw larbys();
+    }
+    float * output = entry_buffer();
+    std::fill(output, output + _num_class, 0.);
+    output[label] = 1.;
+    fill_entry();
 
     return true;
   }
@@ -48,7 +48,6 @@ namespace larcv3 {
 
   private:
     std::string _part_producer;
-    std::vector<float> _entry_data;
     size_t _num_class;
     std::vector<int> _pdg_list;
   };
@@ -3,7 +3,7 @@
 
 #include "BatchFillerSparseTensor.h"
 
-#include <random>
+#include <algorithm>
 
 namespace larcv3 {
 
@@ -30,7 +30,22 @@ namespace larcv3 {
     _slice_v = cfg.get<std::vector<size_t> >("Channels", _slice_v);
     _include_values = cfg.get<bool>("IncludeValues", true);
 
-    if (_max_voxels == 0){
+    // Ragged output: every voxel of every entry, with no MaxVoxels padding or truncation.
+    // The batch is (total voxels, point) plus per-entry offsets, and 2D points start with
+    // the channel (the index in Channels).
+    _ragged = cfg.get<bool>("Ragged", false);
+
+    // Sparse convolution format (implies Ragged): an int32 (total voxels, 1 + dimension)
+    // coordinate array, each row starting with the entry's index in the batch, and a
+    // float (total voxels, features) array of values.  In 2D, MergeChannels puts the
+    // channels (which need the same voxel grid) in the feature columns of voxels at the
+    // same coordinates; otherwise each channel has its own rows, and the channel follows
+    // the batch index in the coordinates.
+    _sparse_conv = cfg.get<bool>("SparseConvFormat", false);
+    _merge_channels = cfg.get<bool>("MergeChannels", true);
+    if (_sparse_conv) _ragged = true;
+
+    if (_max_voxels == 0 && !_ragged){
       LARCV_CRITICAL() << "Maximum number of voxels must be non zero!" << std::endl;
       throw larbys();
     }
@@ -49,6 +64,12 @@ namespace larcv3 {
 
   template<size_t dimension>
   void BatchFillerSparseTensor<dimension>::_batch_begin_() {
+    this->set_ragged(_ragged);
+    if (_sparse_conv) {
+      size_t width = 1 + dimension;
+      if (dimension == 2 && !_merge_channels) width ++;
+      this->set_coordinate_width(width);
+    }
     if(!batch_data().dim().empty() && (int)(batch_size()) != batch_data().dim().front()) {
       LARCV_INFO() << "Batch size changed " << batch_data().dim().front() << "=>" << batch_size() << std::endl;
       auto dim = batch_data().dim();
@@ -65,7 +86,9 @@ namespace larcv3 {
   }
 
   template<size_t dimension>
-  void BatchFillerSparseTensor<dimension>::finalize() { _entry_data.clear(); }
+  void BatchFillerSparseTensor<dimension>::finalize() {
+    _index_buffer.clear();
+  }
 
   template<size_t dimension>
   int BatchFillerSparseTensor<dimension>::_check_projection(const int & projection_id) {
@@ -117,8 +140,16 @@ namespace larcv3 {
     If there are more points in the input than are available in the output,
     The points are truncated.
 
-    It's possible to do a random downsampling, but in case of segementation
-    networks this needs to be coordinated across the image and label filler.
+    In Ragged mode there is no N_max: the points of all entries are concatenated
+    into a (N_total, point_dim) tensor, with per-entry offsets, and in 2D each point
+    is prefixed with its channel.
+
+    In SparseConvFormat the coordinates go to a separate int32 array, prefixed with
+    the batch index, and the values (one per merged channel) are the features.
+
+    Augmentation is coordinated across the fillers (image and label, say) by the
+    QueueProcessor's Augment stage: every filler applies the same transform to its
+    coordinates, and drops the same voxels.
 
     */
 
@@ -139,12 +170,24 @@ namespace larcv3 {
       point_dim = dimension;
     }
 
+    // Length of one point in the output:
+    int row_dim = (_ragged && dimension == 2) ? point_dim + 1 : point_dim;
+
     std::vector<int> dim;
-    dim.resize(4);
-    dim.at(0) = batch_size();
-    dim.at(1) = _num_channels;
-    dim.at(2) = _max_voxels;
-    dim.at(3) = point_dim;
+    if (_sparse_conv) {
+      bool merged = dimension == 2 && _merge_channels;
+      dim = {int(batch_size()), merged ? int(_num_channels) : 1};
+    }
+    else if (_ragged) {
+      dim = {int(batch_size()), row_dim};
+    }
+    else {
+      dim.resize(4);
+      dim.at(0) = batch_size();
+      dim.at(1) = _num_channels;
+      dim.at(2) = _max_voxels;
+      dim.at(3) = point_dim;
+    }
     this->set_dim(dim);
 
 
@@ -159,22 +202,39 @@ namespace larcv3 {
     this->set_dense_dim(dense_dim);
 
 
-    if (_entry_data.size() != batch_data().entry_data_size())
-      _entry_data.resize(batch_data().entry_data_size(), 0.);
-
+    // The transform of the QueueProcessor's Augment stage, common to all fillers.  Without
+    // one, Augment flips the axes at random for this filler alone, from its worker's generator.
+    const AugmentTransform * transform = augment_transform();
+    AugmentTransform flips;
+    if (!transform && _augment) {
+      for (size_t axis = 0; axis < dimension; axis ++) flips.flip[axis] = generator()() & 1;
+      transform = &flips;
+    }
 
-    // Reset all values to 0.0 (or whatever is specified)
-    for (auto& v : _entry_data) v = _unfilled_voxel_value;
+    if (_sparse_conv) {
+      fill_sparse_conv(voxel_data, transform);
+      fill_entry();
+      return true;
+    }
 
-    // Get the random x/y/z flipping
-    bool flip_x = false;
-    bool flip_y = false;
-    bool flip_z = false;
-    if (_augment){
-      flip_x = bool(rand() % 2);
-      flip_y = bool(rand() % 2);
-      flip_z = bool(rand() % 2);
+    // The points go straight into this entry's slot of the batch.  A ragged
+    // entry gets one row per voxel:
+    float * buffer;
+    size_t n_rows = 0;
+    if (_ragged) {
+      for (auto const& voxel_set : voxel_data.as_vector()) {
+        if (_check_projection(voxel_set.meta().id()) < 0) continue;
+        n_rows += voxel_set.size();
+        if (dimension == 3) break;
+      }
+      buffer = entry_buffer(n_rows);
+    }
+    else {
+      // Reset all values to 0.0 (or whatever is specified)
+      buffer = entry_buffer();
+      std::fill(buffer, buffer + batch_data().entry_data_size(), _unfilled_voxel_value);
     }
+    size_t n_filled_rows = 0;
 
 
     for ( auto const& voxel_set : voxel_data.as_vector()){
@@ -186,52 +246,197 @@ namespace larcv3 {
       if (count < 0) continue;
 
       size_t max_voxel(voxel_set.size());
-      if (max_voxel > _max_voxels) {
+      if (!_ragged && max_voxel > _max_voxels) {
         max_voxel = _max_voxels;
         LARCV_INFO() << "Truncating the number of voxels to " << _max_voxels << "!" << std::endl;
       }
 
 
-      auto const& voxels = voxel_set.as_vector();
-      int i_x, i_y, i_z;
-      size_t index;
-
-      for (size_t i_voxel = 0; i_voxel < max_voxel; i_voxel ++) {
-
-        auto coords = meta.coordinates(voxels[i_voxel].id());
-
-        i_x = coords.at(0);
-        i_y = coords.at(1);
-        if (dimension == 3) i_z = coords.at(2);
-
-        if (flip_x) i_x = meta.number_of_voxels(0) - (i_x + 1);
-        if (flip_y) i_y = meta.number_of_voxels(1) - (i_y + 1);
-        if (flip_z && dimension == 3) i_z = meta.number_of_voxels(2) - (i_z + 1);
+      if (!meta.is_valid()) {
+        LARCV_CRITICAL() << "Can't fill voxels of projection " << projection_id
+                         << " with an invalid meta." << std::endl;
+        throw larbys();
+      }
 
-        index = count * (_max_voxels * point_dim) + i_voxel * point_dim;
+      auto const& voxels = voxel_set.as_vector();
+      float * rows;
+      size_t first_axis = 0;
+      if (_ragged) {
+        rows = buffer + n_filled_rows * row_dim;
+        if (dimension == 2) {
+          for (size_t i_voxel = 0; i_voxel < max_voxel; i_voxel ++)
+            rows[i_voxel * row_dim] = count;
+          first_axis = 1;
+        }
+      }
+      else {
+        rows = buffer + count * (_max_voxels * point_dim);
+      }
+      float * output = rows + first_axis;
 
-        _entry_data.at(index + 0) = i_x;
-        _entry_data.at(index + 1) = i_y;
-        if (dimension == 3) _entry_data.at(index + 2) = i_z;
+      // Unravel all the voxel ids at once, straight into the output:
+      _index_buffer.resize(max_voxel);
+      for (size_t i_voxel = 0; i_voxel < max_voxel; i_voxel ++)
+        _index_buffer[i_voxel] = voxels[i_voxel].id();
+      meta.unravel(_index_buffer.data(), max_voxel, output, row_dim);
 
-        if(_include_values) {
-          _entry_data.at(index + dimension) = voxels[i_voxel].value();
-        }
+      if(_include_values) {
+        for (size_t i_voxel = 0; i_voxel < max_voxel; i_voxel ++)
+          output[i_voxel * row_dim + dimension] = voxels[i_voxel].value();
       }
 
+      // Augment the whole rows in one pass, packing away the voxels that are removed:
+      size_t n_kept = max_voxel;
+      if (transform)
+        n_kept = augment_rows(VoxelMap(*transform, meta), _index_buffer.data(), max_voxel,
+                              rows, row_dim, first_axis);
+      if (_ragged)
+        n_filled_rows += n_kept;
+      else
+        std::fill(rows + n_kept * row_dim, rows + max_voxel * row_dim, _unfilled_voxel_value);
+
       // Only read the first voxel set in 3D
       if (dimension == 3) {
         break;
       }
     }
 
-    // record the entry data
-    LARCV_INFO() << "Inserting entry data of size " << _entry_data.size()
-                 << std::endl;
+    if (_ragged && n_filled_rows < n_rows) entry_buffer(n_filled_rows);
 
-    set_entry_data(_entry_data);
+    fill_entry();
 
     return true;
   }
+
+  template<size_t dimension>
+  void BatchFillerSparseTensor<dimension>::fill_sparse_conv(
+      const EventSparseTensor<dimension>& voxel_data, const AugmentTransform * transform) {
+
+    const bool merge = dimension == 2 && _merge_channels;
+    const size_t width = batch_data().coordinate_width();
+    // Axis coordinates start after the batch index (and the channel, if not merged):
+    const size_t first_axis = width - dimension;
+
+    // The selected voxel sets, by channel:
+    std::vector<const SparseTensor<dimension> *> channels(_num_channels, nullptr);
+    for (auto const& voxel_set : voxel_data.as_vector()) {
+      int count = _check_projection(voxel_set.meta().id());
+      if (count < 0) continue;
+      if (!voxel_set.meta().is_valid()) {
+        LARCV_CRITICAL() << "Can't fill voxels of projection " << voxel_set.meta().id()
+                         << " with an invalid meta." << std::endl;
+        throw larbys();
+      }
+      channels[count] = &voxel_set;
+      // Only read the first voxel set in 3D
+      if (dimension == 3) break;
+    }
+
+    size_t n_rows = 0;
+    size_t n_allocated = 0;
+    int * coordinates;
+    if (merge) {
+      const ImageMeta<dimension> * meta = nullptr;
+      for (auto const * channel : channels) {
+        if (!channel) continue;
+        if (!meta) { meta = &channel->meta(); continue; }
+        for (size_t axis = 0; axis < dimension; axis ++) {
+          if (channel->meta().number_of_voxels(axis) != meta->number_of_voxels(axis)) {
+            LARCV_CRITICAL() << "MergeChannels needs all channels on the same voxel grid, but projection "
+                             << channel->meta().id() << " differs from projection " << meta->id()
+                             << std::endl;
+            throw larbys();
+          }
+        }
+      }
+      // Each voxel set is sorted by id, so the rows are a merge of sorted lists:
+      _index_buffer.clear();
+      std::vector<size_t> position(_num_channels, 0);
+      while (true) {
+        VoxelID_t id = kINVALID_VOXELID;
+        for (size_t c = 0; c < _num_channels; c ++) {
+          if (channels[c] && position[c] < channels[c]->size())
+            id = std::min(id, channels[c]->as_vector()[position[c]].id());
+        }
+        if (id == kINVALID_VOXELID) break;
+        _index_buffer.push_back(id);
+        for (size_t c = 0; c < _num_channels; c ++) {
+          if (channels[c] && position[c] < channels[c]->size() &&
+              channels[c]->as_vector()[position[c]].id() == id) position[c] ++;
+        }
+      }
+      n_rows = _index_buffer.size();
+      n_allocated = n_rows;
+      float * data = entry_buffer(n_rows);
+      coordinates = entry_coordinates();
+      std::fill(data, data + n_rows * _num_channels, 0.);
+
+      // ... and every voxel lands on the row of its id:
+      for (size_t c = 0; c < _num_channels; c ++) {
+        if (!channels[c]) continue;
+        size_t row = 0;
+        for (auto const& voxel : channels[c]->as_vector()) {
+          while (row < n_rows && _index_buffer[row] != voxel.id()) row ++;
+          // Only a voxel set out of id order misses its row:
+          if (row == n_rows) {
+            LARCV_CRITICAL() << "Voxel " << voxel.id() << " of projection " << channels[c]->meta().id()
+                             << " is out of order, MergeChannels needs voxel sets sorted by id"
+                             << std::endl;
+            throw larbys();
+          }
+          data[row * _num_channels + c] = voxel.value();
+        }
+      }
+      if (meta) {
+        meta->unravel(_index_buffer.data(), n_rows, coordinates + first_axis, width);
+        if (transform)
+          n_rows = augment_rows(VoxelMap(*transform, *meta), _index_buffer.data(), n_rows,
+                                coordinates, width, first_axis, data, _num_channels);
+      }
+    }
+    else {
+      for (auto const * channel : channels)
+        if (channel) n_rows += channel->size();
+      n_allocated = n_rows;
+      float * data = entry_buffer(n_rows);
+      coordinates = entry_coordinates();
+
+      // Each channel's rows are augmented as they are filled, after those kept before:
+      size_t first = 0;
+      for (size_t c = 0; c < _num_channels; c ++) {
+        if (!channels[c]) continue;
+        auto const& voxels = channels[c]->as_vector();
+        size_t n_voxels = voxels.size();
+
+        _index_buffer.resize(n_voxels);
+        for (size_t i_voxel = 0; i_voxel < n_voxels; i_voxel ++) {
+          _index_buffer[i_voxel] = voxels[i_voxel].id();
+          data[first + i_voxel] = voxels[i_voxel].value();
+        }
+        int * output = coordinates + first * width;
+        channels[c]->meta().unravel(_index_buffer.data(), n_voxels, output + first_axis, width);
+        if (dimension == 2) {
+          for (size_t i_voxel = 0; i_voxel < n_voxels; i_voxel ++)
+            output[i_voxel * width + 1] = c;
+        }
+        if (transform)
+          n_voxels = augment_rows(VoxelMap(*transform, channels[c]->meta()), _index_buffer.data(), n_voxels,
+                                  output, width, first_axis, data + first, size_t(1));
+        first += n_voxels;
+      }
+      n_rows = first;
+    }
+
+    // Give back the rows of the voxels that were removed:
+    if (n_rows < n_allocated) {
+      entry_buffer(n_rows);
+      coordinates = entry_coordinates();
+    }
+
+    // Every row starts with the batch index:
+    int entry = batch_entry();
+    for (size_t i_row = 0; i_row < n_rows; i_row ++)
+      coordinates[i_row * width] = entry;
+  }
 }
 #endif
@@ -54,6 +54,8 @@ namespace larcv3 {
 
     size_t set_data_size(const EventSparseTensor<dimension>& image_data);
     int _check_projection(const int & projection_id);
+    /// Fill the entry's data and coordinate rows in the sparse convolution format
+    void fill_sparse_conv(const EventSparseTensor<dimension>& voxel_data, const AugmentTransform * transform);
 
     std::string _tensor_producer;
     size_t _max_voxels;
@@ -62,11 +64,14 @@ namespace larcv3 {
 
 
 
-    std::vector<float>  _entry_data;
+    std::vector<size_t> _index_buffer;
     size_t _num_channels;
     bool _allow_empty;
     bool _include_values;
     bool _augment;
+    bool _ragged;
+    bool _sparse_conv;
+    bool _merge_channels;
   };
 
   typedef BatchFillerSparseTensor<2>  BatchFillerSparseTensor2D;
@@ -64,8 +64,19 @@ namespace larcv3 {
 
     inline void set_dim(std::vector<int> dim) {_batch_data_ptr->set_dim(dim);}
     inline void set_dense_dim(std::vector<int> dense_dim) {_batch_data_ptr->set_dense_dim(dense_dim);}
+    inline void set_ragged(bool ragged) {_batch_data_ptr->set_ragged(ragged);}
+    inline void set_coordinate_width(size_t width) {_batch_data_ptr->set_coordinate_width(width);}
     inline void set_entry_data(const std::vector<T>& data)
-    { _batch_data_ptr->set_entry_data(data); }
+    { _batch_data_ptr->set_entry_data(data, batch_entry()); }
+    inline void set_entry_data(const std::vector<T>& data, const std::vector<int>& coordinates)
+    { _batch_data_ptr->set_entry_data(data, coordinates, batch_entry()); }
+    /// Slot of the current entry in the batch buffer, filled in place (see BatchData::entry_buffer)
+    inline T* entry_buffer(size_t n_rows = 0)
+    { return _batch_data_ptr->entry_buffer(batch_entry(), n_rows); }
+    inline int* entry_coordinates()
+    { return _batch_data_ptr->entry_coordinates(batch_entry()); }
+    inline void fill_entry()
+    { _batch_data_ptr->fill_entry(batch_entry()); }
 
     virtual void _batch_begin_() =0;
     virtual void _batch_end_()   =0;
@@ -2,8 +2,7 @@
 #define __LARCV3THREADIO_BATCHFILLERTENSOR_CXX__
 
 #include "BatchFillerTensor.h"
-
-#include <random>
+#include "larcv3/core/base/StridedCopy.h"
 
 namespace larcv3 {
 
@@ -64,7 +63,7 @@ namespace larcv3 {
   }
 
   template<size_t dimension>
-  void BatchFillerTensor<dimension>::finalize() { _entry_data.clear(); }
+  void BatchFillerTensor<dimension>::finalize() {}
 
 
   template<size_t dimension>
@@ -186,9 +185,11 @@ namespace larcv3 {
       throw larbys();
     }
 
-    if (batch_data().dim().empty()) {
-      _set_image_size(image_data);
+    // Every worker's replica sizes itself, though only the first one sets the batch shape:
+    if (_dims[0] == kINVALID_SIZE) _set_image_size(image_data);
+    else _assert_dimension(image_data);
 
+    if (batch_data().dim().empty()) {
       std::vector<int> dim;
       dim.resize(dimension + 2);
       dim[0] = batch_size();
@@ -197,73 +198,25 @@ namespace larcv3 {
       }
       dim[dimension + 1] = _num_channels;
       set_dim(dim);
-    } else {
-      _assert_dimension(image_data);
-    }
-
-    if (_entry_data.size() != batch_data().entry_data_size()) {
-      _entry_data.resize(batch_data().entry_data_size(), 0.);
     }
 
-    for (auto& v : _entry_data) v = 0.;
-
+    // Tensors are stored in row-major order (see ImageMeta::index), as is the batch, with
+    // the channels last: filling an entry interleaves the channels, straight into its slot.
     auto const& image_v = image_data.as_vector();
+    std::vector<const float*> inputs;
+    for (size_t ch = 0; ch < _num_channels; ++ch)
+      inputs.push_back(image_v.at(_slice_v.at(ch)).as_vector().data());
 
-    for (size_t ch = 0; ch < _num_channels; ++ch) {
-
-      size_t input_ch = _slice_v.at(ch);
-      auto const& input_img = image_v.at(input_ch);
-
-      auto const& input_image = input_img.as_vector();
+    // Augmentation turns the same copy around, by its strides:
+    std::vector<size_t> shape(_dims, _dims + dimension);
+    if (augment_transform())
+      augment_copy(VoxelMap(*augment_transform(), shape.data(), dimension), inputs,
+                   entry_buffer(), _voxel_base_value);
+    else
+      strided_copy(inputs, row_major_strides(shape),
+                   entry_buffer(), row_major_strides(shape, _num_channels), 1, shape);
 
-      if (dimension == 1) {
-        for (size_t i = 0; i < _dims[0]; i++) {
-          _entry_data.at(i) = input_image.at(i);
-        }
-      } else if (dimension == 2) {
-        size_t idx = 0;
-        for (size_t row = 0; row < _dims[0]; ++row) {
-          for (size_t col = 0; col < _dims[1]; ++col) {
-            _entry_data.at(idx * _num_channels + ch) = input_image.at(col * _dims[0] + row);
-            ++idx;
-          }
-        }
-      } else if (dimension == 3) {
-        size_t idx = 0;
-        for (size_t row = 0; row < _dims[0]; ++row) {
-          for (size_t col = 0; col < _dims[1]; ++col) {
-            for (size_t dep = 0; dep < _dims[2]; ++dep) {
-              _entry_data.at(idx * _num_channels + ch) =
-                      input_image.at(dep * _dims[0] + col * _dims[1] + row);
-              ++idx;
-            }
-          }
-        }
-      } else if (dimension == 4) {
-        size_t idx = 0;
-        for (size_t row = 0; row < _dims[0]; ++row) {
-          for (size_t col = 0; col < _dims[1]; ++col) {
-            for (size_t dep = 0; dep < _dims[2]; ++dep) {
-              for (size_t j = 0; j < _dims[3]; ++j) {
-                _entry_data.at(idx * _num_channels + ch) =
-                        input_image.at(j * _dims[0] + dep * _dims[1] + col * _dims[2] + row);
-                ++idx;
-              }
-            }
-          }
-        }
-      } else {
-        LARCV_CRITICAL() << "BatchFillerTensor from dense Tensor not available in "
-                         << dimension << "D."
-                         << std::endl;
-        throw larbys();
-      }
-    }
-
-    // record the entry data
-    LARCV_INFO() << "Inserting entry data of size " << _entry_data.size()
-                 << std::endl;
-    set_entry_data(_entry_data);
+    fill_entry();
 
     return true;
 
@@ -296,11 +249,9 @@ namespace larcv3 {
     this->set_dense_dim(dim);
 
 
-    if (_entry_data.size() != batch_data().entry_data_size())
-      _entry_data.resize(batch_data().entry_data_size(), 0.);
-
-
-    for (auto& v : _entry_data) v = _voxel_base_value;
+    // Scatter straight into this entry's slot of the batch, channels last:
+    float * output = entry_buffer();
+    std::fill(output, output + batch_data().entry_data_size(), _voxel_base_value);
 
 
     for ( auto const& voxel_set : voxel_data.as_vector()){
@@ -311,8 +262,17 @@ namespace larcv3 {
       int count = _check_projection(projection_id);
       if (count < 0) continue;
 
-      for (auto const& voxel : voxel_set.as_vector()) {
-        _entry_data[voxel.id()] = voxel.value();
+      if (!augment_transform()) {
+        for (auto const& voxel : voxel_set.as_vector())
+          output[voxel.id() * _num_channels + count] = voxel.value();
+      }
+      else {
+        VoxelMap map(*augment_transform(), meta);
+        std::array<size_t, dimension> moved;
+        for (auto const& voxel : voxel_set.as_vector()) {
+          if (!(map.move(meta.unravel(voxel.id()).data(), moved.data()) & map.keep(voxel.id()))) continue;
+          output[meta.ravel(moved) * _num_channels + count] = voxel.value();
+        }
       }
 
       // Only read the first voxel set in 3D
@@ -321,10 +281,7 @@ namespace larcv3 {
       }
     }
 
-    // record the entry data
-    LARCV_INFO() << "Inserting entry data of size " << _entry_data.size()
-                 << std::endl;
-    set_entry_data(_entry_data);
+    fill_entry();
 
     return true;
   }
@@ -68,7 +68,6 @@ namespace larcv3 {
     std::vector<size_t> _slice_v;
     size_t _max_ch;
 
-    std::vector<float>  _entry_data;
     size_t _num_channel;
     float _voxel_base_value;
     bool _allow_empty;
@@ -16,6 +16,7 @@
 
 #include "larcv3/core/processor/ProcessBase.h"
 #include "QueueIOTypes.h"
+#include "Augmentation.h"
 namespace larcv3 {
   class QueueProcessor;
 
@@ -32,6 +33,8 @@ namespace larcv3 {
     BatchHolder(const std::string name="BatchFiller")
       : ProcessBase(name)
       , _batch_size(0)
+      , _batch_entry(0)
+      , _transform(nullptr)
     {}
     
     /// Default destructor
@@ -39,6 +42,16 @@ namespace larcv3 {
 
     inline size_t batch_size() const { return _batch_size; }
 
+    /// Position, within the batch, of the entry currently being processed
+    inline size_t batch_entry() const { return _batch_entry; }
+
+    /// Augmentation of the entry currently being processed, shared by all fillers (nullptr if none)
+    inline const AugmentTransform* augment_transform() const { return _transform; }
+
+    /// Random generator of this filler, for augmentation it draws on its own.  A QueueProcessor
+    /// seeds it per worker from its Augment Seed, like the generators of its Augment stage.
+    inline std::mt19937_64& generator() { return _generator; }
+
     virtual BatchDataType_t data_type() const = 0;
 
     inline bool is(const std::string question) const
@@ -46,6 +59,9 @@ namespace larcv3 {
 
   private:
     size_t _batch_size;
+    size_t _batch_entry;
+    const AugmentTransform* _transform;
+    std::mt19937_64 _generator;
   };
 
 }
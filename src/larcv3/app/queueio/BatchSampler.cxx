@@ -0,0 +1,144 @@
+#ifndef __LARCV3THREADIO_BATCHSAMPLER_CXX
+#define __LARCV3THREADIO_BATCHSAMPLER_CXX
+
+#include "BatchSampler.h"
+#include "larcv3/core/base/larbys.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace larcv3 {
+
+  BatchSampler::BatchSampler(std::string name)
+    : larcv_base(name)
+    , _batch_size(0)
+    , _voxel_budget(0)
+    , _bucket_batches(50)
+    , _shuffle(true)
+    , _seed(0)
+    , _epoch(0)
+    , _next_batch(0)
+  {}
+
+  void BatchSampler::configure(const PSet& cfg)
+  {
+    set_verbosity( (msg::Level_t)(cfg.get<unsigned short>("Verbosity", logger().level())) );
+
+    // The sizes are the voxel counts of this product, from the input manifest:
+    _product  = cfg.get<std::string>("Product");
+    _producer = cfg.get<std::string>("Producer");
+
+    _batch_size     = cfg.get<size_t>("BatchSize");
+    _voxel_budget   = cfg.get<size_t>("VoxelBudget", 0);
+    _bucket_batches = cfg.get<size_t>("BucketBatches", 50);
+    _shuffle        = cfg.get<bool>("Shuffle", true);
+    _seed           = cfg.get<unsigned int>("Seed", 0);
+
+    if (_batch_size == 0 || _bucket_batches == 0) {
+      LARCV_CRITICAL() << "BatchSize and BucketBatches must be at least 1!" << std::endl;
+      throw larbys();
+    }
+
+    _epoch = 0;
+    _next_batch = 0;
+    _batch_v.clear();
+  }
+
+  void BatchSampler::set_sizes(const std::vector<size_t>& sizes)
+  {
+    _size_v = sizes;
+    set_epoch(_epoch);
+  }
+
+  void BatchSampler::set_epoch(size_t epoch)
+  {
+    _epoch = epoch;
+    _next_batch = 0;
+    plan_epoch();
+  }
+
+  std::vector<size_t> BatchSampler::next_batch()
+  {
+    if (_size_v.empty()) {
+      LARCV_CRITICAL() << "No entries to sample, set_sizes() must be called first!" << std::endl;
+      throw larbys();
+    }
+    if (_next_batch >= _batch_v.size()) set_epoch(_epoch + 1);
+    return _batch_v[_next_batch++];
+  }
+
+  void BatchSampler::plan_epoch()
+  {
+    _batch_v.clear();
+    if (_size_v.empty()) return;
+
+    std::seed_seq seed{_seed, (unsigned int)(_epoch)};
+    std::mt19937_64 generator(seed);
+
+    std::vector<size_t> order(_size_v.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (_shuffle) std::shuffle(order.begin(), order.end(), generator);
+
+    size_t window = _bucket_batches * _batch_size;
+    size_t n_oversize = 0;
+    for (size_t first = 0; first < order.size(); first += window) {
+      auto begin = order.begin() + first;
+      auto end   = order.begin() + std::min(first + window, order.size());
+      // Stable, so equal sizes keep their shuffled order:
+      std::stable_sort(begin, end,
+        [this](size_t a, size_t b) { return _size_v[a] < _size_v[b]; });
+
+      std::vector<size_t> batch;
+      size_t batch_voxels = 0;
+      for (auto entry = begin; entry != end; ++entry) {
+        size_t voxels = _size_v[*entry];
+        bool full = batch.size() == _batch_size ||
+                    (_voxel_budget && batch_voxels + voxels > _voxel_budget);
+        if (full && !batch.empty()) {
+          _batch_v.push_back(std::move(batch));
+          batch.clear();
+          batch_voxels = 0;
+        }
+        if (_voxel_budget && voxels > _voxel_budget) n_oversize ++;
+        batch.push_back(*entry);
+        batch_voxels += voxels;
+      }
+      if (!batch.empty()) _batch_v.push_back(std::move(batch));
+    }
+
+    if (_shuffle) std::shuffle(_batch_v.begin(), _batch_v.end(), generator);
+
+    if (n_oversize)
+      LARCV_WARNING() << n_oversize << " entries have more voxels than the VoxelBudget ("
+                      << _voxel_budget << ") and get a batch of their own" << std::endl;
+    LARCV_INFO() << "Epoch " << _epoch << ": " << _batch_v.size() << " batches of "
+                 << _size_v.size() << " entries" << std::endl;
+  }
+
+}
+
+#include <pybind11/stl.h>
+
+void init_batchsampler(pybind11::module m){
+
+  using Class = larcv3::BatchSampler;
+  pybind11::class_<Class> sampler(m, "BatchSampler");
+
+  sampler.def(pybind11::init<std::string>(),
+    pybind11::arg("name") = "BatchSampler");
+
+  sampler.def("configure",    &Class::configure);
+  sampler.def("set_sizes",    &Class::set_sizes);
+  sampler.def("next_batch",   &Class::next_batch);
+  sampler.def("set_epoch",    &Class::set_epoch);
+  sampler.def("epoch",        &Class::epoch);
+  sampler.def("n_batches",    &Class::n_batches);
+  sampler.def("n_sampled",    &Class::n_sampled);
+  sampler.def("product",      &Class::product);
+  sampler.def("producer",     &Class::producer);
+  sampler.def("batch_size",   &Class::batch_size);
+  sampler.def("voxel_budget", &Class::voxel_budget);
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * \file BatchSampler.h
+ *
+ * \ingroup ThreadIO
+ *
+ * \brief Class def header for a class BatchSampler
+ *
+ * @author cadams
+ */
+
+/** \addtogroup ThreadIO
+
+    @{*/
+#ifndef __LARCV3THREADIO_BATCHSAMPLER_H
+#define __LARCV3THREADIO_BATCHSAMPLER_H
+
+#include <vector>
+#include <string>
+
+#include "larcv3/core/base/larcv_base.h"
+#include "larcv3/core/base/PSet.h"
+
+namespace larcv3 {
+  /**
+     \class BatchSampler
+     \brief Chooses the entries of each batch from their sizes, so batches hold similar-size entries.
+
+     Every epoch the entries are shuffled, cut into windows of BucketBatches batches, and each
+     window is sorted by size before it is split into batches: entries of similar size end up
+     together, but which ones still changes from epoch to epoch.  A batch takes up to BatchSize
+     entries and, with a VoxelBudget, stops before its total size would go over the budget.
+     The order of the batches is shuffled too.  Everything is drawn from a generator seeded
+     with (Seed, epoch), so the sequence of batches is reproducible.
+  */
+  class BatchSampler : public larcv_base {
+
+  public:
+
+    /// Default constructor
+    BatchSampler(std::string name = "BatchSampler");
+
+    /// Default destructor
+    ~BatchSampler() {}
+
+    void configure(const PSet& cfg);
+
+    /// Per-entry sizes (for example voxel counts), which also set the number of entries
+    void set_sizes(const std::vector<size_t>& sizes);
+
+    /// Entries of the next batch.  Starts the next epoch when this one is used up.
+    std::vector<size_t> next_batch();
+
+    /// Restart from the first batch of the given epoch
+    void set_epoch(size_t epoch);
+    inline size_t epoch() const { return _epoch; }
+
+    /// Batches in the current epoch, and how many of them were handed out
+    inline size_t n_batches() const { return _batch_v.size(); }
+    inline size_t n_sampled() const { return _next_batch; }
+
+    /// Product whose per-entry voxel counts are the sizes
+    inline const std::string& product() const { return _product; }
+    inline const std::string& producer() const { return _producer; }
+
+    inline size_t batch_size() const { return _batch_size; }
+    inline size_t voxel_budget() const { return _voxel_budget; }
+
+  private:
+
+    /// Draw the batches of the current epoch
+    void plan_epoch();
+
+    std::string _product;
+    std::string _producer;
+    size_t _batch_size;
+    size_t _voxel_budget;
+    size_t _bucket_batches;
+    bool _shuffle;
+    unsigned int _seed;
+
+    std::vector<size_t> _size_v;
+    size_t _epoch;
+    size_t _next_batch;
+    std::vector<std::vector<size_t> > _batch_v;
+  };
+
+}
+
+#ifdef LARCV_INTERNAL
+#include <pybind11/pybind11.h>
+void init_batchsampler(pybind11::module m);
+#endif
+
+#endif
+/** @} */ // end of doxygen group
@@ -9,6 +9,7 @@
 #include "BatchDataQueueFactory.h"
 #include <mutex>
 #include <chrono>
+#include <algorithm>
 
 #ifdef LARCV_OPENMP
 #include <omp.h>
@@ -29,12 +30,13 @@ int omp_thread_count() {
     : larcv_base(name)
     , _processing(false)
     , _configured(false)
+    , _use_sampler(false)
+    , _use_shard_sampler(false)
+    , _use_augmentation(false)
     , _batch_global_counter(0)
-  {
-
-    std::future<bool> f = std::async(std::launch::deferred, [](){return true;});
-    _preparation_future = std::move(f);
-  }
+    , _num_workers(1)
+    , _queue_depth(1)
+  {}
 
   QueueProcessor::~QueueProcessor()
   { reset(); }
@@ -103,10 +105,37 @@ int omp_thread_count() {
   }
 
 
+  void QueueProcessor::set_sampler_epoch(size_t epoch)
+  {
+    if (_use_sampler) _sampler.set_epoch(epoch);
+    else if (_use_shard_sampler) _shard_sampler.set_epoch(epoch);
+    else {
+      LARCV_CRITICAL() << "No Sampler is configured!" << std::endl;
+      throw larbys();
+    }
+  }
+
+  void QueueProcessor::set_shard(size_t shard, size_t n_shards, size_t batch_size)
+  {
+    if (!_use_shard_sampler) {
+      LARCV_CRITICAL() << "No ShardSampler is configured!" << std::endl;
+      throw larbys();
+    }
+    _shard_sampler.set_shard(shard, n_shards, batch_size);
+  }
+
   void QueueProcessor::reset()
   {
+    // Let pending preparations finish before tearing down the drivers
+    for (auto & future : _preparation_future_v) future.wait();
+    _preparation_future_v.clear();
+    _prepared_entries_v.clear();
+    _prepared_events_v.clear();
+
     // per-thread variables
     _driver.reset();
+    for (auto & driver : _worker_driver_v) driver->reset();
+    _worker_driver_v.clear();
 
     _current_batch_entries_v.clear();
     _current_batch_events_v.clear();
@@ -118,6 +147,10 @@ int omp_thread_count() {
 
 
     _next_index_v.clear();
+    _use_sampler = false;
+    _use_shard_sampler = false;
+    _use_augmentation = false;
+    _augment_generator_v.clear();
 
     // others
     _configured = false;
@@ -150,37 +183,25 @@ int omp_thread_count() {
     configure(cfg);
   }
 
-  void QueueProcessor::pop_current_data()
+  bool QueueProcessor::pop_current_data(bool blocking)
   {
 
-    bool ready = true;
-
-    for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
-      auto const& name = _process_name_v[pid];
-
-      auto proc_ptr = _driver.process_ptr(pid);
-      if (!(proc_ptr->is("BatchFiller"))) continue;
-      auto datatype = ((BatchHolder*)(proc_ptr))->data_type() ;
-
+    if (_preparation_future_v.empty()){
+      LARCV_ERROR() << "Can't pop current data because no batch has been prepared." << std::endl;
+      return false;
+    }
 
-      switch ( datatype ) {
-      case BatchDataType_t::kBatchDataShort:
-        ready = ready && BatchDataQueueFactory<short>::get().get_queue(name).is_next_ready(); break;
-      case BatchDataType_t::kBatchDataInt:
-        ready = ready && BatchDataQueueFactory<int>::get().get_queue(name).is_next_ready(); break;
-      case BatchDataType_t::kBatchDataFloat:
-        ready = ready && BatchDataQueueFactory<float>::get().get_queue(name).is_next_ready(); break;
-      case BatchDataType_t::kBatchDataDouble:
-        ready = ready && BatchDataQueueFactory<double>::get().get_queue(name).is_next_ready(); break;
-      default:
-        LARCV_CRITICAL() << "Process name " << name
-                         << " encountered none-supported BatchDataType_t: " << int(datatype) << std::endl;
-        throw larbys();
-      }
+    if (!blocking &&
+        _preparation_future_v.front().wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+      return false;
     }
 
-    if (! ready){
-      LARCV_ERROR() << "Can't pop current data because the next data is not yet ready." << std::endl;
+    // Waits for the oldest batch, and rethrows anything thrown while preparing it:
+    auto future = _preparation_future_v.front();
+    _preparation_future_v.pop_front();
+    if (!future.get()) {
+      LARCV_ERROR() << "Can't pop current data because the batch failed to prepare." << std::endl;
+      return false;
     }
 
     for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
@@ -207,10 +228,14 @@ int omp_thread_count() {
       }
     }
 
-    // Calling pop_all on the batches will automatically promote next to current;
+    // Popping the queues promoted the oldest prepared batch to current;
     // Therefore, promote the indexing too:
-    _current_batch_events_v = std::move(_next_batch_events_v);
-    _current_batch_entries_v = std::move(_next_batch_entries_v);
+    std::lock_guard<std::mutex> lock(_prepared_mutex);
+    _current_batch_events_v = std::move(_prepared_events_v.front());
+    _current_batch_entries_v = std::move(_prepared_entries_v.front());
+    _prepared_events_v.pop_front();
+    _prepared_entries_v.pop_front();
+    return true;
   }
 
   void QueueProcessor::configure(const PSet& orig_cfg, int color)
@@ -223,6 +248,18 @@ int omp_thread_count() {
 
     _input_fname_v = orig_cfg.get<std::vector<std::string> >("InputFiles");
 
+    _num_workers = orig_cfg.get<size_t>("NumWorkers", 1);
+    if (_num_workers == 0) {
+      LARCV_CRITICAL() << "NumWorkers must be at least 1!" << std::endl;
+      throw larbys();
+    }
+
+    _queue_depth = orig_cfg.get<size_t>("QueueDepth", 1);
+    if (_queue_depth == 0) {
+      LARCV_CRITICAL() << "QueueDepth must be at least 1!" << std::endl;
+      throw larbys();
+    }
+
     _process_name_v.clear();
 
     // Initialize the ProcessDriver:
@@ -257,12 +294,18 @@ int omp_thread_count() {
     io_cfg.add_value("OutFileName", "");
     io_cfg.add_value("StoreOnlyType", "[]");
     io_cfg.add_value("StoreOnlyName", "[]");
+    // A manifest lets every driver start without opening the files, and has the
+    // voxel counts a Sampler needs:
+    if (orig_cfg.contains_value("Manifest"))
+      io_cfg.add_value("Manifest", orig_cfg.get<std::string>("Manifest"));
     // io_cfg.add_value("UseH5CoreDriver", "true");
 
 
     LARCV_INFO() << "Constructing IO configuration: " << io_cfg_name << std::endl;
 
     for (auto const& pset_key : orig_cfg.pset_keys()) {
+      // The samplers and the augmentation belong to this QueueProcessor, not to the drivers:
+      if (pset_key == "Sampler" || pset_key == "ShardSampler" || pset_key == "Augment") continue;
       if (pset_key == "IOManager") {
         // auto const& orig_io_cfg = orig_cfg.get_pset(pset_key);
         LARCV_NORMAL() << "IOManager configuration will be ignored..." << std::endl;
@@ -313,13 +356,21 @@ int omp_thread_count() {
         auto const& name = _process_name_v[pid];
         switch ( datatype ) {
         case BatchDataType_t::kBatchDataShort:
-          BatchDataQueueFactory<short>::get_writeable().make_queue(name); break;
+          BatchDataQueueFactory<short>::get_writeable().make_queue(name);
+          BatchDataQueueFactory<short>::get_writeable().get_queue_writeable(name).set_depth(_queue_depth);
+          break;
         case BatchDataType_t::kBatchDataInt:
-          BatchDataQueueFactory<int>::get_writeable().make_queue(name); break;
+          BatchDataQueueFactory<int>::get_writeable().make_queue(name);
+          BatchDataQueueFactory<int>::get_writeable().get_queue_writeable(name).set_depth(_queue_depth);
+          break;
         case BatchDataType_t::kBatchDataFloat:
-          BatchDataQueueFactory<float>::get_writeable().make_queue(name); break;
+          BatchDataQueueFactory<float>::get_writeable().make_queue(name);
+          BatchDataQueueFactory<float>::get_writeable().get_queue_writeable(name).set_depth(_queue_depth);
+          break;
         case BatchDataType_t::kBatchDataDouble:
-          BatchDataQueueFactory<double>::get_writeable().make_queue(name); break;
+          BatchDataQueueFactory<double>::get_writeable().make_queue(name);
+          BatchDataQueueFactory<double>::get_writeable().get_queue_writeable(name).set_depth(_queue_depth);
+          break;
         default:
           LARCV_CRITICAL() << "Process name " << name
                            << " encountered none-supported BatchDataType_t: " << (int)(((BatchHolder*)(proc_ptr))->data_type()) << std::endl;
@@ -327,26 +378,109 @@ int omp_thread_count() {
         }
       }
     }
+
+    // Replicate the driver for each additional worker.  Queues are only made once,
+    // all replicas fill the same BatchData.
+    for (size_t i_worker = 1; i_worker < _num_workers; ++i_worker) {
+      LARCV_INFO() << "Configuring worker " << i_worker << " of " << _num_workers << std::endl;
+      std::unique_ptr<ProcessDriver> driver(new ProcessDriver(name() + "_worker" + std::to_string(i_worker)));
+      driver->configure(proc_cfg);
+      driver->override_input_file(_input_fname_v);
+      driver->initialize(color);
+      _worker_driver_v.push_back(std::move(driver));
+    }
+
+    // The sampler sizes entries by their voxel counts, which come from the manifest:
+    _use_sampler = orig_cfg.contains_pset("Sampler");
+    if (_use_sampler) {
+      _sampler.configure(orig_cfg.get<larcv3::PSet>("Sampler"));
+      auto sizes = _driver.io().voxel_counts(_sampler.product(), _sampler.producer());
+      if (sizes.empty()) {
+        LARCV_CRITICAL() << "The Sampler needs the voxel counts of " << _sampler.product()
+                         << " " << _sampler.producer() << ", from a Manifest built with them" << std::endl;
+        throw larbys();
+      }
+      _sampler.set_sizes(sizes);
+    }
+
+    // The shard sampler only needs the number of entries in each file:
+    _use_shard_sampler = orig_cfg.contains_pset("ShardSampler");
+    if (_use_shard_sampler) {
+      if (_use_sampler) {
+        LARCV_CRITICAL() << "Only one of Sampler and ShardSampler can be configured!" << std::endl;
+        throw larbys();
+      }
+      _shard_sampler.configure(orig_cfg.get<larcv3::PSet>("ShardSampler"));
+      _shard_sampler.set_input(_driver.io());
+    }
+
+    // One generator per worker, so the transforms are drawn without locking:
+    _use_augmentation = false;
+    if (orig_cfg.contains_pset("Augment")) {
+      _augmentation.configure(orig_cfg.get<larcv3::PSet>("Augment"));
+      _use_augmentation = _augmentation.enabled();
+    }
+    _augment_generator_v.clear();
+    for (size_t i_worker = 0; i_worker < _num_workers; ++i_worker) {
+      std::seed_seq seed{_augmentation.seed(), (unsigned int)(i_worker)};
+      _augment_generator_v.emplace_back(seed);
+    }
+
+    // Fillers that augment on their own are seeded the same way, so the workers differ:
+    for (size_t i_worker = 0; i_worker < _num_workers; ++i_worker) {
+      ProcessDriver & driver = (i_worker == 0) ? _driver : *_worker_driver_v.at(i_worker - 1);
+      for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
+        auto proc_ptr = driver.process_ptr(pid);
+        if (!(proc_ptr->is("BatchFiller"))) continue;
+        std::seed_seq seed{_augmentation.seed(), (unsigned int)(i_worker)};
+        ((BatchHolder*)(proc_ptr))->_generator.seed(seed);
+      }
+    }
+
     _configured = true;
   }
 
 
-  void QueueProcessor::prepare_next() {
+  bool QueueProcessor::is_reading() const {
+    for (auto & future : _preparation_future_v){
+      if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return true;
+    }
+    return false;
+  }
 
-    _preparation_future.wait();
+  bool QueueProcessor::prepare_next() {
 
+    // Each pending batch holds a slot in the queues, so never ask for more than fit:
+    if (_preparation_future_v.size() >= _queue_depth) {
+      LARCV_WARNING() << _preparation_future_v.size() << " batches are already prepared ahead (QueueDepth "
+                      << _queue_depth << "), pop one before preparing more." << std::endl;
+      return false;
+    }
 
-    _processing = true;
-    std::future<bool> fut = std::async(std::launch::async,
-                                       &QueueProcessor::batch_process, this);
+    std::shared_future<bool> previous;
+    if (!_preparation_future_v.empty()) previous = _preparation_future_v.back();
+    std::vector<size_t> index_v = _next_index_v;
+    if (_use_sampler) index_v = _sampler.next_batch();
+    else if (_use_shard_sampler) index_v = _shard_sampler.next_batch();
 
-    _preparation_future = std::move(fut);
+    std::shared_future<bool> fut = std::async(std::launch::async,
+      [this, previous, index_v]() {
+        if (previous.valid()) previous.wait();
+        return process_batch(index_v);
+      }).share();
 
-    return;
+    _preparation_future_v.push_back(fut);
+
+    return true;
 
   }
 
   bool QueueProcessor::batch_process() {
+    if (!prepare_next()) return false;
+    return _preparation_future_v.back().get();
+  }
+
+  bool QueueProcessor::process_batch(const std::vector<size_t>& index_v) {
 
     LARCV_DEBUG() << " start" << std::endl;
 
@@ -356,7 +490,7 @@ int omp_thread_count() {
       return false;
     }
     // must be non-zero entries to process
-    if (!_next_index_v.size()) {
+    if (!index_v.size()) {
       LARCV_ERROR() << "_next_index_v.size() must be positive integer..." << std::endl;
       return false;
     }
@@ -366,51 +500,52 @@ int omp_thread_count() {
     //
     _processing = true;
 
+    _batch_index_v = index_v;
+
     set_batch_storage();
 
     begin_batch();
 
 
     _next_batch_entries_v.clear();
-    _next_batch_entries_v.resize(_next_index_v.size());
+    _next_batch_entries_v.resize(_batch_index_v.size());
     _next_batch_events_v.clear();
-    _next_batch_events_v.resize(_next_index_v.size());
+    _next_batch_events_v.resize(_batch_index_v.size());
+    _transform_v.resize(_batch_index_v.size());
 
     LARCV_INFO() << "Entering process loop" << std::endl;
-    // auto start = std::chrono::steady_clock::now();
 
-#ifdef LARCV_OPENMP
-    std::cout << "Number of threads: " << omp_thread_count() << std::endl;
-#endif
-    // size_t i(0),
-    size_t i_entry(0);
-
-    // #pragma omp parallel
-    // {
-    //   #pragma omp single
-    //   {
-        for(i_entry =0; i_entry < _next_index_v.size(); ++ i_entry){
-          // #pragma omp task
-          // {
-            auto & entry = _next_index_v[i_entry];
-            LARCV_INFO() << "Processing entry: " << entry << std::endl;
-
-            // bool good_status =
-            _driver.process_entry(entry, true);
-            LARCV_INFO() << "Finished processing event id: " << _driver.event_id().event_key() << std::endl;
-            _next_batch_entries_v.at(i_entry) = entry;
-            _next_batch_events_v.at(i_entry) = _driver.event_id();
-          // }
-        }
-    //   }
-    // }
-
-
-    // auto duration = std::chrono::duration_cast< std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    size_t n_entries = _batch_index_v.size();
+    size_t n_workers = std::min(_worker_driver_v.size() + 1, n_entries);
 
+    if (n_workers == 1) {
+      process_entries(_driver, 0, 0, n_entries);
+    }
+    else {
+      // Each worker fills a contiguous slice of the batch.  The first entry is
+      // processed alone so that every BatchData has its dimensions set and its
+      // buffer allocated before the workers write into it concurrently.
+      process_entries(_driver, 0, 0, 1);
+
+      std::vector<std::future<void> > worker_futures;
+      for (size_t i_worker = 0; i_worker < n_workers; ++i_worker) {
+        size_t first = std::max((i_worker * n_entries) / n_workers, size_t(1));
+        size_t last  = ((i_worker + 1) * n_entries) / n_workers;
+        ProcessDriver * driver = (i_worker == 0) ? &_driver : _worker_driver_v.at(i_worker - 1).get();
+        worker_futures.push_back(std::async(std::launch::async,
+                                            &QueueProcessor::process_entries, this,
+                                            std::ref(*driver), i_worker, first, last));
+      }
+      // get() rethrows anything thrown by a worker:
+      for (auto & future : worker_futures) future.get();
+    }
 
-    // std::cout << "Duration of omp loop: " << duration.count() << std::endl;
-    // LARCV_DEBUG() << " end" << std::endl;
+    // The meta data has to be in place before the queues are pushed
+    {
+      std::lock_guard<std::mutex> lock(_prepared_mutex);
+      _prepared_entries_v.push_back(_next_batch_entries_v);
+      _prepared_events_v.push_back(_next_batch_events_v);
+    }
 
     end_batch();
 
@@ -423,49 +558,87 @@ int omp_thread_count() {
 
   }
 
-  bool QueueProcessor::set_batch_storage(){
+  void QueueProcessor::process_entries(ProcessDriver & driver, size_t worker, size_t first, size_t last) {
 
-    for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
-      auto proc_ptr = _driver.process_ptr(pid);
-      if (!(proc_ptr->is("BatchFiller"))) continue;
+    // Consecutive entries (serial access, random blocks) are read in a few large reads:
+    if (last - first > 1)
+      driver.read_entries(std::vector<size_t>(_batch_index_v.begin() + first, _batch_index_v.begin() + last));
 
-      auto const& name = _process_name_v[pid];
-      BatchDataState_t batch_state = BatchDataState_t::kBatchStateUnknown;
-      switch ( ((BatchHolder*)(proc_ptr))->data_type() ) {
-      case BatchDataType_t::kBatchDataShort:
-        ((BatchFillerTemplate<short>*)proc_ptr)->_batch_data_ptr
-          = &(BatchDataQueueFactory<short>::get_writeable().get_queue_writeable(name).get_next_writeable());
-        batch_state = ((BatchFillerTemplate<short>*)proc_ptr)->_batch_data_ptr->state();
-        break;
-      case BatchDataType_t::kBatchDataInt:
-        ((BatchFillerTemplate<int>*)proc_ptr)->_batch_data_ptr
-          = &(BatchDataQueueFactory<int>::get_writeable().get_queue_writeable(name).get_next_writeable());
-        batch_state = ((BatchFillerTemplate<int>*)proc_ptr)->_batch_data_ptr->state();
-        break;
-      case BatchDataType_t::kBatchDataFloat:
-        ((BatchFillerTemplate<float>*)proc_ptr)->_batch_data_ptr
-          = &(BatchDataQueueFactory<float>::get_writeable().get_queue_writeable(name).get_next_writeable());
-        batch_state = ((BatchFillerTemplate<float>*)proc_ptr)->_batch_data_ptr->state();
-        break;
-      case BatchDataType_t::kBatchDataDouble:
-        ((BatchFillerTemplate<double>*)proc_ptr)->_batch_data_ptr
-          = &(BatchDataQueueFactory<double>::get_writeable().get_queue_writeable(name).get_next_writeable());
-        batch_state = ((BatchFillerTemplate<double>*)proc_ptr)->_batch_data_ptr->state();
-        break;
-      default:
-        LARCV_CRITICAL() << "Process name " << name
-                         << " encountered none-supported BatchDataType_t: " << (int)(((BatchHolder*)(proc_ptr))->data_type()) << std::endl;
-        throw larbys();
+    for (size_t i_entry = first; i_entry < last; ++ i_entry){
+      auto & entry = _batch_index_v[i_entry];
+      LARCV_INFO() << "Processing entry: " << entry << std::endl;
+
+      const AugmentTransform * transform = nullptr;
+      if (_use_augmentation) {
+        _transform_v[i_entry] = _augmentation.draw(_augment_generator_v.at(worker));
+        transform = &_transform_v[i_entry];
       }
 
-      // check to make sure BatchData is ready to be filled
-      if (batch_state != BatchDataState_t::kBatchStateEmpty &&
-          batch_state != BatchDataState_t::kBatchStateUnknown &&
-          batch_state != BatchDataState_t::kBatchStateFilled ) {
-        LARCV_CRITICAL() << " cannot fill storage "
-                         << " because its state (" << (int)batch_state
-                         << ") is neither kBatchStateUnknown nor kBatchStateEmpty nor kBatchStateFilled!" << std::endl;
-        throw larbys();
+      // Tell the fillers where in the batch this entry goes, and how to augment it:
+      for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
+        auto proc_ptr = driver.process_ptr(pid);
+        if (!(proc_ptr->is("BatchFiller"))) continue;
+        ((BatchHolder*)(proc_ptr))->_batch_entry = i_entry;
+        ((BatchHolder*)(proc_ptr))->_transform = transform;
+      }
+
+      // bool good_status =
+      driver.process_entry(entry, true);
+      LARCV_INFO() << "Finished processing event id: " << driver.event_id().event_key() << std::endl;
+      _next_batch_entries_v.at(i_entry) = entry;
+      _next_batch_events_v.at(i_entry) = driver.event_id();
+    }
+  }
+
+  bool QueueProcessor::set_batch_storage(){
+
+    // Every driver's fillers point to the same BatchData in the queue:
+    std::vector<ProcessDriver*> driver_v(1, &_driver);
+    for (auto & driver : _worker_driver_v) driver_v.push_back(driver.get());
+
+    for (auto driver : driver_v) {
+      for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
+        auto proc_ptr = driver->process_ptr(pid);
+        if (!(proc_ptr->is("BatchFiller"))) continue;
+
+        auto const& name = _process_name_v[pid];
+        BatchDataState_t batch_state = BatchDataState_t::kBatchStateUnknown;
+        switch ( ((BatchHolder*)(proc_ptr))->data_type() ) {
+        case BatchDataType_t::kBatchDataShort:
+          ((BatchFillerTemplate<short>*)proc_ptr)->_batch_data_ptr
+            = &(BatchDataQueueFactory<short>::get_writeable().get_queue_writeable(name).get_next_writeable());
+          batch_state = ((BatchFillerTemplate<short>*)proc_ptr)->_batch_data_ptr->state();
+          break;
+        case BatchDataType_t::kBatchDataInt:
+          ((BatchFillerTemplate<int>*)proc_ptr)->_batch_data_ptr
+            = &(BatchDataQueueFactory<int>::get_writeable().get_queue_writeable(name).get_next_writeable());
+          batch_state = ((BatchFillerTemplate<int>*)proc_ptr)->_batch_data_ptr->state();
+          break;
+        case BatchDataType_t::kBatchDataFloat:
+          ((BatchFillerTemplate<float>*)proc_ptr)->_batch_data_ptr
+            = &(BatchDataQueueFactory<float>::get_writeable().get_queue_writeable(name).get_next_writeable());
+          batch_state = ((BatchFillerTemplate<float>*)proc_ptr)->_batch_data_ptr->state();
+          break;
+        case BatchDataType_t::kBatchDataDouble:
+          ((BatchFillerTemplate<double>*)proc_ptr)->_batch_data_ptr
+            = &(BatchDataQueueFactory<double>::get_writeable().get_queue_writeable(name).get_next_writeable());
+          batch_state = ((BatchFillerTemplate<double>*)proc_ptr)->_batch_data_ptr->state();
+          break;
+        default:
+          LARCV_CRITICAL() << "Process name " << name
+                           << " encountered none-supported BatchDataType_t: " << (int)(((BatchHolder*)(proc_ptr))->data_type()) << std::endl;
+          throw larbys();
+        }
+
+        // check to make sure BatchData is ready to be filled
+        if (batch_state != BatchDataState_t::kBatchStateEmpty &&
+            batch_state != BatchDataState_t::kBatchStateUnknown &&
+            batch_state != BatchDataState_t::kBatchStateFilled ) {
+          LARCV_CRITICAL() << " cannot fill storage "
+                           << " because its state (" << (int)batch_state
+                           << ") is neither kBatchStateUnknown nor kBatchStateEmpty nor kBatchStateFilled!" << std::endl;
+          throw larbys();
+        }
       }
     }
     return true;
@@ -479,7 +652,7 @@ int omp_thread_count() {
       auto ptr = _driver.process_ptr(id);
       if (!(ptr->is("BatchFiller"))) continue;
       LARCV_INFO() << "Executing " << process_name << "::batch_begin()" << std::endl;
-      ((BatchHolder*)(ptr))->_batch_size = _next_index_v.size();
+      ((BatchHolder*)(ptr))->_batch_size = _batch_index_v.size();
       switch ( ((BatchHolder*)(ptr))->data_type() ) {
       case BatchDataType_t::kBatchDataShort:
         ((BatchFillerTemplate<short>*)ptr)->batch_begin(); break;
@@ -494,6 +667,16 @@ int omp_thread_count() {
         throw larbys();
       }
     }
+
+    // Worker replicas share the primary's BatchData, which is already reset,
+    // so they only need the batch size:
+    for (auto & driver : _worker_driver_v) {
+      for (size_t pid = 0; pid < _process_name_v.size(); ++pid) {
+        auto ptr = driver->process_ptr(pid);
+        if (!(ptr->is("BatchFiller"))) continue;
+        ((BatchHolder*)(ptr))->_batch_size = _batch_index_v.size();
+      }
+    }
     return true;
   }
   bool QueueProcessor::end_batch(){
@@ -504,13 +687,21 @@ int omp_thread_count() {
 
       switch ( ((BatchHolder*)(ptr))->data_type() ) {
       case BatchDataType_t::kBatchDataShort:
-        ((BatchFillerTemplate<short>*)ptr)->batch_end(); break;
+        ((BatchFillerTemplate<short>*)ptr)->batch_end();
+        BatchDataQueueFactory<short>::get_writeable().get_queue_writeable(process_name).push();
+        break;
       case BatchDataType_t::kBatchDataInt:
-        ((BatchFillerTemplate<int>*)ptr)->batch_end(); break;
+        ((BatchFillerTemplate<int>*)ptr)->batch_end();
+        BatchDataQueueFactory<int>::get_writeable().get_queue_writeable(process_name).push();
+        break;
       case BatchDataType_t::kBatchDataFloat:
-        ((BatchFillerTemplate<float>*)ptr)->batch_end(); break;
+        ((BatchFillerTemplate<float>*)ptr)->batch_end();
+        BatchDataQueueFactory<float>::get_writeable().get_queue_writeable(process_name).push();
+        break;
       case BatchDataType_t::kBatchDataDouble:
-        ((BatchFillerTemplate<double>*)ptr)->batch_end(); break;
+        ((BatchFillerTemplate<double>*)ptr)->batch_end();
+        BatchDataQueueFactory<double>::get_writeable().get_queue_writeable(process_name).push();
+        break;
       default:
         LARCV_CRITICAL() << " encountered none-supported BatchDataType_t: " << (int)(((BatchHolder*)(ptr))->data_type()) << std::endl;
         throw larbys();
@@ -533,19 +724,25 @@ void init_queueprocessor(pybind11::module m){
   queueproc.def(pybind11::init<std::string>(),
     pybind11::arg("name") = "QueueProcessor");
 
-  queueproc.def("batch_process",          &Class::batch_process);
-  queueproc.def("prepare_next",     &Class::prepare_next);
-  queueproc.def("reset",     &Class::reset);
+  // These can read files or wait on the worker threads, so they run without the GIL.
+  // The set_next_batch overload taking a numpy array keeps it.
+  queueproc.def("batch_process",          &Class::batch_process, larcv3::release_gil());
+  queueproc.def("prepare_next",     &Class::prepare_next, larcv3::release_gil());
+  queueproc.def("reset",     &Class::reset, larcv3::release_gil());
   queueproc.def("configure",
     (void (Class::*)(const std::string, int)) (&Class::configure),
     pybind11::arg("config_file"),
-    pybind11::arg("color")=0);
+    pybind11::arg("color")=0,
+    larcv3::release_gil());
   queueproc.def("configure",
     (void (Class::*)(const larcv3::PSet&, int)) (&Class::configure),
     pybind11::arg("cfg"),
-    pybind11::arg("color")=0);
+    pybind11::arg("color")=0,
+    larcv3::release_gil());
   queueproc.def("configured",         &Class::configured);
-  queueproc.def("pop_current_data",         &Class::pop_current_data);
+  queueproc.def("pop_current_data",         &Class::pop_current_data,
+    pybind11::arg("blocking")=true,
+    larcv3::release_gil());
   queueproc.def("set_next_index",         &Class::set_next_index);
   queueproc.def("set_next_batch",
     (void (Class::*)(const std::vector<size_t>&)) (&Class::set_next_batch));
@@ -557,11 +754,27 @@ void init_queueprocessor(pybind11::module m){
   queueproc.def("get_n_entries",         &Class::get_n_entries);
   queueproc.def("processed_entries",         &Class::processed_entries);
   queueproc.def("processed_events",         &Class::processed_events);
-  queueproc.def("pd",         &Class::pd);
+  queueproc.def("pd",         &Class::pd,
+    pybind11::return_value_policy::reference_internal);
   queueproc.def("storage_name",         &Class::storage_name);
   queueproc.def("process_id",         &Class::process_id);
   queueproc.def("batch_fillers",         &Class::batch_fillers);
   queueproc.def("batch_types",         &Class::batch_types);
+  queueproc.def("num_workers",         &Class::num_workers);
+  queueproc.def("queue_depth",         &Class::queue_depth);
+  queueproc.def("n_pending",           &Class::n_pending);
+  queueproc.def("has_sampler",         &Class::has_sampler);
+  queueproc.def("sampler",             &Class::sampler,
+    pybind11::return_value_policy::reference_internal);
+  queueproc.def("set_sampler_epoch",   &Class::set_sampler_epoch);
+  queueproc.def("has_shard_sampler",   &Class::has_shard_sampler);
+  queueproc.def("shard_sampler",       &Class::shard_sampler,
+    pybind11::return_value_policy::reference_internal);
+  queueproc.def("set_shard",           &Class::set_shard,
+    pybind11::arg("shard"), pybind11::arg("n_shards"), pybind11::arg("batch_size")=0);
+  queueproc.def("has_augmentation",    &Class::has_augmentation);
+  queueproc.def("augmentation",        &Class::augmentation,
+    pybind11::return_value_policy::reference_internal);
 
 
 }
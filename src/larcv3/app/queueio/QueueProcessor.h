@@ -16,8 +16,13 @@
 
 #include "larcv3/core/processor/ProcessDriver.h"
 #include "QueueIOTypes.h"
+#include "BatchSampler.h"
+#include "Augmentation.h"
 #include <random>
 #include <future>
+#include <memory>
+#include <deque>
+#include <mutex>
 
 
 #ifdef LARCV_INTERNAL
@@ -41,11 +46,14 @@ namespace larcv3 {
     /// Default destructor
     ~QueueProcessor();
 
-    // Process a batch of entries, using _next_index_v to specify entries
+    // Process a batch of entries, using _next_index_v to specify entries, and wait for it
     bool batch_process();
 
-    // Spawn a thread to batch process and return immediately
-    void prepare_next();
+    // Spawn a thread to batch process _next_index_v (or, with a Sampler or ShardSampler
+    // configured, the sampler's next batch) and return immediately.
+    // Up to QueueDepth batches can be prepared ahead of the current one; returns
+    // false if that many are already pending.
+    bool prepare_next();
 
     // Reset the state
     void reset();
@@ -59,8 +67,9 @@ namespace larcv3 {
     // Check if the processor is configured
     inline bool configured() const { return _configured;}
 
-    // Go through all factories and pop the data
-    void pop_current_data();
+    // Go through all factories and pop the data, making the oldest prepared batch current.
+    // If blocking, waits for that batch to finish, otherwise returns false if it is not ready.
+    bool pop_current_data(bool blocking=true);
 
     // Set the next index to read/
     // This will just set the index_v object
@@ -78,8 +87,14 @@ namespace larcv3 {
 #endif
 
 
-    // Return true only if the fillers are preparing the next batch
-    bool is_reading() const {return _processing;}
+    // Return true only if the fillers are preparing a batch
+    bool is_reading() const;
+
+    // Number of batches prepared or being prepared, but not yet popped
+    inline size_t n_pending() const { return _preparation_future_v.size(); }
+
+    // Number of batches that can be prepared ahead of the current one (QueueDepth)
+    inline size_t queue_depth() const { return _queue_depth; }
 
     // Get number of entries possible to read
     size_t get_n_entries() const;
@@ -103,15 +118,54 @@ namespace larcv3 {
     inline const std::vector<larcv3::BatchDataType_t>& batch_types() const
     { return _batch_data_type_v; }
 
+    // Number of ProcessDrivers filling each batch (NumWorkers)
+    inline size_t num_workers() const { return _num_workers; }
+
+    // True if a Sampler or ShardSampler chooses the entries of each batch, instead of set_next_batch
+    inline bool has_sampler() const { return _use_sampler || _use_shard_sampler; }
+    inline bool has_shard_sampler() const { return _use_shard_sampler; }
+
+    inline const BatchSampler& sampler() const { return _sampler; }
+    inline const ShardSampler& shard_sampler() const { return _shard_sampler; }
+
+    // Restart the sampler from the first batch of an epoch.  Batches already
+    // prepared ahead are not affected.
+    void set_sampler_epoch(size_t epoch);
+
+    // Select this rank's shard for the ShardSampler, and its batch size (0 keeps the configured one)
+    void set_shard(size_t shard, size_t n_shards, size_t batch_size = 0);
+
+    // True if an Augment block draws one transform per entry for all the fillers
+    inline bool has_augmentation() const { return _use_augmentation; }
+    inline const Augmentation& augmentation() const { return _augmentation; }
+
   private:
 
     bool set_batch_storage();
     bool begin_batch();
     bool end_batch();
 
+    // Fill the next slot of every queue with the entries in index_v
+    bool process_batch(const std::vector<size_t>& index_v);
+
+    // Process entries [first, last) of _batch_index_v with one driver, the worker-th
+    void process_entries(ProcessDriver & driver, size_t worker, size_t first, size_t last);
+
     bool _processing;
     bool _configured;
     std::vector<size_t> _next_index_v;
+    // Optional samplers, which replace _next_index_v
+    bool _use_sampler;
+    BatchSampler _sampler;
+    bool _use_shard_sampler;
+    ShardSampler _shard_sampler;
+    // Optional augmentation, drawn for each entry from the generator of its worker
+    bool _use_augmentation;
+    Augmentation _augmentation;
+    std::vector<std::mt19937_64> _augment_generator_v;
+    std::vector<AugmentTransform> _transform_v;
+    // Entries of the batch being processed
+    std::vector<size_t> _batch_index_v;
 
     std::vector<std::string> _input_fname_v;
     size_t _batch_global_counter;
@@ -121,9 +175,13 @@ namespace larcv3 {
     std::vector<larcv3::BatchDataType_t> _batch_data_type_v;
 
     // Each QueueProcessor gets one process driver object.
-    // We assume that the batch_process call can be parallelized with OpenMP
     larcv3::ProcessDriver _driver;
 
+    // With NumWorkers > 1, additional replicas of _driver (each with its own IOManager
+    // and open files) fill disjoint slices of the same batch in parallel.
+    size_t _num_workers;
+    std::vector<std::unique_ptr<larcv3::ProcessDriver> > _worker_driver_v;
+
     // List of processes for fillers:
     std::vector<std::string> _process_name_v;
 
@@ -133,7 +191,15 @@ namespace larcv3 {
     std::vector<size_t> _next_batch_entries_v;
     std::vector<larcv3::EventID> _next_batch_events_v;
 
-    std::future<bool> _preparation_future;
+    // Meta data of batches that are prepared but not yet popped, oldest first
+    std::deque<std::vector<size_t> > _prepared_entries_v;
+    std::deque<std::vector<larcv3::EventID> > _prepared_events_v;
+    std::mutex _prepared_mutex;
+
+    // One future per pending batch, oldest first.  Each preparation waits
+    // for the one before it, since they share the drivers.
+    size_t _queue_depth;
+    std::deque<std::shared_future<bool> > _preparation_future_v;
 
   };
 
@@ -30,5 +30,7 @@ void init_queueio(pybind11::module m){
   init_batchdata(m);
   init_batchdataqueue(m);
   init_batchdataqueuefactory(m);
+  init_batchsampler(m);
+  init_augmentation(m);
   init_queueprocessor(m);
 }
@@ -21,6 +21,8 @@
 #include "BatchDataQueueFactory.h"
 #include "QueueIOTypes.h"
 #include "QueueProcessor.h"
+#include "BatchSampler.h"
+#include "Augmentation.h"
 
 #ifndef LARCV_NO_PYBIND
 #ifdef LARCV_INTERNAL
@@ -0,0 +1,143 @@
+/**
+ * \file StridedCopy.h
+ *
+ * \ingroup core_Base
+ *
+ * \brief Cache-blocked copy of N-D arrays between strided layouts
+ *
+ * @author cadams
+ */
+
+/** \addtogroup core_Base
+
+    @{*/
+
+#ifndef __LARCV3BASE_STRIDEDCOPY_H__
+#define __LARCV3BASE_STRIDEDCOPY_H__
+
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+
+namespace larcv3 {
+
+  /**
+     \brief Copies an N-D array from one strided layout to another, for example to
+     transpose it, or to interleave several arrays as the channels of one.
+
+     Element (i_0, ..., i_n-1) of channel c is read at inputs[c] + sum_k i_k * input_strides[k]
+     and written at output + c * channel_stride + sum_k i_k * output_strides[k], with
+     strides in elements (negative ones are fine).  The innermost loop runs along the
+     axis with the smallest output stride, so writes are sequential.  When the smallest
+     input stride is on another axis, those two axes are copied in tile x tile blocks
+     that stay in cache between the strided reads; otherwise the axis is copied in
+     blocks of tile * tile elements, all channels at a time.
+  */
+  template <class T>
+  void strided_copy(const std::vector<const T*>& inputs,
+                    const std::vector<std::ptrdiff_t>& input_strides,
+                    T* output,
+                    const std::vector<std::ptrdiff_t>& output_strides,
+                    std::ptrdiff_t channel_stride,
+                    const std::vector<size_t>& shape,
+                    size_t tile = 32)
+  {
+    const size_t n_dims = shape.size();
+    const size_t n_channels = inputs.size();
+    if (!n_channels) return;
+    for (auto const& extent : shape) if (!extent) return;
+    if (!n_dims) {
+      for (size_t c = 0; c < n_channels; ++c) output[c * channel_stride] = *inputs[c];
+      return;
+    }
+
+    // The axes with the smallest output and input strides are the inner loops:
+    size_t out_axis = 0, in_axis = 0;
+    for (size_t axis = 1; axis < n_dims; ++axis) {
+      if (std::labs(output_strides[axis]) < std::labs(output_strides[out_axis])) out_axis = axis;
+      if (std::labs(input_strides[axis])  < std::labs(input_strides[in_axis]))   in_axis  = axis;
+    }
+    if (std::labs(input_strides[out_axis]) == std::labs(input_strides[in_axis])) in_axis = out_axis;
+
+    std::vector<size_t> outer_axes;
+    for (size_t axis = 0; axis < n_dims; ++axis)
+      if (axis != out_axis && axis != in_axis) outer_axes.push_back(axis);
+
+    const size_t n_out = shape[out_axis], n_in = shape[in_axis];
+    const std::ptrdiff_t read_j  = input_strides[out_axis], write_j = output_strides[out_axis];
+    const std::ptrdiff_t read_i  = input_strides[in_axis],  write_i = output_strides[in_axis];
+    const size_t block = std::max(tile, size_t(1));
+
+    // Walk the outer axes as an odometer, keeping the offsets of the current position:
+    std::vector<size_t> index(outer_axes.size(), 0);
+    std::ptrdiff_t in_offset = 0, out_offset = 0;
+    while (true) {
+
+      if (in_axis == out_axis) {
+        for (size_t j0 = 0; j0 < n_out; j0 += block * block) {
+          size_t j1 = std::min(j0 + block * block, n_out);
+          for (size_t c = 0; c < n_channels; ++c) {
+            const T* in = inputs[c] + in_offset;
+            T* out = output + c * channel_stride + out_offset;
+            for (size_t j = j0; j < j1; ++j) out[j * write_j] = in[j * read_j];
+          }
+        }
+      }
+      else {
+        for (size_t i0 = 0; i0 < n_in; i0 += block) {
+          size_t i1 = std::min(i0 + block, n_in);
+          for (size_t j0 = 0; j0 < n_out; j0 += block) {
+            size_t j1 = std::min(j0 + block, n_out);
+            for (size_t c = 0; c < n_channels; ++c) {
+              const T* in = inputs[c] + in_offset;
+              T* out = output + c * channel_stride + out_offset;
+              for (size_t i = i0; i < i1; ++i)
+                for (size_t j = j0; j < j1; ++j)
+                  out[i * write_i + j * write_j] = in[i * read_i + j * read_j];
+            }
+          }
+        }
+      }
+
+      // Next position of the outer axes:
+      size_t k = 0;
+      for (; k < outer_axes.size(); ++k) {
+        size_t axis = outer_axes[k];
+        in_offset  += input_strides[axis];
+        out_offset += output_strides[axis];
+        if (++index[k] < shape[axis]) break;
+        in_offset  -= input_strides[axis]  * std::ptrdiff_t(shape[axis]);
+        out_offset -= output_strides[axis] * std::ptrdiff_t(shape[axis]);
+        index[k] = 0;
+      }
+      if (k == outer_axes.size()) break;
+    }
+  }
+
+  /// Single input version of strided_copy
+  template <class T>
+  void strided_copy(const T* input, const std::vector<std::ptrdiff_t>& input_strides,
+                    T* output, const std::vector<std::ptrdiff_t>& output_strides,
+                    const std::vector<size_t>& shape, size_t tile = 32)
+  {
+    strided_copy(std::vector<const T*>(1, input), input_strides, output, output_strides, 0, shape, tile);
+  }
+
+  /// Strides, in elements, of a C-ordered (last axis fastest) array of this shape
+  inline std::vector<std::ptrdiff_t> row_major_strides(const std::vector<size_t>& shape,
+                                                       std::ptrdiff_t element_stride = 1)
+  {
+    std::vector<std::ptrdiff_t> strides(shape.size());
+    std::ptrdiff_t stride = element_stride;
+    for (size_t k = shape.size(); k > 0; --k) {
+      strides[k - 1] = stride;
+      stride *= shape[k - 1];
+    }
+    return strides;
+  }
+
+}
+
+#endif
+/** @} */ // end of doxygen group
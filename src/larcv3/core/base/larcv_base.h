@@ -60,6 +60,11 @@ namespace larcv3 {
 
 #ifdef LARCV_INTERNAL
 #include <pybind11/pybind11.h>
+namespace larcv3 {
+  /// Call guard for bindings that do I/O or O(n) work without touching python objects.
+  /// The GIL is dropped for the C++ call and re-acquired before the result is cast.
+  typedef pybind11::call_guard<pybind11::gil_scoped_release> release_gil;
+}
 void init_larcv_base(pybind11::module m);
 #endif
 
@@ -132,6 +132,12 @@ void init_dataformattypes(pybind11::module m){
   pooltype_t.value("kPoolAverage",  larcv3::PoolType_t::kPoolAverage);
   pooltype_t.value("kPoolMax",      larcv3::PoolType_t::kPoolMax);
   pooltype_t.export_values();
+
+  pybind11::enum_<larcv3::VoxelEncoding_t> voxelencoding_t(m,"VoxelEncoding_t");
+  voxelencoding_t.value("kVoxelLegacy",  larcv3::VoxelEncoding_t::kVoxelLegacy);
+  voxelencoding_t.value("kVoxelIndex32", larcv3::VoxelEncoding_t::kVoxelIndex32);
+  voxelencoding_t.value("kVoxelDelta32", larcv3::VoxelEncoding_t::kVoxelDelta32);
+  voxelencoding_t.export_values();
   // struct Extents_t{
   //   unsigned long long int first;
   //   unsigned int n;
@@ -73,6 +73,13 @@ namespace larcv3 {
     kPoolMax      ///< max channel
   };
 
+  /// On-disk encoding of the voxels of sparse products
+  enum VoxelEncoding_t : int {
+    kVoxelLegacy,  ///< one table of (id, value) structs
+    kVoxelIndex32, ///< separate 32 bit id and float value columns
+    kVoxelDelta32  ///< as kVoxelIndex32, but each id is stored as the difference to the previous id of its set
+  };
+
   /// Object appearance type in LArTPC
   enum ShapeType_t : int {
     kShapeShower,  ///< Shower
@@ -2,21 +2,524 @@
 #define __LARCV_EVENTBASE_CXX
 
 #include "EventBase.h"
+#include "larcv3/core/base/larbys.h"
+#include "larcv3/core/dataformat/Voxel.h"
+#include <algorithm>
 // #include <sstream>
 // #include <iomanip>
 
 namespace larcv3{
+
+    // The bytes of a row of type that go to the file: the members of a compound
+    // type, without the padding between them
+    static std::string stored_bytes(hid_t type, const char * row){
+        if (H5Tget_class(type) != H5T_COMPOUND) return std::string(row, H5Tget_size(type));
+        std::string bytes;
+        for (int k = 0; k < H5Tget_nmembers(type); k ++){
+            hid_t member_type = H5Tget_member_type(type, k);
+            bytes.append(row + H5Tget_member_offset(type, k), H5Tget_size(member_type));
+            H5Tclose(member_type);
+        }
+        return bytes;
+    }
+
+    // Rows [first, first + n_rows) of a preloaded table of size rows must all exist:
+    // a corrupt extents row would otherwise read past the end of the table
+    static void check_preloaded_rows(const char * table, hsize_t first, hsize_t n_rows, size_t size){
+        if (first > size || n_rows > size - first){
+            LARCV_SCRITICAL() << "Rows " << first << " to " << first + n_rows << " of the preloaded "
+                              << table << " are past its end (" << size << " rows)" << std::endl;
+            throw larbys();
+        }
+    }
+
     EventBase::~EventBase(){
         // for (auto & p : _data_types){
         //     delete p;
         // }
     }
 
+    void EventBase::select_in_group(hid_t group){
+        if (group == _in_group) return;
+
+        if (_in_group >= 0 && !_open_in_datasets.empty()){
+            auto & parked = _in_handles_m[_in_group];
+            parked.datasets.swap(_open_in_datasets);
+            parked.dataspaces.swap(_open_in_dataspaces);
+            parked.voxel_encoding = _in_voxel_encoding;
+            std::swap(parked.index, _in_index_tables);
+        }
+        _open_in_datasets.clear();
+        _open_in_dataspaces.clear();
+        _in_index_tables = H5InputIndex();
+
+        auto iter = _in_handles_m.find(group);
+        if (iter != _in_handles_m.end()){
+            _open_in_datasets.swap(iter->second.datasets);
+            _open_in_dataspaces.swap(iter->second.dataspaces);
+            _in_voxel_encoding = iter->second.voxel_encoding;
+            std::swap(_in_index_tables, iter->second.index);
+            _in_handles_m.erase(iter);
+        }
+        _in_group = group;
+    }
+
+    void EventBase::close_in_group(hid_t group){
+        // Datasets a product leaves unopened have a negative id, and no dataspace
+        auto close = [](std::vector<hid_t> & datasets, std::vector<hid_t> & dataspaces){
+            for (size_t i = 0; i < datasets.size(); i ++){
+                if (datasets[i] < 0) continue;
+                H5Sclose(dataspaces[i]);
+                H5Dclose(datasets[i]);
+            }
+            datasets.clear();
+            dataspaces.clear();
+        };
+
+        if (group == _in_group){
+            close(_open_in_datasets, _open_in_dataspaces);
+            _in_index_tables = H5InputIndex();
+            _in_group = H5I_INVALID_HID;
+            return;
+        }
+        auto iter = _in_handles_m.find(group);
+        if (iter != _in_handles_m.end()){
+            close(iter->second.datasets, iter->second.dataspaces);
+            _in_handles_m.erase(iter);
+        }
+    }
+
+    void EventBase::deserialize_range(hid_t group, size_t first,
+                                      std::vector<std::shared_ptr<EventBase> > & products){
+        open_in_datasets(group);
+        for (size_t i = 0; i < products.size(); i ++){
+            // Lend the open datasets and the loaded index, so the product doesn't open its own:
+            auto & product = *products[i];
+            product.clear();
+            product._open_in_datasets   = _open_in_datasets;
+            product._open_in_dataspaces = _open_in_dataspaces;
+            product._in_group           = group;
+            product._in_voxel_encoding  = _in_voxel_encoding;
+            std::swap(product._in_index_tables, _in_index_tables);
+            product.deserialize(group, first + i, false);
+            std::swap(product._in_index_tables, _in_index_tables);
+            product._open_in_datasets.clear();
+            product._open_in_dataspaces.clear();
+            product._in_group = H5I_INVALID_HID;
+        }
+    }
+
+    void EventBase::read_in_rows(size_t i, hsize_t first, hsize_t n_rows, void * rows){
+        if (!n_rows) return;
+        hsize_t offset[1] = {first};
+        hsize_t count[1]  = {n_rows};
+        H5Sselect_hyperslab(_open_in_dataspaces[i], H5S_SELECT_SET, offset, NULL, count, NULL);
+        hid_t memspace = H5Screate_simple(1, count, NULL);
+        H5Dread(_open_in_datasets[i], _data_types[i], memspace, _open_in_dataspaces[i], H5P_DEFAULT, rows);
+        H5Sclose(memspace);
+    }
+
+    void EventBase::load_in_index(size_t i_extents, int i_sets, int i_index){
+        _in_index_tables = H5InputIndex();
+        if (!_storage.preload_index_bytes) return;
+        if (i_index >= 0 && _open_in_datasets[i_index] < 0) i_index = -1;
+
+        hsize_t n_extents = 0, n_sets = 0, n_index = 0;
+        H5Sget_simple_extent_dims(_open_in_dataspaces[i_extents], &n_extents, NULL);
+        if (i_sets >= 0) H5Sget_simple_extent_dims(_open_in_dataspaces[i_sets], &n_sets, NULL);
+        if (i_index >= 0) H5Sget_simple_extent_dims(_open_in_dataspaces[i_index], &n_index, NULL);
+
+        size_t bytes = n_extents * sizeof(Extents_t) + n_sets * sizeof(IDExtents_t) + n_index * sizeof(unsigned int);
+        if (bytes > _storage.preload_index_bytes){
+            LARCV_SINFO() << "Index of " << n_extents << " entries takes " << bytes << " bytes, over the "
+                          << _storage.preload_index_bytes << " allowed: reading it per entry" << std::endl;
+            return;
+        }
+        _in_index_tables.extents.resize(n_extents);
+        read_in_rows(i_extents, 0, n_extents, _in_index_tables.extents.data());
+        if (i_sets >= 0){
+            _in_index_tables.set_extents.resize(n_sets);
+            read_in_rows(i_sets, 0, n_sets, _in_index_tables.set_extents.data());
+        }
+        if (i_index >= 0){
+            _in_index_tables.dictionary_index.resize(n_index);
+            read_in_rows(i_index, 0, n_index, _in_index_tables.dictionary_index.data());
+        }
+        _in_index_tables.loaded = true;
+        LARCV_SINFO() << "Preloaded the index of " << n_extents << " entries, " << bytes << " bytes" << std::endl;
+    }
+
+    void EventBase::read_in_extents(size_t i, hsize_t first, hsize_t n_rows, Extents_t * rows){
+        if (!_in_index_tables.loaded) return read_in_rows(i, first, n_rows, rows);
+        check_preloaded_rows("extents", first, n_rows, _in_index_tables.extents.size());
+        auto begin = _in_index_tables.extents.begin() + first;
+        std::copy(begin, begin + n_rows, rows);
+    }
+
+    void EventBase::read_in_set_extents(size_t i, hsize_t first, hsize_t n_rows, IDExtents_t * rows){
+        if (!_in_index_tables.loaded) return read_in_rows(i, first, n_rows, rows);
+        check_preloaded_rows("set extents", first, n_rows, _in_index_tables.set_extents.size());
+        auto begin = _in_index_tables.set_extents.begin() + first;
+        std::copy(begin, begin + n_rows, rows);
+    }
+
+    void EventBase::load_in_dictionary(size_t i, size_t i_index){
+        if (_open_in_datasets[i_index] < 0) return;
+        hsize_t n_rows = 0;
+        H5Sget_simple_extent_dims(_open_in_dataspaces[i], &n_rows, NULL);
+        _in_index_tables.dictionary.resize(n_rows * H5Tget_size(_data_types[i]));
+        read_in_rows(i, 0, n_rows, _in_index_tables.dictionary.data());
+    }
+
+    void EventBase::read_in_dictionary_rows(size_t i, size_t i_index, hsize_t first, hsize_t n_rows, void * rows){
+        if (_open_in_datasets[i_index] < 0) return read_in_rows(i, first, n_rows, rows);
+
+        std::vector<unsigned int> index;
+        const unsigned int * begin = NULL;
+        if (_in_index_tables.loaded){
+            check_preloaded_rows("dictionary index", first, n_rows, _in_index_tables.dictionary_index.size());
+            begin = _in_index_tables.dictionary_index.data() + first;
+        }
+        else{
+            index.resize(n_rows);
+            read_in_rows(i_index, first, n_rows, index.data());
+            begin = index.data();
+        }
+
+        size_t row_bytes = H5Tget_size(_data_types[i]);
+        size_t n_dictionary = _in_index_tables.dictionary.size() / row_bytes;
+        char * out = static_cast<char *>(rows);
+        for (hsize_t k = 0; k < n_rows; k ++){
+            if (begin[k] >= n_dictionary){
+                LARCV_SCRITICAL() << "Dictionary row " << begin[k] << " of row " << first + k
+                                  << " is past the end of the dictionary (" << n_dictionary << " rows)" << std::endl;
+                throw larbys();
+            }
+            std::copy_n(_in_index_tables.dictionary.data() + begin[k] * row_bytes, row_bytes, out + k * row_bytes);
+        }
+    }
+
+    size_t EventBase::in_index_bytes() const{
+        size_t bytes = _in_index_tables.bytes();
+        for (auto const & handles : _in_handles_m) bytes += handles.second.index.bytes();
+        return bytes;
+    }
+
     int EventBase::get_num_objects(hid_t group){
         hsize_t  num_objects[1] = {0};
         H5Gget_num_objs(group, num_objects);
         return num_objects[0];
     }
+
+    hsize_t EventBase::data_chunk_size(hsize_t default_size) const{
+        return _storage.data_chunk_size ? _storage.data_chunk_size : default_size;
+    }
+
+    hsize_t EventBase::index_chunk_size(hsize_t default_size) const{
+        return _storage.index_chunk_size ? _storage.index_chunk_size : default_size;
+    }
+
+    hsize_t EventBase::auto_chunk_size(size_t elements_per_event, size_t element_bytes){
+        // Aim for about one event per chunk, so random access decompresses little
+        // beyond what it reads, but keep chunks between 64kB and 512kB: small chunks
+        // bloat the chunk index, and two large ones still fit HDF5's default 1MB cache.
+        const size_t min_bytes = 64*1024;
+        const size_t max_bytes = 512*1024;
+        size_t bytes = std::min(std::max(elements_per_event * element_bytes, min_bytes), max_bytes);
+        return std::max(bytes / element_bytes, size_t(1));
+    }
+
+    hid_t EventBase::dataset_access_plist() const{
+        hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS);
+        if (_storage.chunk_cache_bytes || _storage.chunk_cache_slots || _storage.chunk_cache_w0 >= 0){
+            H5Pset_chunk_cache(dapl,
+                _storage.chunk_cache_slots ? _storage.chunk_cache_slots : H5D_CHUNK_CACHE_NSLOTS_DEFAULT,
+                _storage.chunk_cache_bytes ? _storage.chunk_cache_bytes : H5D_CHUNK_CACHE_NBYTES_DEFAULT,
+                _storage.chunk_cache_w0 >= 0 ? _storage.chunk_cache_w0 : H5D_CHUNK_CACHE_W0_DEFAULT);
+        }
+        return dapl;
+    }
+
+    void EventBase::create_chunked_dataset(hid_t group, const char * name, hid_t type, hsize_t chunk_size,
+                                           uint compression, bool shuffle) const{
+        hsize_t starting_dim[] = {0};
+        hsize_t maxsize_dim[]  = {H5S_UNLIMITED};
+        hid_t dataspace = H5Screate_simple(1, starting_dim, maxsize_dim);
+
+        hid_t cparms = H5Pcreate( H5P_DATASET_CREATE );
+        hsize_t chunk_dims[1] = {chunk_size};
+        H5Pset_chunk(cparms, 1, chunk_dims);
+        // Filters run in the order they are added, so shuffle goes first:
+        if (shuffle) H5Pset_shuffle(cparms);
+        if (compression) H5Pset_deflate(cparms, compression);
+
+        hid_t dataset = H5Dcreate(group, name, type, dataspace, H5P_DEFAULT, cparms, H5P_DEFAULT);
+
+        H5Dclose(dataset);
+        H5Sclose(dataspace);
+        H5Pclose(cparms);
+    }
+
+    void EventBase::open_in_voxels_datasets(hid_t group, const VoxelDatasets & datasets, hid_t dapl){
+        // The encoding of the voxels is recognized from the datasets in the file:
+        _in_voxel_encoding = kVoxelLegacy;
+        for (auto encoding : {kVoxelIndex32, kVoxelDelta32})
+            if (H5Lexists(group, Voxel::dataset_name(encoding), H5P_DEFAULT) > 0) _in_voxel_encoding = encoding;
+
+        _open_in_datasets[datasets.voxels]    = H5I_INVALID_HID;
+        _open_in_datasets[datasets.ids]       = H5I_INVALID_HID;
+        _open_in_datasets[datasets.values]    = H5I_INVALID_HID;
+        if (_in_voxel_encoding == kVoxelLegacy){
+            _open_in_datasets[datasets.voxels]    = H5Dopen(group, "voxels", dapl);
+            _open_in_dataspaces[datasets.voxels]  = H5Dget_space(_open_in_datasets[datasets.voxels]);
+        }
+        else{
+            _open_in_datasets[datasets.ids]       = H5Dopen(group, Voxel::dataset_name(_in_voxel_encoding), dapl);
+            _open_in_dataspaces[datasets.ids]     = H5Dget_space(_open_in_datasets[datasets.ids]);
+            _open_in_datasets[datasets.values]    = H5Dopen(group, "voxel_values", dapl);
+            _open_in_dataspaces[datasets.values]  = H5Dget_space(_open_in_datasets[datasets.values]);
+        }
+    }
+
+    void EventBase::open_out_voxels_datasets(hid_t group, const VoxelDatasets & datasets){
+        // Only the datasets of the configured encoding exist, once they are created:
+        VoxelEncoding_t encoding = _storage.voxel_encoding;
+        _open_out_datasets[datasets.voxels]   = H5I_INVALID_HID;
+        _open_out_datasets[datasets.ids]      = H5I_INVALID_HID;
+        _open_out_datasets[datasets.values]   = H5I_INVALID_HID;
+        if (H5Lexists(group, Voxel::dataset_name(encoding), H5P_DEFAULT) <= 0) return;
+
+        if (encoding == kVoxelLegacy){
+            _open_out_datasets[datasets.voxels]   = H5Dopen(group, "voxels", H5P_DEFAULT);
+            _open_out_dataspaces[datasets.voxels] = H5Dget_space(_open_out_datasets[datasets.voxels]);
+        }
+        else{
+            _open_out_datasets[datasets.ids]      = H5Dopen(group, Voxel::dataset_name(encoding), H5P_DEFAULT);
+            _open_out_dataspaces[datasets.ids]    = H5Dget_space(_open_out_datasets[datasets.ids]);
+            _open_out_datasets[datasets.values]   = H5Dopen(group, "voxel_values", H5P_DEFAULT);
+            _open_out_dataspaces[datasets.values] = H5Dget_space(_open_out_datasets[datasets.values]);
+        }
+    }
+
+    void EventBase::create_voxels_datasets(hid_t group, const VoxelDatasets & datasets, hsize_t chunk_size,
+                                           uint compression) const{
+        VoxelEncoding_t encoding = _storage.voxel_encoding;
+
+        if (encoding == kVoxelLegacy){
+            create_chunked_dataset(group, "voxels", _data_types[datasets.voxels], chunk_size, compression);
+            return;
+        }
+
+        // The compact encodings split ids and values into two columns.  The high
+        // bytes of 32 bit ids (and even more so of id differences) are nearly
+        // constant, so shuffling them together before deflate pays off:
+        create_chunked_dataset(group, Voxel::dataset_name(encoding),
+            _data_types[datasets.ids], chunk_size, compression, true);
+        create_chunked_dataset(group, "voxel_values",
+            _data_types[datasets.values], chunk_size, compression, true);
+    }
+
+    void EventBase::prepare_voxels_flush(const VoxelDatasets & datasets, size_t i_extents, uint compression,
+                                         bool final){
+        if (_out_voxels_group < 0) return;
+        // Flushes after every entry (or a small buffer) leave too few entries to average,
+        // the voxels stay buffered until there are enough or nothing can wait:
+        hsize_t n_entries = out_size(i_extents);
+        if (!final && n_entries < auto_chunk_sample_entries) return;
+        n_entries = std::max(n_entries, hsize_t(1));
+
+        size_t voxels_dataset = _storage.voxel_encoding == kVoxelLegacy ? datasets.voxels : datasets.ids;
+        // Every voxel since the group was created is still buffered:
+        hsize_t n_voxels  = out_size(voxels_dataset);
+        create_voxels_datasets(_out_voxels_group, datasets,
+            auto_chunk_size(n_voxels / n_entries, H5Tget_size(_data_types[voxels_dataset])), compression);
+        open_out_voxels_datasets(_out_voxels_group, datasets);
+        _out_voxels_group = H5I_INVALID_HID;
+    }
+
+    void EventBase::read_voxels(const VoxelDatasets & datasets, const std::vector<IDExtents_t> & voxel_extents,
+                                hid_t xfer_plist_id, std::vector<larcv3::Voxel> & voxels){
+        // The voxel sets of voxel_extents are contiguous on disk, so this is one
+        // hyperslab read per column, whatever the encoding:
+        hsize_t voxels_slab_dims[1];
+        voxels_slab_dims[0] = 0;
+        for (auto & extents : voxel_extents) voxels_slab_dims[0] += extents.n;
+
+        if (voxels_slab_dims[0] == 0) return;
+
+        hsize_t voxels_offset[1];
+        voxels_offset[0] = voxel_extents.front().first;
+
+        hid_t voxels_memspace = H5Screate_simple(1, voxels_slab_dims, NULL);
+
+        if (_in_voxel_encoding == kVoxelLegacy){
+
+            H5Sselect_hyperslab(_open_in_dataspaces[datasets.voxels],
+                H5S_SELECT_SET,
+                voxels_offset,    // start
+                NULL ,            // stride
+                voxels_slab_dims, // count
+                NULL              // block
+            );
+
+            voxels.resize(voxels_slab_dims[0]);
+
+            H5Dread(
+                _open_in_datasets[datasets.voxels],   // hid_t dataset_id  IN: Identifier of the dataset read from.
+                _data_types[datasets.voxels],         // hid_t mem_type_id IN: Identifier of the memory datatype.
+                voxels_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
+                _open_in_dataspaces[datasets.voxels], // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
+                xfer_plist_id,                        // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
+                &(voxels[0])                          // void * buf  OUT: Buffer to receive data read from file.
+            );
+        }
+        else{
+
+            std::vector<unsigned int> ids(voxels_slab_dims[0]);
+            std::vector<float> values(voxels_slab_dims[0]);
+
+            for (size_t column : {datasets.ids, datasets.values}){
+                H5Sselect_hyperslab(_open_in_dataspaces[column],
+                    H5S_SELECT_SET,
+                    voxels_offset,    // start
+                    NULL ,            // stride
+                    voxels_slab_dims, // count
+                    NULL              // block
+                );
+
+                H5Dread(
+                    _open_in_datasets[column],
+                    _data_types[column],
+                    voxels_memspace,
+                    _open_in_dataspaces[column],
+                    xfer_plist_id,
+                    column == datasets.ids ? (void *) ids.data() : (void *) values.data()
+                );
+            }
+
+            // Decode set by set, deltas restart at each one:
+            voxels.clear();
+            voxels.reserve(voxels_slab_dims[0]);
+            size_t offset = 0;
+            for (auto & extents : voxel_extents){
+                Voxel::decode(ids.data() + offset, values.data() + offset, extents.n, _in_voxel_encoding, voxels);
+                offset += extents.n;
+            }
+        }
+
+        H5Sclose(voxels_memspace);
+    }
+
+    hsize_t EventBase::out_size(size_t i){
+        // The buffers are sized the first time they are needed, after the
+        // product has opened its output datasets:
+        if (_out_buffers.size() < _open_out_datasets.size()){
+            size_t n_existing = _out_buffers.size();
+            _out_buffers.resize(_open_out_datasets.size());
+            _out_rows_written.resize(_open_out_datasets.size());
+            for (size_t j = n_existing; j < _open_out_datasets.size(); j ++){
+                _out_rows_written[j] = 0;
+                if (_open_out_datasets[j] < 0) continue;
+                hid_t dataspace = H5Dget_space(_open_out_datasets[j]);
+                hsize_t dims_current[1];
+                H5Sget_simple_extent_dims(dataspace, dims_current, NULL);
+                H5Sclose(dataspace);
+                _out_rows_written[j] = dims_current[0];
+            }
+        }
+        return _out_rows_written[i] + _out_buffers[i].size() / H5Tget_size(_data_types[i]);
+    }
+
+    void EventBase::append_rows(size_t i, const void * rows, size_t n_rows){
+        if (n_rows == 0) return;
+        // Make sure the buffers exist:
+        out_size(i);
+        const char * begin = static_cast<const char *>(rows);
+        _out_buffers[i].insert(_out_buffers[i].end(), begin, begin + n_rows * H5Tget_size(_data_types[i]));
+    }
+
+    void EventBase::append_dictionary_rows(size_t i, size_t i_index, const void * rows, size_t n_rows){
+        size_t row_bytes = H5Tget_size(_data_types[i]);
+
+        // Look up the rows already in the file (appending to it, or a new file) once:
+        if (_out_dictionary_m.size() != out_size(i)){
+            std::vector<char> dictionary(_out_rows_written[i] * row_bytes);
+            if (!dictionary.empty())
+                H5Dread(_open_out_datasets[i], _data_types[i], H5S_ALL, H5S_ALL, H5P_DEFAULT, dictionary.data());
+            dictionary.insert(dictionary.end(), _out_buffers[i].begin(), _out_buffers[i].end());
+            _out_dictionary_m.clear();
+            for (size_t row = 0; row < dictionary.size() / row_bytes; row ++)
+                _out_dictionary_m.emplace(stored_bytes(_data_types[i], dictionary.data() + row * row_bytes), row);
+        }
+
+        const char * begin = static_cast<const char *>(rows);
+        std::vector<unsigned int> index(n_rows);
+        for (size_t k = 0; k < n_rows; k ++){
+            auto key = stored_bytes(_data_types[i], begin + k * row_bytes);
+            auto iter = _out_dictionary_m.find(key);
+            if (iter == _out_dictionary_m.end()){
+                iter = _out_dictionary_m.emplace(key, _out_dictionary_m.size()).first;
+                append_rows(i, begin + k * row_bytes, 1);
+            }
+            index[k] = iter->second;
+        }
+        append_rows(i_index, index.data(), n_rows);
+    }
+
+    void EventBase::flush(bool final){
+        prepare_flush(final);
+
+        hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+
+        for (size_t i = 0; i < _out_buffers.size(); i ++){
+            // Rows of a dataset that isn't created yet wait for a later flush:
+            if (_out_buffers[i].empty() || _open_out_datasets[i] < 0) continue;
+
+            hsize_t slab_dims[1];
+            slab_dims[0] = _out_buffers[i].size() / H5Tget_size(_data_types[i]);
+
+            hsize_t offset[1];
+            offset[0] = _out_rows_written[i];
+
+            // Extend the dataset to accomodate all of the buffered rows at once
+            hsize_t size[1];
+            size[0] = offset[0] + slab_dims[0];
+            H5Dset_extent(_open_out_datasets[i], size);
+
+            // Select the new rows as a hyperslab, and write them in one call
+            hid_t dataspace = H5Dget_space(_open_out_datasets[i]);
+            H5Sselect_hyperslab(dataspace,
+              H5S_SELECT_SET,
+              offset,    // start
+              NULL ,     // stride
+              slab_dims, // count
+              NULL       // block
+            );
+            hid_t memspace = H5Screate_simple(1, slab_dims, NULL);
+
+            H5Dwrite(_open_out_datasets[i],   // dataset_id,
+                     _data_types[i],          // hit_t mem_type_id,
+                     memspace,                // hid_t mem_space_id,
+                     dataspace,               // hid_t file_space_id,
+                     xfer_plist_id,           // hid_t xfer_plist_id,
+                     &(_out_buffers[i][0])    // const void * buf
+                   );
+
+            H5Sclose(memspace);
+            H5Sclose(dataspace);
+
+            _out_rows_written[i] = size[0];
+            _out_buffers[i].clear();
+        }
+
+        H5Pclose(xfer_plist_id);
+    }
+
+    size_t EventBase::buffered_bytes() const{
+        size_t bytes = 0;
+        for (auto & buffer : _out_buffers) bytes += buffer.size();
+        return bytes;
+    }
 }
 
 void init_eventbase(pybind11::module m){
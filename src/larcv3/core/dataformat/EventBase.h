@@ -15,6 +15,8 @@
 #define __LARCV3DATAFORMAT_EVENTBASE_H
 
 #include <iostream>
+#include <map>
+#include <memory>
 #include "larcv3/core/base/larcv_base.h"
 #include "larcv3/core/dataformat/DataFormatTypes.h"
 
@@ -23,6 +25,58 @@
 namespace larcv3 {
   // class IOManager;
   class DataProductFactory;
+  class Voxel;
+
+  /**
+    \struct H5StorageConfig
+    HDF5 chunking and chunk cache settings of a data product, filled in by IOManager.
+    Zero (or negative for w0) means the product's own choice / the HDF5 default.
+  */
+  struct H5StorageConfig {
+    H5StorageConfig()
+      : data_chunk_size(0), index_chunk_size(0)
+      , chunk_cache_bytes(0), chunk_cache_slots(0), chunk_cache_w0(-1.)
+      , voxel_encoding(kVoxelLegacy), preload_index_bytes(0), meta_dictionary(false) {}
+    size_t data_chunk_size;   ///< Elements per chunk of the bulk data (voxels, particles, images)
+    size_t index_chunk_size;  ///< Elements per chunk of the extents and meta tables
+    size_t chunk_cache_bytes; ///< Size of the chunk cache of each dataset opened for reading
+    size_t chunk_cache_slots; ///< Number of hash table slots in the chunk cache
+    double chunk_cache_w0;    ///< Chunk cache preemption policy, 0 to 1
+    VoxelEncoding_t voxel_encoding; ///< On-disk encoding of written voxels (sparse products only)
+    size_t preload_index_bytes; ///< Largest index of an input file loaded into memory, 0 for none
+    bool meta_dictionary;     ///< Write each distinct image meta once, and an index into them per projection
+  };
+
+  /**
+    \struct H5InputIndex
+    The extents of every entry of a product in one input file, and the per projection
+    (image, cluster set) extents they point to, loaded once so entries are read without
+    first reading their rows of these tables.  A table stored as a dictionary (the image
+    metas) is always loaded, and its per projection index with the rest of the index.
+  */
+  struct H5InputIndex {
+    H5InputIndex() : loaded(false) {}
+    std::vector<Extents_t>    extents;
+    std::vector<IDExtents_t>  set_extents;
+    std::vector<unsigned int> dictionary_index;
+    std::vector<char>         dictionary;
+    bool loaded;
+    size_t bytes() const
+    { return extents.capacity() * sizeof(Extents_t) + set_extents.capacity() * sizeof(IDExtents_t)
+           + dictionary_index.capacity() * sizeof(unsigned int) + dictionary.capacity(); }
+  };
+
+  /**
+    \struct H5InputHandles
+    Open input datasets of a data product in one input file, parked while another file is read.
+  */
+  struct H5InputHandles {
+    std::vector<hid_t> datasets;
+    std::vector<hid_t> dataspaces;
+    VoxelEncoding_t voxel_encoding;
+    H5InputIndex index;
+  };
+
   /**
     \class EventBase
     Base class for an event data product (what is stored in output file), holding run/subrun/event ID + producer name.
@@ -32,25 +86,129 @@ namespace larcv3 {
     friend class DataProductFactory;
   public:
 
+    EventBase()
+      : _in_group(H5I_INVALID_HID), _in_voxel_encoding(kVoxelLegacy)
+      , _out_voxels_group(H5I_INVALID_HID) {}
     virtual ~EventBase() = 0;
 
     virtual void clear() = 0;
     virtual void initialize (hid_t group, uint compression) = 0;
     virtual void serialize  (hid_t group) = 0;
     virtual void deserialize(hid_t group, size_t entry, bool reopen_groups) = 0;
+    /// Read entries [first, first + products.size()) of group, entry first + i into products[i]
+    /// (fresh products of this type, which need no open datasets).  Products that override
+    /// this read each table once for the whole range; the default reads the entries one by
+    /// one, with the datasets open here.
+    virtual void deserialize_range(hid_t group, size_t first,
+                                   std::vector<std::shared_ptr<EventBase> > & products);
     virtual void finalize() = 0;
+    /// Exchange the event's data (not the open datasets or settings) with other, of the same type
+    virtual void swap_data(EventBase & other) = 0;
+    /// Take the settings (storage configuration, read options) of other, of the same type
+    virtual void copy_settings(const EventBase & other) { _storage = other._storage; }
 
     virtual void open_in_datasets(hid_t group ) = 0;
     virtual void open_out_datasets(hid_t group ) = 0;
 
     std::vector<hid_t> _open_in_datasets;
     std::vector<hid_t> _open_in_dataspaces;
+    /// Group the open input datasets belong to, and the encoding of its voxels (sparse products)
+    hid_t _in_group;
+    VoxelEncoding_t _in_voxel_encoding;
+    /// Open input datasets of the other groups (files) the IOManager keeps open
+    std::map<hid_t, H5InputHandles> _in_handles_m;
+    /// Preloaded index of the group the open input datasets belong to
+    H5InputIndex _in_index_tables;
+
+    /// Make group's input datasets the open ones, parking the current ones.  If group
+    /// has none yet, the open datasets are left empty for deserialize to open.
+    void select_in_group(hid_t group);
+    /// Close the input datasets of group, open or parked, before its file is closed
+    void close_in_group(hid_t group);
     std::vector<hid_t> _open_out_datasets;
     std::vector<hid_t> _open_out_dataspaces;
     std::vector<hid_t> _data_types;
 
     int get_num_objects(hid_t group);
 
+    /// Read n_rows rows of open input dataset i, from row first, into rows (laid out as _data_types[i])
+    void read_in_rows(size_t i, hsize_t first, hsize_t n_rows, void * rows);
+    /// Load the open input extents table i_extents, the table i_sets they point to and the
+    /// dictionary index i_index (those that exist and are open), into _in_index_tables, if
+    /// they take at most _storage.preload_index_bytes.  Call it when the input datasets are opened.
+    void load_in_index(size_t i_extents, int i_sets = -1, int i_index = -1);
+    /// read_in_rows of the extents tables, from the preloaded index if it is loaded
+    void read_in_extents(size_t i, hsize_t first, hsize_t n_rows, Extents_t * rows);
+    void read_in_set_extents(size_t i, hsize_t first, hsize_t n_rows, IDExtents_t * rows);
+    /// If the open input table i is a dictionary, that is if its index table i_index is open,
+    /// load all of its rows.  Call it after load_in_index.
+    void load_in_dictionary(size_t i, size_t i_index);
+    /// read_in_rows of table i, or if it is a dictionary, of the rows its index i_index picks
+    void read_in_dictionary_rows(size_t i, size_t i_index, hsize_t first, hsize_t n_rows, void * rows);
+    /// Memory held by the preloaded indexes of all the open input files
+    size_t in_index_bytes() const;
+
+    H5StorageConfig _storage;
+
+    /// Configured chunk size of the bulk data, or default_size if it isn't set
+    hsize_t data_chunk_size(hsize_t default_size) const;
+    /// Configured chunk size of the index tables, or default_size if it isn't set
+    hsize_t index_chunk_size(hsize_t default_size) const;
+    /// Chunk size for bulk data when nothing is configured, from the size of a typical event
+    static hsize_t auto_chunk_size(size_t elements_per_event, size_t element_bytes);
+    /// Entries a product sizing its chunks automatically averages over, when the writes
+    /// of its bulk data can wait for them
+    static const size_t auto_chunk_sample_entries = 16;
+    /// Dataset access property list with the configured chunk cache.  Close it after use.
+    hid_t dataset_access_plist() const;
+    /// Create an empty, extendible 1D dataset of the given type.  Shuffle reorders the bytes of
+    /// each chunk by significance before compression, which helps narrow integer columns.
+    void create_chunked_dataset(hid_t group, const char * name, hid_t type, hsize_t chunk_size,
+                                uint compression, bool shuffle = false) const;
+
+    /// Where the voxels of a sparse product are among its datasets: the (id, value) table
+    /// of kVoxelLegacy, and the id and value columns of the compact encodings
+    struct VoxelDatasets { size_t voxels; size_t ids; size_t values; };
+    /// Recognize the encoding of the voxels in group, and open their dataset(s) for reading
+    void open_in_voxels_datasets(hid_t group, const VoxelDatasets & datasets, hid_t dapl);
+    /// Open the output voxel dataset(s) of the configured encoding, if they exist yet
+    void open_out_voxels_datasets(hid_t group, const VoxelDatasets & datasets);
+    /// Create the output voxel dataset(s) of the configured encoding
+    void create_voxels_datasets(hid_t group, const VoxelDatasets & datasets, hsize_t chunk_size,
+                                uint compression) const;
+    /// prepare_flush of a sparse product: create and open the voxel dataset(s) serialize left
+    /// to _out_voxels_group, sized from the mean voxels per entry of extents dataset i_extents
+    void prepare_voxels_flush(const VoxelDatasets & datasets, size_t i_extents, uint compression,
+                              bool final);
+    /// Read the (contiguous) voxels of all of voxel_extents, in the input encoding
+    void read_voxels(const VoxelDatasets & datasets, const std::vector<IDExtents_t> & voxel_extents,
+                     hid_t xfer_plist_id, std::vector<larcv3::Voxel> & voxels);
+    /// Output group whose voxel dataset(s) a sparse product creates at a later flush, if any
+    hid_t _out_voxels_group;
+
+    /// Rows in output dataset i, counting rows that are buffered but not yet written.
+    /// Datasets a product leaves unopened (a negative id) always have 0 rows.
+    hsize_t out_size(size_t i);
+    /// Buffer n_rows rows (laid out as _data_types[i]) for the end of output dataset i
+    void append_rows(size_t i, const void * rows, size_t n_rows);
+    /// Buffer n_rows rows for output dictionary dataset i, the ones it doesn't have yet, and
+    /// the dictionary row of each of them for index dataset i_index (unsigned int)
+    void append_dictionary_rows(size_t i, size_t i_index, const void * rows, size_t n_rows);
+    /// Called by flush before anything is written: products that wait to create an output
+    /// dataset until they have seen the rows buffered for it create (and open) it here.
+    /// Unless the flush is final, they may keep waiting, and the rows stay buffered.
+    virtual void prepare_flush(bool final) {}
+    /// Write the buffered rows of every open output dataset, one extent change and one write
+    /// each.  A final flush (the default) leaves nothing buffered.
+    void flush(bool final = true);
+    /// Bytes currently buffered for writing
+    size_t buffered_bytes() const;
+
+    std::vector<std::vector<char> > _out_buffers;
+    std::vector<hsize_t> _out_rows_written;
+    /// Dictionary row of each row in the output dictionary, keyed by its stored bytes
+    std::map<std::string, unsigned int> _out_dictionary_m;
+
 
 
 // #endif
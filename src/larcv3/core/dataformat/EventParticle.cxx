@@ -73,12 +73,18 @@ namespace larcv3{
        _open_in_datasets.resize(N_DATASETS);
        _open_in_dataspaces.resize(N_DATASETS);
 
-       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group, "extents", H5P_DEFAULT);
+       hid_t dapl = dataset_access_plist();
+
+       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group, "extents", dapl);
        _open_in_dataspaces[EXTENTS_DATASET]       = H5Dget_space(_open_in_datasets[EXTENTS_DATASET]);
 
-       _open_in_datasets[PARTICLES_DATASET]       = H5Dopen(group, "particles", H5P_DEFAULT);
+       _open_in_datasets[PARTICLES_DATASET]       = H5Dopen(group, "particles", dapl);
        _open_in_dataspaces[PARTICLES_DATASET]     = H5Dget_space(_open_in_datasets[PARTICLES_DATASET]);
 
+       H5Pclose(dapl);
+
+       load_in_index(EXTENTS_DATASET);
+
     }
 
     return;
@@ -106,16 +112,11 @@ namespace larcv3{
 
     // Serialization is a multi step process.
     // - First, we update the data table.
-    //  - fetch the dataset from the group
     //  - Note the total size of the dataset as the 'first' extents object
-    //  - extend the dataset by _part_v.size() elements
-    //  - Note 'first' + _part_v.size() as the 'last' extents object
-    //  - select a hyperslab of the last _part_v.size() elements
-    //  - write the data to the group
-    // - Create an extents object from first and last
-    // - Get the extents dataset.
-    //  - Extend the extents dataset by 1
-    //  - Append the latest extents
+    //  - append the _part_v.size() new particles
+    // - Create an extents object from first and the number of particles
+    // - Append the latest extents to the extents table
+    // The rows are buffered in EventBase until the IOManager flushes them.
     // Return
 
     open_out_datasets(group);
@@ -125,140 +126,23 @@ namespace larcv3{
     /////////////////////////////////////////////////////////
     Extents_t next_extents;
 
-
-
-    /////////////////////////////////////////////////////////
-    // Get and extend the particles dataset
-    /////////////////////////////////////////////////////////
-    // H5::DataSet * particles_dataset = &(_open_datasets[PARTICLES_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace particles_dataspace = particles_dataset.getSpace();
-
-    // Get the dataset current size
-    hsize_t particles_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[PARTICLES_DATASET], particles_dims_current, NULL);
-    // .getSimpleExtentDims(particles_dims_current, NULL);
-
-    // Make a note of the first index:
-    next_extents.first = particles_dims_current[0];
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t particles_slab_dims[1];
-    particles_slab_dims[0] = _part_v.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t particles_size[1];
-    particles_size[0] = particles_dims_current[0] + particles_slab_dims[0];
-
-    // Make a note of the last index:
+    // Make a note of the first index, including particles not yet flushed:
+    next_extents.first = out_size(PARTICLES_DATASET);
     next_extents.n = _part_v.size();
 
 
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[PARTICLES_DATASET], particles_size);
-    // .extend(particles_size);
-
-
     /////////////////////////////////////////////////////////
     // Write the new particles to the dataset
     /////////////////////////////////////////////////////////
 
-    // Select as a hyperslab the last section of data for writing:
-    // Need to reopen the dataspace after extension:
-    _open_out_dataspaces[PARTICLES_DATASET] = H5Dget_space(_open_out_datasets[PARTICLES_DATASET]);
-
-    H5Sselect_hyperslab(_open_out_dataspaces[PARTICLES_DATASET],
-      H5S_SELECT_SET,
-      particles_dims_current, // start
-      NULL ,                  // stride
-      particles_slab_dims,    // count
-      NULL                    // block
-      );
-
-
-    // Define memory space:
-    // H5::DataSpace particles_memspace(1, particles_slab_dims);
-    hid_t particles_memspace = H5Screate_simple(1, particles_slab_dims, NULL);
-
-    // Transfer property list, default:
-    hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
-
-    // Write the new data
-    // _open_out_datasets[PARTICLES_DATASET].write(&(_part_v[0]), _data_types[PARTICLES_DATASET],
-        // particles_memspace, _open_out_dataspaces[PARTICLES_DATASET]);
-
-    H5Dwrite(_open_out_datasets[PARTICLES_DATASET],   // dataset_id,
-             _data_types[PARTICLES_DATASET],          // hit_t mem_type_id,
-             particles_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[PARTICLES_DATASET], //hid_t file_space_id,
-             xfer_plist_id,                           //hid_t xfer_plist_id,
-             &(_part_v[0])                            // const void * buf
-           );
-
-    /////////////////////////////////////////////////////////
-    // Get the extents dataset
-    /////////////////////////////////////////////////////////
-
-    // H5::DataSet * extents_dataset = &(_open_out_datasets[EXTENTS_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace extents_dataspace = extents_dataset.getSpace();
-
-
-    // Get the dataset current size
-     hsize_t extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[EXTENTS_DATASET], extents_dims_current, NULL);
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t extents_size[1];
-    extents_size[0] = extents_dims_current[0] + extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[EXTENTS_DATASET], extents_size);
+    append_rows(PARTICLES_DATASET, _part_v.data(), _part_v.size());
 
 
     /////////////////////////////////////////////////////////
     // Write the new extents entry to the dataset
     /////////////////////////////////////////////////////////
 
-
-
-    // Select as a hyperslab the last section of data for writing:
-    // Need to reopen the dataspace after extension:
-    _open_out_dataspaces[EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[EXTENTS_DATASET]);
-
-    H5Sselect_hyperslab(_open_out_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_dims_current, // start
-      NULL ,  // stride
-      extents_slab_dims, //count
-      NULL // block
-      );
-
-
-    // Define memory space:
-    // H5::DataSpace particles_memspace(1, particles_slab_dims);
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
-    // Write the new data
-    // _open_out_datasets[PARTICLES_DATASET].write(&(_part_v[0]), _data_types[PARTICLES_DATASET],
-        // extents_memspace, _open_out_dataspaces[PARTICLES_DATASET]);
-
-    H5Dwrite(_open_out_datasets[EXTENTS_DATASET], // dataset_id,
-             _data_types[EXTENTS_DATASET], // hit_t mem_type_id,
-             extents_memspace, // hid_t mem_space_id,
-             _open_out_dataspaces[EXTENTS_DATASET], //hid_t file_space_id,
-             xfer_plist_id, //hid_t xfer_plist_id,
-             &(next_extents) // const void * buf
-             );
-
+    append_rows(EXTENTS_DATASET, &next_extents, 1);
 
     /////////////////////////////////////////////////////////
     // Serialized!
@@ -307,7 +191,7 @@ namespace larcv3{
 
 
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      extents_chunk_dims[1] ={PARTICLE_EXTENTS_CHUNK_SIZE};
+    hsize_t      extents_chunk_dims[1] ={index_chunk_size(PARTICLE_EXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(extents_cparms, 1, extents_chunk_dims );
     if (compression){
       H5Pset_deflate(extents_cparms, compression);
@@ -347,7 +231,7 @@ namespace larcv3{
      */
 
     hid_t   particle_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    hsize_t particle_chunk_dims[1] ={PARTICLE_DATA_CHUNK_SIZE};
+    hsize_t particle_chunk_dims[1] ={data_chunk_size(PARTICLE_DATA_CHUNK_SIZE)};
 
     H5Pset_chunk(particle_cparms, 1, particle_chunk_dims );
     if (compression){
@@ -385,74 +269,23 @@ namespace larcv3{
 
     open_in_datasets(group);
 
-    // H5::DataSet * extents_dataset = &(_open_datasets[EXTENTS_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace extents_dataspace = extents_dataset.getSpace();
-
-
-    // // Get the dataset current size
-    // hsize_t extents_dims_current[1];
-    // extents_dataspace.getSimpleExtentDims(extents_dims_current, NULL);
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-    hsize_t extents_offset[1];
-    extents_offset[0] = entry;
-
-
-    // // Create a size vector for the FULL dataset: previous + current
-    // hsize_t extents_size[1];
-    // extents_size[0] = extents_dims_current[0] + extents_slab_dims[0];
-
-    // // Extend the dataset to accomodate the new data
-    // extents_dataset.extend(extents_size);
-
-
-    /////////////////////////////////////////////////////////
-    // Read this extents entry to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-
-    H5Sselect_hyperslab(_open_in_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_offset, // start
-      NULL ,  // stride
-      extents_slab_dims, //count
-      NULL // block
-      );
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
+    // From the preloaded index, if there is one:
     Extents_t input_extents;
-    // Write the new data
-    // _open_in_datasets[EXTENTS_DATASET].read(&(input_extents), *_data_types[EXTENTS_DATASET],
-      // extents_memspace, _open_in_dataspaces[EXTENTS_DATASET]);
+    read_in_extents(EXTENTS_DATASET, entry, 1, &input_extents);
 
     // Transfer property list, default
     hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
 
-    H5Dread(
-      _open_in_datasets[EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                         // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(input_extents)                       // void * buf  OUT: Buffer to receive data read from file.
-    );
-
     // std::cout << " Extents start: " << input_extents.first << ", end: "
     //           << input_extents.first + input_extents.n << std::endl;
 
 
     // Next, open the relevant sections of the data
 
-    // If there are no particles, dont read anything:
+    // If there are no particles, dont read anything (but drop the previous entry's):
     if ( input_extents.n == 0){
+        _part_v.clear();
+        H5Pclose(xfer_plist_id);
         return;
     }
 
@@ -504,6 +337,36 @@ namespace larcv3{
     return;
   }
 
+  void EventParticle::deserialize_range(hid_t group, size_t first,
+      std::vector<std::shared_ptr<EventBase> > & products){
+
+    // One read of the extents and one of the particles for all the entries:
+    if (products.empty()) return;
+    open_in_datasets(group);
+
+    std::vector<Extents_t> input_extents(products.size());
+    read_in_extents(EXTENTS_DATASET, first, input_extents.size(), input_extents.data());
+
+    size_t n_particles = 0;
+    for (auto & extents : input_extents){
+      if (extents.n && extents.first != input_extents.front().first + n_particles){
+        EventBase::deserialize_range(group, first, products);
+        return;
+      }
+      n_particles += extents.n;
+    }
+
+    std::vector<larcv3::Particle> particles(n_particles);
+    read_in_rows(PARTICLES_DATASET, input_extents.front().first, n_particles, particles.data());
+
+    size_t offset = 0;
+    for (size_t i_entry = 0; i_entry < products.size(); i_entry ++){
+      auto & product = static_cast<EventParticle &>(*products[i_entry]);
+      product._part_v.assign(particles.begin() + offset, particles.begin() + offset + input_extents[i_entry].n);
+      offset += input_extents[i_entry].n;
+    }
+  }
+
 
 } // larcv3
 
@@ -6,7 +6,6 @@
 #define VOXEL_EXTENTS_CHUNK_SIZE 10
 #define VOXEL_IDEXTENTS_CHUNK_SIZE 100
 #define VOXEL_META_CHUNK_SIZE 100
-#define VOXEL_DATA_CHUNK_SIZE 1000
 #define IMAGE_META_CHUNK_SIZE 100
 
 #define EXTENTS_DATASET 0
@@ -14,7 +13,10 @@
 #define PROJECTION_DATASET 2
 #define IMAGE_META_DATASET 3
 #define VOXELS_DATASET 4
-#define N_DATASETS 5
+#define VOXEL_IDS_DATASET 5
+#define VOXEL_VALUES_DATASET 6
+#define IMAGE_META_INDEX_DATASET 7
+#define N_DATASETS 8
 
 
 namespace larcv3 {
@@ -23,8 +25,15 @@ namespace larcv3 {
   static EventSparseCluster2DFactory __global_EventSparseCluster2DFactory__;
   static EventSparseCluster3DFactory __global_EventSparseCluster3DFactory__;
 
+  /// Datasets holding the voxels, in each encoding
+  static const EventBase::VoxelDatasets sparse_cluster_voxels = {VOXELS_DATASET, VOXEL_IDS_DATASET, VOXEL_VALUES_DATASET};
+
   template<size_t dimension>
-  EventSparseCluster<dimension>::EventSparseCluster(){
+  EventSparseCluster<dimension>::EventSparseCluster() :
+    _compression(0),
+    _trust_ordering(true),
+    _validate_ordering(false)
+  {
 
     _data_types.resize(N_DATASETS);
 
@@ -33,6 +42,9 @@ namespace larcv3 {
     _data_types[PROJECTION_DATASET]      = larcv3::get_datatype<IDExtents_t>();
     _data_types[IMAGE_META_DATASET]      = larcv3::ImageMeta<dimension>::get_datatype();
     _data_types[VOXELS_DATASET]          = larcv3::Voxel::get_datatype();
+    _data_types[VOXEL_IDS_DATASET]       = larcv3::get_datatype<unsigned int>();
+    _data_types[VOXEL_VALUES_DATASET]    = larcv3::get_datatype<float>();
+    _data_types[IMAGE_META_INDEX_DATASET] = larcv3::get_datatype<unsigned int>();
 
 
   }
@@ -132,7 +144,7 @@ namespace larcv3 {
 
     hid_t extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      extents_chunk_dims[1] ={VOXEL_EXTENTS_CHUNK_SIZE};
+    hsize_t      extents_chunk_dims[1] ={index_chunk_size(VOXEL_EXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(extents_cparms, 1, extents_chunk_dims );
     if (compression){
       H5Pset_deflate(extents_cparms, compression);
@@ -168,7 +180,7 @@ namespace larcv3 {
 
     hid_t projection_extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      projection_extents_chunk_dims[1] ={VOXEL_IDEXTENTS_CHUNK_SIZE};
+    hsize_t      projection_extents_chunk_dims[1] ={index_chunk_size(VOXEL_IDEXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(projection_extents_cparms, 1, projection_extents_chunk_dims );
     if (compression){
       H5Pset_deflate(projection_extents_cparms, compression);
@@ -206,7 +218,7 @@ namespace larcv3 {
 
     hid_t image_meta_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      image_meta_chunk_dims[1] ={IMAGE_META_CHUNK_SIZE};
+    hsize_t      image_meta_chunk_dims[1] ={index_chunk_size(IMAGE_META_CHUNK_SIZE)};
     H5Pset_chunk(image_meta_cparms, 1, image_meta_chunk_dims );
     if (compression){
       H5Pset_deflate(image_meta_cparms, compression);
@@ -214,10 +226,10 @@ namespace larcv3 {
     }
 
 
-    // Create the extents dataset:
+    // Create the meta dataset, or the dictionary of metas:
     H5Dcreate(
       group,                           // hid_t loc_id  IN: Location identifier
-      "image_meta",                    // const char *name      IN: Dataset name
+      _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", // const char *name      IN: Dataset name
       _data_types[IMAGE_META_DATASET], // hid_t dtype_id  IN: Datatype identifier
       image_meta_dataspace,            // hid_t space_id  IN: Dataspace identifier
       lcpl,                            // hid_t lcpl_id IN: Link creation property list
@@ -225,6 +237,11 @@ namespace larcv3 {
       dapl                             // hid_t dapl_id IN: Dataset access property list
     );
 
+    // With a meta dictionary, the dictionary row of each projection's meta:
+    if (_storage.meta_dictionary)
+      create_chunked_dataset(group, "image_meta_index", _data_types[IMAGE_META_INDEX_DATASET],
+        index_chunk_size(IMAGE_META_CHUNK_SIZE), compression);
+
     /////////////////////////////////////////////////////////
     // Create the Cluster extents dataset (IDExtents)
     /////////////////////////////////////////////////////////
@@ -243,7 +260,7 @@ namespace larcv3 {
 
     hid_t cluster_extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      cluster_extents_chunk_dims[1] ={VOXEL_META_CHUNK_SIZE};
+    hsize_t      cluster_extents_chunk_dims[1] ={index_chunk_size(VOXEL_META_CHUNK_SIZE)};
     H5Pset_chunk(cluster_extents_cparms, 1, cluster_extents_chunk_dims );
     if (compression){
       H5Pset_deflate(cluster_extents_cparms, compression);
@@ -262,43 +279,12 @@ namespace larcv3 {
     );
 
 
-    /////////////////////////////////////////////////////////
-    // Create the voxels dataset (Voxels)
-    /////////////////////////////////////////////////////////
-
-
-    // Get the starting size (0) and dimensions (unlimited)
-    hsize_t voxel_starting_dim[] = {0};
-    hsize_t voxel_maxsize_dim[]  = {H5S_UNLIMITED};
-
-    // Create a dataspace
-    hid_t voxel_dataspace = H5Screate_simple(1, voxel_starting_dim, voxel_maxsize_dim);
-
-    /*
-     * Modify dataset creation properties, i.e. enable chunking.
-     */
-
-    hid_t voxel_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    // H5::DSetCreatPropList extents_cparms;
-    hsize_t      voxel_chunk_dims[1] ={VOXEL_DATA_CHUNK_SIZE};
-    H5Pset_chunk(voxel_cparms, 1, voxel_chunk_dims );
-    if (compression){
-      H5Pset_deflate(voxel_cparms, compression);
-      // extents_cparms.setDeflate(compression);
-    }
-
-    // Create the voxels dataset:
-    H5Dcreate(
-      group,                       // hid_t loc_id  IN: Location identifier
-      "voxels",                    // const char *name      IN: Dataset name
-      _data_types[VOXELS_DATASET], // hid_t dtype_id  IN: Datatype identifier
-      voxel_dataspace,             // hid_t space_id  IN: Dataspace identifier
-      lcpl,                        // hid_t lcpl_id IN: Link creation property list
-      voxel_cparms,                // hid_t dcpl_id IN: Dataset creation property list
-      dapl                         // hid_t dapl_id IN: Dataset access property list
-    );
-
+    _compression = compression;
 
+    // Without a configured chunk size, the voxels dataset is created once enough
+    // events are buffered to size its chunks from:
+    if (_storage.data_chunk_size)
+      create_voxels_datasets(group, sparse_cluster_voxels, _storage.data_chunk_size, _compression);
   }
 
   template<size_t dimension>
@@ -309,20 +295,35 @@ namespace larcv3 {
        _open_in_dataspaces.resize(N_DATASETS);
 
 
-       _open_in_datasets[EXTENTS_DATASET]            = H5Dopen(group, "extents", H5P_DEFAULT);
+       hid_t dapl = dataset_access_plist();
+
+       _open_in_datasets[EXTENTS_DATASET]            = H5Dopen(group, "extents", dapl);
        _open_in_dataspaces[EXTENTS_DATASET]          = H5Dget_space(_open_in_datasets[EXTENTS_DATASET]);
 
-       _open_in_datasets[PROJECTION_DATASET]         = H5Dopen(group, "projection_extents", H5P_DEFAULT);
+       _open_in_datasets[PROJECTION_DATASET]         = H5Dopen(group, "projection_extents", dapl);
        _open_in_dataspaces[PROJECTION_DATASET]       = H5Dget_space(_open_in_datasets[PROJECTION_DATASET]);
 
-       _open_in_datasets[CLUSTER_EXTENTS_DATASET]    = H5Dopen(group, "cluster_extents", H5P_DEFAULT);
+       _open_in_datasets[CLUSTER_EXTENTS_DATASET]    = H5Dopen(group, "cluster_extents", dapl);
        _open_in_dataspaces[CLUSTER_EXTENTS_DATASET]  = H5Dget_space(_open_in_datasets[CLUSTER_EXTENTS_DATASET]);
 
-       _open_in_datasets[IMAGE_META_DATASET]         = H5Dopen(group, "image_meta", H5P_DEFAULT);
+       // Files written with a meta dictionary have an index into it instead of a meta table:
+       _open_in_datasets[IMAGE_META_INDEX_DATASET]     = H5I_INVALID_HID;
+       if (H5Lexists(group, "image_meta_index", H5P_DEFAULT) > 0){
+         _open_in_datasets[IMAGE_META_DATASET]         = H5Dopen(group, "image_meta_dictionary", dapl);
+         _open_in_datasets[IMAGE_META_INDEX_DATASET]   = H5Dopen(group, "image_meta_index", dapl);
+         _open_in_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_in_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+       else{
+         _open_in_datasets[IMAGE_META_DATASET]         = H5Dopen(group, "image_meta", dapl);
+       }
        _open_in_dataspaces[IMAGE_META_DATASET]       = H5Dget_space(_open_in_datasets[IMAGE_META_DATASET]);
 
-       _open_in_datasets[VOXELS_DATASET]             = H5Dopen(group, "voxels", H5P_DEFAULT);
-       _open_in_dataspaces[VOXELS_DATASET]           = H5Dget_space(_open_in_datasets[VOXELS_DATASET]);
+       open_in_voxels_datasets(group, sparse_cluster_voxels, dapl);
+
+       H5Pclose(dapl);
+
+       load_in_index(EXTENTS_DATASET, PROJECTION_DATASET, IMAGE_META_INDEX_DATASET);
+       load_in_dictionary(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET);
      }
 
     return;
@@ -344,26 +345,40 @@ namespace larcv3 {
        _open_out_datasets[CLUSTER_EXTENTS_DATASET]    = H5Dopen(group, "cluster_extents", H5P_DEFAULT);
        _open_out_dataspaces[CLUSTER_EXTENTS_DATASET]  = H5Dget_space(_open_out_datasets[CLUSTER_EXTENTS_DATASET]);
 
-       _open_out_datasets[IMAGE_META_DATASET]         = H5Dopen(group, "image_meta", H5P_DEFAULT);
+       _open_out_datasets[IMAGE_META_DATASET]         = H5Dopen(group,
+         _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", H5P_DEFAULT);
        _open_out_dataspaces[IMAGE_META_DATASET]       = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
 
-       _open_out_datasets[VOXELS_DATASET]             = H5Dopen(group, "voxels", H5P_DEFAULT);
-       _open_out_dataspaces[VOXELS_DATASET]           = H5Dget_space(_open_out_datasets[VOXELS_DATASET]);
+       _open_out_datasets[IMAGE_META_INDEX_DATASET]     = H5I_INVALID_HID;
+       if (_storage.meta_dictionary){
+         _open_out_datasets[IMAGE_META_INDEX_DATASET]   = H5Dopen(group, "image_meta_index", H5P_DEFAULT);
+         _open_out_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+
+       open_out_voxels_datasets(group, sparse_cluster_voxels);
     }
 
     return;
   }
 
+  template<size_t dimension>
+  void EventSparseCluster<dimension>::prepare_flush(bool final){
+    prepare_voxels_flush(sparse_cluster_voxels, EXTENTS_DATASET, _compression, final);
+  }
+
   template<size_t dimension>
   void EventSparseCluster<dimension>::finalize(){
     for (size_t i = 0; i < _open_in_datasets.size(); i ++){
+      if (_open_in_datasets[i] < 0) continue;
       H5Sclose(_open_in_dataspaces[i]);
       H5Dclose(_open_in_datasets[i]);
     }
     for (size_t i = 0; i < _open_out_datasets.size(); i ++){
-      H5Sclose(_open_in_dataspaces[i]);
+      if (_open_out_datasets[i] < 0) continue;
+      H5Sclose(_open_out_dataspaces[i]);
       H5Dclose(_open_out_datasets[i]);
     }
+    _out_voxels_group = H5I_INVALID_HID;
   }
 
   template<size_t dimension>
@@ -389,39 +404,26 @@ namespace larcv3 {
     // 5) Update the image_meta table with the meta vector for this object.
     // 6) Update the cluster_extents table with the cluster_extents vector for this object.
     // 7) Update the voxels table with the voxels from this event, using the cluster_extents vector
-    open_out_datasets(group);
+    //
+    // As in EventSparseTensor, rows go to the EventBase output buffers until
+    // the IOManager flushes them.
 
-    // Transfer property list, default:
-    hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+    VoxelEncoding_t encoding = _storage.voxel_encoding;
+
+    // Without a configured chunk size, the voxels dataset doesn't exist until a flush
+    // sizes its chunks from the mean of the events buffered by then (see prepare_flush):
+    if (H5Lexists(group, Voxel::dataset_name(encoding), H5P_DEFAULT) <= 0) _out_voxels_group = group;
+
+    open_out_datasets(group);
 
 
     /////////////////////////////////////////////////////////
     // Step 1: Get the current dataset dimensions
     /////////////////////////////////////////////////////////
 
-
-    // Get the dataset current size
-    hsize_t extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[EXTENTS_DATASET], extents_dims_current, NULL);
-
-
-    // Get the dataset current size
-    hsize_t projection_extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[PROJECTION_DATASET], projection_extents_dims_current, NULL);
-
-
-    // Get the dataset current size
-    hsize_t image_meta_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[IMAGE_META_DATASET], image_meta_dims_current, NULL);
-
-    // Get the dataset current size
-    hsize_t cluster_extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[CLUSTER_EXTENTS_DATASET], cluster_extents_dims_current, NULL);
-
-
-    // Get the dataset current size
-    hsize_t voxels_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[VOXELS_DATASET], voxels_dims_current, NULL);
+    hsize_t projection_extents_dims_current = out_size(PROJECTION_DATASET);
+    hsize_t cluster_extents_dims_current    = out_size(CLUSTER_EXTENTS_DATASET);
+    hsize_t voxels_dims_current             = out_size(encoding == kVoxelLegacy ? VOXELS_DATASET : VOXEL_IDS_DATASET);
 
 
     /////////////////////////////////////////////////////////
@@ -431,9 +433,7 @@ namespace larcv3 {
     // We need to make the voxel extents object first, which we can do from the vector of voxels.
     std::vector<IDExtents_t> projection_extents;
 
-    size_t last_cluster_index = cluster_extents_dims_current[0];
-    size_t n_new_projections = 0;
-
+    size_t last_cluster_index = cluster_extents_dims_current;
 
     for (size_t projection_id = 0; projection_id < _cluster_v.size(); projection_id ++){
       projection_extents.resize(projection_extents.size() + 1);
@@ -441,14 +441,8 @@ namespace larcv3 {
       projection_extents.back().id    = _cluster_v.at(projection_id).meta().projection_id();
       projection_extents.back().first = last_cluster_index;
       last_cluster_index += projection_extents.back().n;
-      n_new_projections += projection_extents.back().n;
     }
 
-    // std::cout << "Voxel Extents Size: " << projection_extents.size() << std::endl;
-    // for (auto & e : projection_extents){
-    //   std::cout << "  n: " << e.n << std::endl;
-    // }
-
 
     /////////////////////////////////////////////////////////
     // Step 2a: Build the image_meta object
@@ -464,145 +458,32 @@ namespace larcv3 {
     // Step 3: Update the overall extents table
     /////////////////////////////////////////////////////////
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t extents_size[1];
-    extents_size[0] = extents_dims_current[0] + extents_slab_dims[0];
-
-
-    // Extend the dataset to accomodate the new data
-    // _open_out_datasets[EXTENTS_DATASET].extend(extents_size);
-    H5Dset_extent(_open_out_datasets[EXTENTS_DATASET], extents_size);
-
-    // Create an extents object to go into the extents table:
-
     Extents_t next_extents;
-    next_extents.first = projection_extents_dims_current[0];
+    next_extents.first = projection_extents_dims_current;
     next_extents.n = projection_extents.size();
 
-
-    /////////////////////////////////////////////////////////
-    // Write the new extents entry to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[EXTENTS_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_dims_current, // start
-      NULL ,                  // stride
-      extents_slab_dims,    // count
-      NULL                    // block
-      );
-
-    // Define memory space:
-    // H5::DataSpace particles_memspace(1, particles_slab_dims);
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
-
-    H5Dwrite(_open_out_datasets[EXTENTS_DATASET],   // dataset_id,
-             _data_types[EXTENTS_DATASET],          // hit_t mem_type_id,
-             extents_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[EXTENTS_DATASET], // hid_t file_space_id,
-             xfer_plist_id,                         // hid_t xfer_plist_id,
-             &(next_extents)                        // const void * buf
-           );
-
+    append_rows(EXTENTS_DATASET, &next_extents, 1);
 
 
     /////////////////////////////////////////////////////////
     // Step 4: Update the projection extents table
     /////////////////////////////////////////////////////////
 
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t projection_extents_slab_dims[1];
-    projection_extents_slab_dims[0] = projection_extents.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t projection_extents_size[1];
-    projection_extents_size[0] = projection_extents_dims_current[0] + projection_extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    // _open_out_datasets[PROJECTION_DATASET].extend(projection_extents_size);
-    H5Dset_extent(_open_out_datasets[PROJECTION_DATASET], projection_extents_size);
+    append_rows(PROJECTION_DATASET, projection_extents.data(), projection_extents.size());
 
 
     /////////////////////////////////////////////////////////
-    // Write the new projection_extents to the dataset
+    // Step 5: Write image meta (or the meta dictionary and its index)
     /////////////////////////////////////////////////////////
 
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[PROJECTION_DATASET] = H5Dget_space(_open_out_datasets[PROJECTION_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[PROJECTION_DATASET],
-      H5S_SELECT_SET,
-      projection_extents_dims_current, // start
-      NULL ,                           // stride
-      projection_extents_slab_dims,    // count
-      NULL                             // block
-    );
-
+    if (_storage.meta_dictionary)
+      append_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET, image_meta.data(), image_meta.size());
+    else
+      append_rows(IMAGE_META_DATASET, image_meta.data(), image_meta.size());
 
 
-    // Define memory space:
-    hid_t projection_extents_memspace = H5Screate_simple(1, projection_extents_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[PROJECTION_DATASET],   // dataset_id,
-             _data_types[PROJECTION_DATASET],          // hit_t mem_type_id,
-             projection_extents_memspace,              // hid_t mem_space_id,
-             _open_out_dataspaces[PROJECTION_DATASET], // hid_t file_space_id,
-             xfer_plist_id,                            // hid_t xfer_plist_id,
-             &(projection_extents[0])                  // const void * buf
-           );
-
-    /////////////////////////////////////////////////////////
-    // Step 5: Write image meta
-    /////////////////////////////////////////////////////////
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = image_meta.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t image_meta_size[1];
-    image_meta_size[0] = image_meta_dims_current[0] + image_meta_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[IMAGE_META_DATASET], image_meta_size);
-
-
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[IMAGE_META_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_dims_current, // start
-      NULL ,                   // stride
-      image_meta_slab_dims,    // count
-      NULL                     // block
-    );
-
-    // Define memory space:
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[IMAGE_META_DATASET],   // dataset_id,
-             _data_types[IMAGE_META_DATASET],          // hit_t mem_type_id,
-             image_meta_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[IMAGE_META_DATASET], // hid_t file_space_id,
-             xfer_plist_id,                            // hid_t xfer_plist_id,
-             &(image_meta[0])                          // const void * buf
-           );
     /////////////////////////////////////////////////////////
-    // Step 4: Update the cluster extents table
+    // Step 6: Update the cluster extents table
     /////////////////////////////////////////////////////////
 
     // First, build the cluster extents object, which has an entry for every cluster
@@ -610,10 +491,8 @@ namespace larcv3 {
 
     // The 'first' and 'n' objects refer to the voxel table, so we need to know the current values:
 
-
     std::vector<IDExtents_t> cluster_extents;
-    size_t last_voxel_index = voxels_dims_current[0];
-    size_t n_new_voxels = 0;
+    size_t last_voxel_index = voxels_dims_current;
 
     for (size_t projection_id = 0; projection_id < _cluster_v.size(); projection_id ++){
       for (size_t cluster_id = 0; cluster_id < _cluster_v.at(projection_id).size(); cluster_id ++){
@@ -622,118 +501,36 @@ namespace larcv3 {
         cluster_extents.back().id    = _cluster_v.at(projection_id).as_vector().at(cluster_id).id();
         cluster_extents.back().first = last_voxel_index;
         last_voxel_index += cluster_extents.back().n;
-        n_new_voxels += cluster_extents.back().n;
       }
 
     }
 
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t cluster_extents_slab_dims[1];
-    cluster_extents_slab_dims[0] = cluster_extents.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t cluster_extents_size[1];
-    cluster_extents_size[0] = cluster_extents_dims_current[0] + cluster_extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[CLUSTER_EXTENTS_DATASET], cluster_extents_size);
+    append_rows(CLUSTER_EXTENTS_DATASET, cluster_extents.data(), cluster_extents.size());
 
 
     /////////////////////////////////////////////////////////
-    // Write the new cluster_extents to the dataset
+    // Step 7: Write new voxels
     /////////////////////////////////////////////////////////
 
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[CLUSTER_EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[CLUSTER_EXTENTS_DATASET]);
-    H5Sselect_hyperslab(
-      _open_out_dataspaces[CLUSTER_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      cluster_extents_dims_current, // start
-      NULL ,                        // stride
-      cluster_extents_slab_dims,    // count
-      NULL                          // block
-    );
-    // Define memory space:
-    hid_t cluster_extents_memspace = H5Screate_simple(1, cluster_extents_slab_dims, NULL);
-
-
-    // Write the new data
-
-    H5Dwrite(
-      _open_out_datasets[CLUSTER_EXTENTS_DATASET],   // dataset_id,
-      _data_types[CLUSTER_EXTENTS_DATASET],          // hit_t mem_type_id,
-      cluster_extents_memspace,                      // hid_t mem_space_id,
-      _open_out_dataspaces[CLUSTER_EXTENTS_DATASET], // hid_t file_space_id,
-      xfer_plist_id,                                 // hid_t xfer_plist_id,
-      &(cluster_extents[0])                          // const void * buf
-    );
-    /////////////////////////////////////////////////////////
-    // Step 6: Write new voxels
-    /////////////////////////////////////////////////////////
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t voxels_slab_dims[1];
-    voxels_slab_dims[0] = n_new_voxels;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t voxels_size[1];
-    voxels_size[0] = voxels_dims_current[0] + voxels_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[VOXELS_DATASET], voxels_size);
-
-
-    _open_out_dataspaces[VOXELS_DATASET] = H5Dget_space(_open_out_datasets[VOXELS_DATASET]);
-    // Write all of the voxels to file:
-
-    // Keep track of starting index for a write:
-    size_t starting_index = voxels_dims_current[0];
-
-    for (size_t projection_id = 0; projection_id < _cluster_v.size(); projection_id ++){
-      for (size_t cluster_id = 0; cluster_id < _cluster_v.at(projection_id).size(); cluster_id ++){
-        hsize_t new_voxels_slab_dims[1];
-        hsize_t offset_voxels_slab_dims[1];
-
-        new_voxels_slab_dims[0] = _cluster_v.at(projection_id).as_vector().at(cluster_id).size();
-        offset_voxels_slab_dims[0] = starting_index;
-
-        // std::cout << "[" << projection_id << "][" << cluster_id << "]: \n"
-        //           << "  Offset: " << offset_voxels_slab_dims[0]
-        //           << "\n  starting_index: " << starting_index
-        //           << "\n  N: " << new_voxels_slab_dims[0]
-        //           << "\n  N: " << _cluster_v.at(projection_id).at(cluster_id).size()
-        //           << std::endl;
-
-        // Select as a hyperslab the last section of data for writing:
-        H5Sselect_hyperslab(
-          _open_out_dataspaces[VOXELS_DATASET],
-          H5S_SELECT_SET,
-          offset_voxels_slab_dims, // start
-          NULL ,                   // stride
-          new_voxels_slab_dims,    // count
-          NULL                     // block
-        );
-        // Define memory space:
-        hid_t voxels_memspace = H5Screate_simple(1, new_voxels_slab_dims, NULL);
-
-        // Write the new data
-        H5Dwrite(
-          _open_out_datasets[VOXELS_DATASET],   // dataset_id,
-          _data_types[VOXELS_DATASET],          // hit_t mem_type_id,
-          voxels_memspace,                      // hid_t mem_space_id,
-          _open_out_dataspaces[VOXELS_DATASET], // hid_t file_space_id,
-          xfer_plist_id,                        // hid_t xfer_plist_id,
-          &(_cluster_v.at(projection_id).as_vector().at(cluster_id).as_vector()[0]) // const void * buf
-        );
-        starting_index += new_voxels_slab_dims[0];
+    if (encoding == kVoxelLegacy){
+      for (size_t projection_id = 0; projection_id < _cluster_v.size(); projection_id ++){
+        for (auto & voxel_set : _cluster_v.at(projection_id).as_vector()){
+          append_rows(VOXELS_DATASET, voxel_set.as_vector().data(), voxel_set.size());
+        }
       }
     }
-
-
-
+    else{
+      // Each cluster is encoded on its own, so deltas restart at every cluster:
+      std::vector<unsigned int> ids;
+      std::vector<float> values;
+      for (size_t projection_id = 0; projection_id < _cluster_v.size(); projection_id ++){
+        for (auto & voxel_set : _cluster_v.at(projection_id).as_vector()){
+          Voxel::encode(voxel_set.as_vector().data(), voxel_set.size(), encoding, ids, values);
+        }
+      }
+      append_rows(VOXEL_IDS_DATASET, ids.data(), ids.size());
+      append_rows(VOXEL_VALUES_DATASET, values.data(), values.size());
+    }
 
     return;
 
@@ -763,55 +560,13 @@ namespace larcv3 {
     /////////////////////////////////////////////////////////
 
 
-    // Get a dataspace inside this file:
-    // H5::DataSpace _open_datapaces[EXTENTS_DATASET] = extents_dataset.getSpace();
-
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-    hsize_t extents_offset[1];
-    extents_offset[0] = entry;
+    // From the preloaded index, if there is one:
+    Extents_t input_extents;
+    read_in_extents(EXTENTS_DATASET, entry, 1, &input_extents);
 
     // Transfer property list, default
     hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
 
-    /////////////////////////////////////////////////////////
-    // Read this extents entry from the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // _open_datapaces[EXTENTS_DATASET] = extents_dataset.getSpace();
-
-    H5Sselect_hyperslab(_open_in_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_offset, // start
-      NULL ,  // stride
-      extents_slab_dims, //count
-      NULL // block
-      );
-
-
-    Extents_t input_extents;
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
-    // Write the new data
-    // _open_in_datasets[EXTENTS_DATASET].read(&(input_extents), *_data_types[EXTENTS_DATASET],
-      // extents_memspace, _open_in_dataspaces[EXTENTS_DATASET]);
-
-
-    H5Dread(
-      _open_in_datasets[EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                         // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(input_extents)                       // void * buf  OUT: Buffer to receive data read from file.
-    );
-
     /////////////////////////////////////////////////////////
     // Step 2: Get the projection_extents information
     /////////////////////////////////////////////////////////
@@ -819,45 +574,17 @@ namespace larcv3 {
 
     // Next, open the relevant sections of the data
 
+    _cluster_v.clear();
+
     // If there are no voxels, dont read anything:
     if ( input_extents.n == 0){
+        H5Pclose(xfer_plist_id);
         return;
     }
 
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t projection_extents_slab_dims[1];
-    projection_extents_slab_dims[0] = input_extents.n;
-
-    hsize_t projection_extents_offset[1];
-    projection_extents_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for writing:
-
-    H5Sselect_hyperslab(_open_in_dataspaces[PROJECTION_DATASET],
-      H5S_SELECT_SET,
-      projection_extents_offset,    // start
-      NULL ,                        // stride
-      projection_extents_slab_dims, //count
-      NULL                          // block
-    );
-
-    hid_t projection_extents_memspace = H5Screate_simple(1, projection_extents_slab_dims, NULL);
-
-
-    std::vector<IDExtents_t> projection_extents;
-
-    // Reserve space for reading in projection_extents:
-    projection_extents.resize(input_extents.n);
-
-    H5Dread(
-      _open_in_datasets[PROJECTION_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[PROJECTION_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      projection_extents_memspace,              // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[PROJECTION_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                            // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(projection_extents[0])                  // void * buf  OUT: Buffer to receive data read from file.
-    );
+    std::vector<IDExtents_t> projection_extents(input_extents.n);
+    read_in_set_extents(PROJECTION_DATASET, input_extents.first, input_extents.n, projection_extents.data());
     // std::cout << "voxel_extents.size(): " << voxel_extents.size() << std::endl;
 
 
@@ -867,38 +594,10 @@ namespace larcv3 {
     /////////////////////////////////////////////////////////
 
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = input_extents.n;
-
-    hsize_t image_meta_offset[1];
-    image_meta_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for reading:
-    H5Sselect_hyperslab(_open_in_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_offset,    // start
-      NULL ,                // stride
-      image_meta_slab_dims, //count
-      NULL                  // block
-    );
-
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-    std::vector<ImageMeta<dimension> > image_meta;
-
-    // Reserve space for reading in image_meta:
-    image_meta.resize(input_extents.n);
-
-    H5Dread(
-      _open_in_datasets[IMAGE_META_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[IMAGE_META_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      image_meta_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[IMAGE_META_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                            // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(image_meta[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
-    // std::cout << "image_meta.size(): " << image_meta.size() << std::endl;
+    // From the meta dictionary, if the file has one:
+    std::vector<ImageMeta<dimension> > image_meta(input_extents.n);
+    read_in_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET,
+      input_extents.first, input_extents.n, image_meta.data());
 
     /////////////////////////////////////////////////////////
     // Step 4: Read the cluster_extents
@@ -910,126 +609,115 @@ namespace larcv3 {
     for (size_t projection_id = 0; projection_id < projection_extents.size(); projection_id ++)
       n_total_clusters += projection_extents.at(projection_id).n;
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t cluster_extents_slab_dims[1];
-    cluster_extents_slab_dims[0] = n_total_clusters;
+    std::vector<IDExtents_t> cluster_extents;
 
-    hsize_t cluster_extents_offset[1];
-    cluster_extents_offset[0] = projection_extents.front().first;
+    // Projections without clusters leave nothing to read:
+    if (n_total_clusters > 0){
 
-    // Now, select as a hyperslab the last section of data for reading:
-    H5Sselect_hyperslab(_open_in_dataspaces[CLUSTER_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      cluster_extents_offset,    // start
-      NULL ,                     // stride
-      cluster_extents_slab_dims, //count
-      NULL                       // block
-    );
+      // Create a dimension for the data to add (which is the hyperslab data)
+      hsize_t cluster_extents_slab_dims[1];
+      cluster_extents_slab_dims[0] = n_total_clusters;
 
-    hid_t cluster_extents_memspace = H5Screate_simple(1, cluster_extents_slab_dims, NULL);
+      hsize_t cluster_extents_offset[1];
+      cluster_extents_offset[0] = projection_extents.front().first;
 
-    std::vector<IDExtents_t> cluster_extents;
+      // Now, select as a hyperslab the last section of data for reading:
+      H5Sselect_hyperslab(_open_in_dataspaces[CLUSTER_EXTENTS_DATASET],
+        H5S_SELECT_SET,
+        cluster_extents_offset,    // start
+        NULL ,                     // stride
+        cluster_extents_slab_dims, //count
+        NULL                       // block
+      );
 
-    // Reserve space for reading in cluster_extents:
-    cluster_extents.resize(n_total_clusters);
+      hid_t cluster_extents_memspace = H5Screate_simple(1, cluster_extents_slab_dims, NULL);
 
-    H5Dread(
-      _open_in_datasets[CLUSTER_EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[CLUSTER_EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      cluster_extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[CLUSTER_EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                                 // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(cluster_extents[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
-    // std::cout << "voxel_extents.size(): " << voxel_extents.size() << std::endl;
+      // Reserve space for reading in cluster_extents:
+      cluster_extents.resize(n_total_clusters);
+
+      H5Dread(
+        _open_in_datasets[CLUSTER_EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
+        _data_types[CLUSTER_EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
+        cluster_extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
+        _open_in_dataspaces[CLUSTER_EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
+        xfer_plist_id,                                 // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
+        &(cluster_extents[0])                          // void * buf  OUT: Buffer to receive data read from file.
+      );
+
+      H5Sclose(cluster_extents_memspace);
+    }
 
 
     /////////////////////////////////////////////////////////
     // Step 5: Read the voxels
     /////////////////////////////////////////////////////////
 
+    // The voxels of every cluster of every projection in this event are stored
+    // contiguously, so they are read with a single hyperslab:
+
+    std::vector<larcv3::Voxel> voxels;
+
+    read_voxels(sparse_cluster_voxels, cluster_extents, xfer_plist_id, voxels);
+
+    /////////////////////////////////////////////////////////
+    // Step 6: Split the voxels into projections and clusters
+    /////////////////////////////////////////////////////////
+
     // At this point, we know the following:
     // - How many projections there are (image_meta.size())
     // - How many total clusters there are (cluster_extents.size())
     //
-    // To make things useful, we untangle the the clusters per projection
+    // To make things useful, we untangle the the clusters per projection.
+    // Each cluster copies its slice of the buffer in one go, into exactly
+    // the capacity it needs.
 
-    _cluster_v.clear();
     _cluster_v.resize(image_meta.size());
 
-    size_t offset = cluster_extents.front().first;
-
+    size_t offset = 0;
     size_t i_flat_cluster_index = 0;
     for (size_t projection_id = 0; projection_id < projection_extents.size(); projection_id ++){
-      // Set the meta for this projection id:
-      _cluster_v.at(projection_id).meta(image_meta.at(projection_id));
+
+      auto & cluster = _cluster_v.at(projection_id);
+
+      // Set the meta for this projection id, while it has no voxels to check:
+      cluster.meta(image_meta.at(projection_id));
 
       // Make space for clusters:
-      _cluster_v.at(projection_id).resize(projection_extents.at(projection_id).n);
+      cluster.resize(projection_extents.at(projection_id).n);
 
       for (size_t cluster_id = 0; cluster_id < projection_extents.at(projection_id).n; cluster_id ++){
 
-
         // What cluster is this?
-        IDExtents_t this_cluster_extent = cluster_extents.at(i_flat_cluster_index);
-
-        // Create a dimension for the data to add (which is the hyperslab data)
-        hsize_t voxels_slab_dims[1];
-        voxels_slab_dims[0] = this_cluster_extent.n;
-
-        hsize_t voxels_offset[1];
-        voxels_offset[0] = offset;
-
-        // std::cout << "N: " << voxels_slab_dims[0] << "\n"
-        //           << "offset: " << voxels_offset[0] << "\n"
-        //           << std::endl;
-        // Now, select as a hyperslab the last section of data for readomg:
-        H5Sselect_hyperslab(_open_in_dataspaces[VOXELS_DATASET],
-          H5S_SELECT_SET,
-          voxels_offset,    // start
-          NULL ,            // stride
-          voxels_slab_dims, // count
-          NULL              // block
-        );
-
-        hid_t voxels_memspace = H5Screate_simple(1, voxels_slab_dims, NULL);
-
-        //// TODO
-        // This implementation is not ideal.
-        // It copies from disk, then is copying into a vector
-
-        std::vector<larcv3::Voxel> temp_voxel_vector;
-        temp_voxel_vector.resize(voxels_slab_dims[0]);
-
-        // Reserve space for reading in voxels:
-
-        H5Dread(
-          _open_in_datasets[VOXELS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-          _data_types[VOXELS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-          voxels_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-          _open_in_dataspaces[VOXELS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-          xfer_plist_id,                        // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-          &(temp_voxel_vector[0])               // void * buf  OUT: Buffer to receive data read from file.
-        );
-        // std::cout << "temp_voxel_vector.size(): " << temp_voxel_vector.size() << std::endl;
-
-
-        for (auto & v : temp_voxel_vector){
-          // if (v.id() >= _cluster_v.at(projection_id).meta().total_voxels()) continue;
-          _cluster_v.at(projection_id).writeable_voxel_set(cluster_id).add(v);
+        const IDExtents_t & this_cluster_extent = cluster_extents.at(i_flat_cluster_index);
+        size_t n = this_cluster_extent.n;
+
+        auto & voxel_set = cluster.writeable_voxel_set(cluster_id);
+
+        // A single cluster can take the read buffer without a copy:
+        if (cluster_extents.size() == 1)
+          voxel_set.assign(std::move(voxels), _trust_ordering);
+        else if (n > 0)
+          voxel_set.assign(voxels.data() + offset, voxels.data() + offset + n, _trust_ordering);
+
+        if (_trust_ordering && _validate_ordering && !voxel_set.is_sorted()){
+          LARCV_SWARNING() << "Voxels of cluster " << cluster_id << " in projection " << projection_id
+                           << " of entry " << entry << " are not sorted on disk, sorting." << std::endl;
+          voxel_set.sort();
         }
-        _cluster_v.at(projection_id).writeable_voxel_set(cluster_id).id(this_cluster_extent.id);
-        // std::cout << "_cluster_v.at(projection_id).at(cluster_id).size(): " << _cluster_v.at(projection_id).at(cluster_id).size() << std::endl;
-        offset += voxels_slab_dims[0];
+
+        voxel_set.id(this_cluster_extent.id);
+
+        offset += n;
         i_flat_cluster_index += 1;
       }
     }
 
+    H5Pclose(xfer_plist_id);
+
     return;
 
   }
 
-
 template class EventSparseCluster<2>;
 template class EventSparseCluster<3>;
 }
@@ -1063,6 +751,10 @@ void init_eventsparse_cluster_base(pybind11::module m){
   ev_sparse_cluster.def("size",               &Class::size);
   ev_sparse_cluster.def("clear",              &Class::clear);
   ev_sparse_cluster.def("sparse_cluster",     &Class::sparse_cluster);
+  ev_sparse_cluster.def("trust_ordering",     (void (Class::*)(bool))(&Class::trust_ordering));
+  ev_sparse_cluster.def("trust_ordering",     (bool (Class::*)() const)(&Class::trust_ordering));
+  ev_sparse_cluster.def("validate_ordering",  (void (Class::*)(bool))(&Class::validate_ordering));
+  ev_sparse_cluster.def("validate_ordering",  (bool (Class::*)() const)(&Class::validate_ordering));
 
 /*
 
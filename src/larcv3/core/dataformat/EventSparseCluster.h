@@ -69,7 +69,22 @@ namespace larcv3 {
     void serialize  (hid_t group);
     void deserialize(hid_t group, size_t entry, bool reopen_groups=false);
     void finalize   ();
+    void swap_data(EventBase & other)
+    { _cluster_v.swap(static_cast<EventSparseCluster<dimension>&>(other)._cluster_v); }
+    void copy_settings(const EventBase & other)
+    {
+      EventBase::copy_settings(other);
+      auto const & product = static_cast<const EventSparseCluster<dimension>&>(other);
+      _trust_ordering    = product._trust_ordering;
+      _validate_ordering = product._validate_ordering;
+    }
 
+    /// If true (default), voxels on disk are assumed sorted by id and are read in as-is
+    inline void trust_ordering(bool trust) { _trust_ordering = trust; }
+    inline bool trust_ordering() const { return _trust_ordering; }
+    /// If true, trusted voxels are checked after reading and re-sorted if out of order
+    inline void validate_ordering(bool validate) { _validate_ordering = validate; }
+    inline bool validate_ordering() const { return _validate_ordering; }
 
     static EventSparseCluster * to_sparse_cluster(EventBase * e){
       return (EventSparseCluster *) e;
@@ -78,7 +93,13 @@ namespace larcv3 {
   private:
     void open_in_datasets(hid_t group);
     void open_out_datasets(hid_t group);
+    /// Create the voxels dataset, if it waits for the first flush (see serialize)
+    void prepare_flush(bool final);
     std::vector<larcv3::SparseCluster<dimension> > _cluster_v;
+    uint _compression;
+
+    bool _trust_ordering;
+    bool _validate_ordering;
 
   };
 
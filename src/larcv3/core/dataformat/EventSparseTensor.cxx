@@ -4,14 +4,16 @@
 #define VOXEL_EXTENTS_CHUNK_SIZE 10
 #define VOXEL_IDEXTENTS_CHUNK_SIZE 100
 #define VOXEL_META_CHUNK_SIZE 100
-#define VOXEL_DATA_CHUNK_SIZE 1000
 #define IMAGE_META_CHUNK_SIZE 100
 
 #define EXTENTS_DATASET 0
 #define VOXEL_EXTENTS_DATASET 1
 #define IMAGE_META_DATASET 2
 #define VOXELS_DATASET 3
-#define N_DATASETS 4
+#define VOXEL_IDS_DATASET 4
+#define VOXEL_VALUES_DATASET 5
+#define IMAGE_META_INDEX_DATASET 6
+#define N_DATASETS 7
 
 #include "larcv3/core/dataformat/EventSparseTensor.h"
 
@@ -22,9 +24,16 @@ namespace larcv3 {
   static EventSparseTensorFactory<2> __global_EventSparseTensor2DFactory__;
   static EventSparseTensorFactory<3> __global_EventSparseTensor3DFactory__;
 
+  /// Datasets holding the voxels, in each encoding
+  static const EventBase::VoxelDatasets sparse_tensor_voxels = {VOXELS_DATASET, VOXEL_IDS_DATASET, VOXEL_VALUES_DATASET};
+
 
   template<size_t dimension>
-  EventSparseTensor<dimension>::EventSparseTensor(){
+  EventSparseTensor<dimension>::EventSparseTensor() :
+    _compression(0),
+    _trust_ordering(true),
+    _validate_ordering(false)
+  {
 
     _data_types.resize(N_DATASETS);
 
@@ -32,6 +41,9 @@ namespace larcv3 {
     _data_types[VOXEL_EXTENTS_DATASET] = larcv3::get_datatype<IDExtents_t>();
     _data_types[IMAGE_META_DATASET]    = larcv3::ImageMeta<dimension>::get_datatype();
     _data_types[VOXELS_DATASET]        = larcv3::Voxel::get_datatype();
+    _data_types[VOXEL_IDS_DATASET]     = larcv3::get_datatype<unsigned int>();
+    _data_types[VOXEL_VALUES_DATASET]  = larcv3::get_datatype<float>();
+    _data_types[IMAGE_META_INDEX_DATASET] = larcv3::get_datatype<unsigned int>();
 
 
   }
@@ -95,8 +107,9 @@ namespace larcv3 {
     // Initialization creates 4 tables for a set of voxels:
     // Extents (Traditional extents, but maps to the next table)
     // VoxelExtents (Extents but with an ID for each entry)
-    // VoxelMeta (ImageMeta that is specific to a projection)
-    // Voxels (A big table of voxels.)
+    // VoxelMeta (ImageMeta that is specific to a projection, or with a meta dictionary
+    //   each distinct one once and the index of each projection's in the dictionary)
+    // Voxels (A big table of voxels, or with a compact encoding separate id and value columns.)
 
 
     /////////////////////////////////////////////////////////
@@ -123,7 +136,7 @@ namespace larcv3 {
      */
     hid_t extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList extents_cparms;
-    hsize_t      extents_chunk_dims[1] ={VOXEL_EXTENTS_CHUNK_SIZE};
+    hsize_t      extents_chunk_dims[1] ={index_chunk_size(VOXEL_EXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(extents_cparms, 1, extents_chunk_dims );
     if (compression){
       H5Pset_deflate(extents_cparms, compression);
@@ -166,7 +179,7 @@ namespace larcv3 {
      */
     hid_t id_extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList id_extents_cparms;
-    hsize_t      id_extents_chunk_dims[1] ={VOXEL_IDEXTENTS_CHUNK_SIZE};
+    hsize_t      id_extents_chunk_dims[1] ={index_chunk_size(VOXEL_IDEXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(id_extents_cparms, 1, id_extents_chunk_dims );
     if (compression){
       H5Pset_deflate(id_extents_cparms, compression);
@@ -204,17 +217,17 @@ namespace larcv3 {
      */
     hid_t image_meta_cparms = H5Pcreate( H5P_DATASET_CREATE );
     // H5::DSetCreatPropList image_meta_cparms;
-    hsize_t      image_meta_chunk_dims[1] ={IMAGE_META_CHUNK_SIZE};
+    hsize_t      image_meta_chunk_dims[1] ={index_chunk_size(IMAGE_META_CHUNK_SIZE)};
     H5Pset_chunk(image_meta_cparms, 1, image_meta_chunk_dims );
     if (compression){
       H5Pset_deflate(image_meta_cparms, compression);
     }
 
 
-    // Create the extents dataset:
+    // Create the meta dataset, or the dictionary of metas:
     H5Dcreate(
       group,                           // hid_t loc_id  IN: Location identifier
-      "image_meta",                    // const char *name      IN: Dataset name
+      _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", // const char *name      IN: Dataset name
       _data_types[IMAGE_META_DATASET], // hid_t dtype_id  IN: Datatype identifier
       image_meta_dataspace,            // hid_t space_id  IN: Dataspace identifier
       lcpl,                            // hid_t lcpl_id IN: Link creation property list
@@ -223,45 +236,16 @@ namespace larcv3 {
     );
 
 
-    /////////////////////////////////////////////////////////
-    // Create the voxels dataset (Voxels)
-    /////////////////////////////////////////////////////////
-
-    // Get the data type for extents:
-    // H5::DataType voxel_datatype = larcv3::Voxel::get_datatype();
-
-
-    // Get the starting size (0) and dimensions (unlimited)
-    hsize_t voxel_starting_dim[] = {0};
-    hsize_t voxel_maxsize_dim[]  = {H5S_UNLIMITED};
-
-    // Create a dataspace
-    hid_t voxel_dataspace = H5Screate_simple(1, voxel_starting_dim, voxel_maxsize_dim);
-
-    /*
-     * Modify dataset creation properties, i.e. enable chunking.
-     */
-
-
-    hid_t voxel_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    // H5::DSetCreatPropList voxel_cparms;
-    hsize_t      voxel_chunk_dims[1] ={VOXEL_DATA_CHUNK_SIZE};
-    H5Pset_chunk(voxel_cparms, 1, voxel_chunk_dims );
-    if (compression){
-      H5Pset_deflate(voxel_cparms, compression);
-    }
+    if (_storage.meta_dictionary)
+      create_chunked_dataset(group, "image_meta_index", _data_types[IMAGE_META_INDEX_DATASET],
+        index_chunk_size(IMAGE_META_CHUNK_SIZE), compression);
 
+    _compression = compression;
 
-    // Create the extents dataset:
-    H5Dcreate(
-      group,                       // hid_t loc_id  IN: Location identifier
-      "voxels",                    // const char *name      IN: Dataset name
-      _data_types[VOXELS_DATASET], // hid_t dtype_id  IN: Datatype identifier
-      voxel_dataspace,             // hid_t space_id  IN: Dataspace identifier
-      lcpl,                        // hid_t lcpl_id IN: Link creation property list
-      voxel_cparms,                // hid_t dcpl_id IN: Dataset creation property list
-      dapl                         // hid_t dapl_id IN: Dataset access property list
-    );
+    // Without a configured chunk size, the voxels dataset is created once enough
+    // events are buffered to size its chunks from:
+    if (_storage.data_chunk_size)
+      create_voxels_datasets(group, sparse_tensor_voxels, _storage.data_chunk_size, _compression);
   }
 
   template<size_t dimension>
@@ -272,18 +256,32 @@ namespace larcv3 {
        _open_in_dataspaces.resize(N_DATASETS);
 
 
-       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group, "extents", H5P_DEFAULT);
+       hid_t dapl = dataset_access_plist();
+
+       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group, "extents", dapl);
        _open_in_dataspaces[EXTENTS_DATASET]       = H5Dget_space(_open_in_datasets[EXTENTS_DATASET]);
 
-       _open_in_datasets[VOXEL_EXTENTS_DATASET]   = H5Dopen(group, "voxel_extents", H5P_DEFAULT);
+       _open_in_datasets[VOXEL_EXTENTS_DATASET]   = H5Dopen(group, "voxel_extents", dapl);
        _open_in_dataspaces[VOXEL_EXTENTS_DATASET] = H5Dget_space(_open_in_datasets[VOXEL_EXTENTS_DATASET]);
 
-       _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group, "image_meta", H5P_DEFAULT);
+       // Files written with a meta dictionary have an index into it instead of a meta table:
+       _open_in_datasets[IMAGE_META_INDEX_DATASET]  = H5I_INVALID_HID;
+       if (H5Lexists(group, "image_meta_index", H5P_DEFAULT) > 0){
+         _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group, "image_meta_dictionary", dapl);
+         _open_in_datasets[IMAGE_META_INDEX_DATASET]= H5Dopen(group, "image_meta_index", dapl);
+         _open_in_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_in_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+       else{
+         _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group, "image_meta", dapl);
+       }
        _open_in_dataspaces[IMAGE_META_DATASET]    = H5Dget_space(_open_in_datasets[IMAGE_META_DATASET]);
 
-       _open_in_datasets[VOXELS_DATASET]          = H5Dopen(group, "voxels", H5P_DEFAULT);
-       _open_in_dataspaces[VOXELS_DATASET]        = H5Dget_space(_open_in_datasets[VOXELS_DATASET]);
-;
+       open_in_voxels_datasets(group, sparse_tensor_voxels, dapl);
+
+       H5Pclose(dapl);
+
+       load_in_index(EXTENTS_DATASET, VOXEL_EXTENTS_DATASET, IMAGE_META_INDEX_DATASET);
+       load_in_dictionary(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET);
      }
 
     return;
@@ -302,26 +300,40 @@ namespace larcv3 {
        _open_out_datasets[VOXEL_EXTENTS_DATASET]   = H5Dopen(group,"voxel_extents", H5P_DEFAULT);
        _open_out_dataspaces[VOXEL_EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[VOXEL_EXTENTS_DATASET]);
 
-       _open_out_datasets[IMAGE_META_DATASET]      = H5Dopen(group,"image_meta", H5P_DEFAULT);
+       _open_out_datasets[IMAGE_META_DATASET]      = H5Dopen(group,
+         _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", H5P_DEFAULT);
        _open_out_dataspaces[IMAGE_META_DATASET]    = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
 
-       _open_out_datasets[VOXELS_DATASET]          = H5Dopen(group,"voxels", H5P_DEFAULT);
-       _open_out_dataspaces[VOXELS_DATASET]        = H5Dget_space(_open_out_datasets[VOXELS_DATASET]);
+       _open_out_datasets[IMAGE_META_INDEX_DATASET]   = H5I_INVALID_HID;
+       if (_storage.meta_dictionary){
+         _open_out_datasets[IMAGE_META_INDEX_DATASET] = H5Dopen(group,"image_meta_index", H5P_DEFAULT);
+         _open_out_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+
+       open_out_voxels_datasets(group, sparse_tensor_voxels);
     }
 
     return;
   }
 
+  template<size_t dimension>
+  void EventSparseTensor<dimension>::prepare_flush(bool final){
+    prepare_voxels_flush(sparse_tensor_voxels, EXTENTS_DATASET, _compression, final);
+  }
+
   template<size_t dimension>
   void EventSparseTensor<dimension>::finalize(){
     for (size_t i = 0; i < _open_in_datasets.size(); i ++){
+      if (_open_in_datasets[i] < 0) continue;
       H5Sclose(_open_in_dataspaces[i]);
       H5Dclose(_open_in_datasets[i]);
     }
     for (size_t i = 0; i < _open_out_datasets.size(); i ++){
-      H5Sclose(_open_in_dataspaces[i]);
+      if (_open_out_datasets[i] < 0) continue;
+      H5Sclose(_open_out_dataspaces[i]);
       H5Dclose(_open_out_datasets[i]);
     }
+    _out_voxels_group = H5I_INVALID_HID;
   }
 
   template<size_t dimension>
@@ -342,10 +354,19 @@ namespace larcv3 {
     // 3) Using the dimensions of the voxel_extents table, and the dimensions of this event's voxel_extents,
     //    update the extents table
     // 4) Update the voxel_extents table with the voxel_extents vector for this object.
-    // 5) Update the image_meta table with the meta vector for this object.
+    // 5) Update the image_meta table with the meta vector for this object (or the
+    //    dictionary with the new metas, and the index with the dictionary row of each)
     // 6) Update the voxels table with the voxels from this event, using the voxel_extents vector
+    //
+    // The rows are appended to the output buffers of EventBase, and reach the
+    // file when the IOManager flushes them.  The current dimensions include
+    // rows that are still buffered.
 
-    hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+    VoxelEncoding_t encoding = _storage.voxel_encoding;
+
+    // Without a configured chunk size, the voxels dataset doesn't exist until a flush
+    // sizes its chunks from the mean of the events buffered by then (see prepare_flush):
+    if (H5Lexists(group, Voxel::dataset_name(encoding), H5P_DEFAULT) <= 0) _out_voxels_group = group;
 
     open_out_datasets(group);
 
@@ -353,25 +374,8 @@ namespace larcv3 {
     // Step 1: Get the current dataset dimensions
     /////////////////////////////////////////////////////////
 
-    // Get the dataset current size
-    hsize_t extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[EXTENTS_DATASET], extents_dims_current, NULL);
-
-    // Get the dataset current size
-    hsize_t voxel_extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[VOXEL_EXTENTS_DATASET], voxel_extents_dims_current, NULL);
-
-    // Get the dataset current size
-    hsize_t image_meta_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[IMAGE_META_DATASET], image_meta_dims_current, NULL);
-
-    // Get the dataset current size
-    hsize_t voxels_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[VOXELS_DATASET], voxels_dims_current, NULL);
-    // std::cout << "Current extents size: " << extents_dims_current[0] << std::endl;
-    // std::cout << "Current voxel_extents size: " << voxel_extents_dims_current[0] << std::endl;
-    // std::cout << "Current voxels size: " << voxels_dims_current[0] << std::endl;
-
+    hsize_t voxel_extents_dims_current = out_size(VOXEL_EXTENTS_DATASET);
+    hsize_t voxels_dims_current        = out_size(encoding == kVoxelLegacy ? VOXELS_DATASET : VOXEL_IDS_DATASET);
 
 
     /////////////////////////////////////////////////////////
@@ -381,8 +385,7 @@ namespace larcv3 {
     // We need to make the voxel extents object first, which we can do from the vector of voxels.
     std::vector<IDExtents_t> voxel_extents;
 
-    size_t last_voxel_index = voxels_dims_current[0];
-    size_t n_new_voxels = 0;
+    size_t last_voxel_index = voxels_dims_current;
 
     for (size_t projection_id = 0; projection_id < _tensor_v.size(); projection_id ++){
       voxel_extents.resize(voxel_extents.size() + 1);
@@ -390,14 +393,8 @@ namespace larcv3 {
       voxel_extents.back().id    = _tensor_v.at(projection_id).meta().projection_id();
       voxel_extents.back().first = last_voxel_index;
       last_voxel_index += voxel_extents.back().n;
-      n_new_voxels += voxel_extents.back().n;
     }
 
-    // std::cout << "Voxel Extents Size: " << voxel_extents.size() << std::endl;
-    // for (auto & e : voxel_extents){
-    //   std::cout << "  n: " << e.n << std::endl;
-    // }
-
 
     /////////////////////////////////////////////////////////
     // Step 2a: Build the image_meta object
@@ -414,203 +411,51 @@ namespace larcv3 {
     // Step 3: Update the overall extents table
     /////////////////////////////////////////////////////////
 
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t extents_size[1];
-    extents_size[0] = extents_dims_current[0] + extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[EXTENTS_DATASET], extents_size);
-
-    // Create an extents object to go into the extents table:
-
     Extents_t next_extents;
-    next_extents.first = voxel_extents_dims_current[0];
+    next_extents.first = voxel_extents_dims_current;
     next_extents.n = voxel_extents.size();
 
-    /////////////////////////////////////////////////////////
-    // Write the new extents entry to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[EXTENTS_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_dims_current, // start
-      NULL ,                // stride
-      extents_slab_dims,    // count
-      NULL                  // block
-    );
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[EXTENTS_DATASET],   // dataset_id,
-             _data_types[EXTENTS_DATASET],          // hit_t mem_type_id,
-             extents_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[EXTENTS_DATASET], //hid_t file_space_id,
-             xfer_plist_id,                         //hid_t xfer_plist_id,
-             &(next_extents)                        // const void * buf
-           );
+    append_rows(EXTENTS_DATASET, &next_extents, 1);
 
 
     /////////////////////////////////////////////////////////
     // Step 4: Update the voxel extents table
     /////////////////////////////////////////////////////////
 
+    append_rows(VOXEL_EXTENTS_DATASET, voxel_extents.data(), voxel_extents.size());
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t voxel_extents_slab_dims[1];
-    voxel_extents_slab_dims[0] = voxel_extents.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t voxel_extents_size[1];
-    voxel_extents_size[0] = voxel_extents_dims_current[0] + voxel_extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[VOXEL_EXTENTS_DATASET], voxel_extents_size);
-
-
-    /////////////////////////////////////////////////////////
-    // Write the new voxel_extents to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[VOXEL_EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[VOXEL_EXTENTS_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[VOXEL_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      voxel_extents_dims_current, // start
-      NULL ,                      // stride
-      voxel_extents_slab_dims,    // count
-      NULL                        // block
-    );
-
-    // Define memory space:
-    hid_t voxel_extents_memspace = H5Screate_simple(1, voxel_extents_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[VOXEL_EXTENTS_DATASET],   // dataset_id,
-             _data_types[VOXEL_EXTENTS_DATASET],          // hit_t mem_type_id,
-             voxel_extents_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[VOXEL_EXTENTS_DATASET], // hid_t file_space_id,
-             xfer_plist_id,                               // hid_t xfer_plist_id,
-             &(voxel_extents[0])                          // const void * buf
-           );
 
     /////////////////////////////////////////////////////////
     // Step 5: Write image meta
     /////////////////////////////////////////////////////////
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = image_meta.size();
+    if (_storage.meta_dictionary)
+      append_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET, image_meta.data(), image_meta.size());
+    else
+      append_rows(IMAGE_META_DATASET, image_meta.data(), image_meta.size());
 
 
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t image_meta_size[1];
-    image_meta_size[0] = image_meta_dims_current[0] + image_meta_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[IMAGE_META_DATASET], image_meta_size);
-
-
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[IMAGE_META_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
-    H5Sselect_hyperslab(_open_out_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_dims_current, // start
-      NULL ,                   // stride
-      image_meta_slab_dims,    // count
-      NULL                     // block
-    );
-
-    // Define memory space:
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-    // Write the new data
-
-    H5Dwrite(_open_out_datasets[IMAGE_META_DATASET],   // dataset_id,
-             _data_types[IMAGE_META_DATASET],          // hit_t mem_type_id,
-             image_meta_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[IMAGE_META_DATASET], // hid_t file_space_id,
-             xfer_plist_id,                            // hid_t xfer_plist_id,
-             &(image_meta[0])                          // const void * buf
-           );
-
     /////////////////////////////////////////////////////////
     // Step 6: Write new voxels
     /////////////////////////////////////////////////////////
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t voxels_slab_dims[1];
-    voxels_slab_dims[0] = n_new_voxels;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t voxels_size[1];
-    voxels_size[0] = voxels_dims_current[0] + voxels_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[VOXELS_DATASET], voxels_size);
-    _open_out_dataspaces[VOXELS_DATASET] = H5Dget_space(_open_out_datasets[VOXELS_DATASET]);
-
-    // Write all of the voxels to file:
-
-    // Keep track of starting index for a write:
-    size_t starting_index = voxels_dims_current[0];
-
-    for (size_t projection_id = 0; projection_id < _tensor_v.size(); projection_id ++){
-
-        hsize_t new_voxels_slab_dims[1];
-        hsize_t offset_voxels_slab_dims[1];
-
-        new_voxels_slab_dims[0] = _tensor_v.at(projection_id).size();
-        offset_voxels_slab_dims[0] = starting_index;
-
-        // std::cout << "[" << projection_id << "][" << cluster_id << "]: \n"
-        //           << "  Offset: " << offset_voxels_slab_dims[0]
-        //           << "\n  starting_index: " << starting_index
-        //           << "\n  N: " << new_voxels_slab_dims[0]
-        //           << "\n  N: " << _tensor_v.at(projection_id).at(cluster_id).size()
-        //           << std::endl;
-
-        // Select as a hyperslab the last section of data for writing:
-        H5Sselect_hyperslab(_open_out_dataspaces[VOXELS_DATASET],
-          H5S_SELECT_SET,
-          offset_voxels_slab_dims, // start
-          NULL ,                   // stride
-          new_voxels_slab_dims,    // count
-          NULL                     // block
-        );
-
-        // Define memory space:
-        hid_t voxels_memspace = H5Screate_simple(1, new_voxels_slab_dims, NULL);
-
-
-        // Write the new data
-        H5Dwrite(_open_out_datasets[VOXELS_DATASET],   // dataset_id,
-                 _data_types[VOXELS_DATASET],          // hit_t mem_type_id,
-                 voxels_memspace,                      // hid_t mem_space_id,
-                 _open_out_dataspaces[VOXELS_DATASET], // hid_t file_space_id,
-                 xfer_plist_id,                        // hid_t xfer_plist_id,
-                 &(_tensor_v.at(projection_id).as_vector()[0]) // const void * buf
-               );
-
-
-        starting_index += new_voxels_slab_dims[0];
+    if (encoding == kVoxelLegacy){
+      for (size_t projection_id = 0; projection_id < _tensor_v.size(); projection_id ++){
+        const auto & voxels = _tensor_v.at(projection_id).as_vector();
+        append_rows(VOXELS_DATASET, voxels.data(), voxels.size());
+      }
+    }
+    else{
+      // Each projection is encoded on its own, so deltas restart at every projection:
+      std::vector<unsigned int> ids;
+      std::vector<float> values;
+      for (size_t projection_id = 0; projection_id < _tensor_v.size(); projection_id ++){
+        const auto & voxels = _tensor_v.at(projection_id).as_vector();
+        Voxel::encode(voxels.data(), voxels.size(), encoding, ids, values);
+      }
+      append_rows(VOXEL_IDS_DATASET, ids.data(), ids.size());
+      append_rows(VOXEL_VALUES_DATASET, values.data(), values.size());
     }
-
-
-
 
     return;
 
@@ -639,46 +484,10 @@ namespace larcv3 {
     // Step 1: Get the extents information from extents dataset
     /////////////////////////////////////////////////////////
 
-    // H5::DataSet * extents_dataset = &(_open_datasets[EXTENTS_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace extents_dataspace = extents_dataset->getSpace();
-
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-    hsize_t extents_offset[1];
-    extents_offset[0] = entry;
-
-    /////////////////////////////////////////////////////////
-    // Read this extents entry from the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset->getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_offset,    // start
-      NULL ,             // stride
-      extents_slab_dims, //count
-      NULL               // block
-    );
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
+    // From the preloaded index, if there is one:
     Extents_t input_extents;
-    // Read the new data
-    H5Dread(
-      _open_in_datasets[EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                         // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(input_extents)                       // void * buf  OUT: Buffer to receive data read from file.
-    );
+    read_in_extents(EXTENTS_DATASET, entry, 1, &input_extents);
+
     /////////////////////////////////////////////////////////
     // Step 2: Get the voxel_extents information
     /////////////////////////////////////////////////////////
@@ -688,46 +497,13 @@ namespace larcv3 {
 
     // If there are no voxels, dont read anything:
     if ( input_extents.n == 0){
+        _tensor_v.clear();
+        H5Pclose(xfer_plist_id);
         return;
     }
 
-    // H5::DataSet * voxel_extents_dataset = &(_open_in_datasets[VOXEL_EXTENTS_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace voxel_extents_dataspace = voxel_extents_dataset->getSpace();
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t voxel_extents_slab_dims[1];
-    voxel_extents_slab_dims[0] = input_extents.n;
-
-    hsize_t voxel_extents_offset[1];
-    voxel_extents_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset.getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[VOXEL_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      voxel_extents_offset,    // start
-      NULL ,                   // stride
-      voxel_extents_slab_dims, // count
-      NULL                     // block
-    );
-
-    hid_t voxel_extents_memspace = H5Screate_simple(1, voxel_extents_slab_dims, NULL);
-
-    std::vector<IDExtents_t> voxel_extents;
-
-    // Reserve space for reading in voxel_extents:
-    voxel_extents.resize(input_extents.n);
-
-    H5Dread(
-      _open_in_datasets[VOXEL_EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[VOXEL_EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      voxel_extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[VOXEL_EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                               // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(voxel_extents[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
+    std::vector<IDExtents_t> voxel_extents(input_extents.n);
+    read_in_set_extents(VOXEL_EXTENTS_DATASET, input_extents.first, input_extents.n, voxel_extents.data());
     // std::cout << "voxel_extents.size(): " << voxel_extents.size() << std::endl;
 
 
@@ -736,129 +512,127 @@ namespace larcv3 {
     // Step 3: Get the image_meta information
     /////////////////////////////////////////////////////////
 
-    // H5::DataSet * image_meta_dataset = &(_open_in_datasets[IMAGE_META_DATASET]);
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace image_meta_dataspace = image_meta_dataset->getSpace();
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = input_extents.n;
-
-    hsize_t image_meta_offset[1];
-    image_meta_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset.getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_offset,    // start
-      NULL ,                // stride
-      image_meta_slab_dims, // count
-      NULL                  // block
-    );
-
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-    std::vector<larcv3::ImageMeta<dimension> > image_meta;
-
-    // Reserve space for reading in image_meta:
-    image_meta.resize(input_extents.n);
-
-    H5Dread(
-      _open_in_datasets[IMAGE_META_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[IMAGE_META_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      image_meta_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[IMAGE_META_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                            // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(image_meta[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
-    // std::cout << "image_meta.size(): " << image_meta.size() << std::endl;
+    // From the meta dictionary, if the file has one:
+    std::vector<larcv3::ImageMeta<dimension> > image_meta(input_extents.n);
+    read_in_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET,
+      input_extents.first, input_extents.n, image_meta.data());
 
 
     /////////////////////////////////////////////////////////
     // Step 4: Read the voxels
     /////////////////////////////////////////////////////////
 
+    // The voxels of every projection in this event are stored contiguously,
+    // so they are read with a single hyperslab and then split by voxel_extents.
+
     _tensor_v.clear();
     _tensor_v.resize(image_meta.size());
 
-    size_t offset = voxel_extents.front().first;
-
-    for (size_t voxel_set_index = 0; voxel_set_index < voxel_extents.size(); voxel_set_index ++){
-
-
-      // // Make sure there is room for this:
-      // if(_tensor_v.at(voxel_set_index).size() <= cluster_id){
-      //   _tensor_v.at(voxel_set_index).as_vector().resize(cluster_id + 1);
-      // }
-
-      // Get the dataset for reading:
-      // H5::DataSet * voxels_dataset = &(_open_in_datasets[VOXELS_DATASET]);
-
-      // Get a dataspace inside this file:
-      // H5::DataSpace voxels_dataspace = voxels_dataset->getSpace();
+    std::vector<larcv3::Voxel> voxels;
 
-      // Create a dimension for the data to add (which is the hyperslab data)
-      hsize_t voxels_slab_dims[1];
-      voxels_slab_dims[0] = voxel_extents.at(voxel_set_index).n;
+    read_voxels(sparse_tensor_voxels, voxel_extents, xfer_plist_id, voxels);
 
-      hsize_t voxels_offset[1];
-      voxels_offset[0] = offset;
-
-      // std::cout << "N: " << voxels_slab_dims[0] << "\n"
-      //           << "offset: " << voxels_offset[0] << "\n"
-      //           << std::endl;
-      // Now, select as a hyperslab the last section of data for readomg:
-      H5Sselect_hyperslab(_open_in_dataspaces[VOXELS_DATASET],
-        H5S_SELECT_SET,
-        voxels_offset,    // start
-        NULL ,            // stride
-        voxels_slab_dims, // count
-        NULL              // block
-      );
-
-      hid_t voxels_memspace = H5Screate_simple(1, voxels_slab_dims, NULL);
-
-      //// TODO
-      // This implementation is not ideal.
-      // It copies from disk, then is copying into a vector
+    /////////////////////////////////////////////////////////
+    // Step 5: Split the voxels into each projection
+    /////////////////////////////////////////////////////////
 
-      std::vector<larcv3::Voxel> temp_voxel_vector;
-      temp_voxel_vector.resize(voxels_slab_dims[0]);
+    size_t offset = 0;
+    for (size_t voxel_set_index = 0; voxel_set_index < voxel_extents.size(); voxel_set_index ++){
 
-      // Reserve space for reading in voxels:
+      auto & tensor = _tensor_v.at(voxel_set_index);
+      size_t n = voxel_extents.at(voxel_set_index).n;
 
-      H5Dread(
-        _open_in_datasets[VOXELS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-        _data_types[VOXELS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-        voxels_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-        _open_in_dataspaces[VOXELS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-        xfer_plist_id,                        // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-        &(temp_voxel_vector[0])               // void * buf  OUT: Buffer to receive data read from file.
-      );
-      // std::cout << "temp_voxel_vector.size(): " << temp_voxel_vector.size() << std::endl;
+      // A single projection can take the read buffer without a copy:
+      if (voxel_extents.size() == 1)
+        tensor.assign(std::move(voxels), _trust_ordering);
+      else if (n > 0)
+        tensor.assign(&(voxels[offset]), &(voxels[offset]) + n, _trust_ordering);
 
-      for (auto & v : temp_voxel_vector){
-        _tensor_v.at(voxel_set_index).emplace(v);
+      if (_trust_ordering && _validate_ordering && !tensor.is_sorted()){
+        LARCV_SWARNING() << "Voxels of projection " << voxel_set_index
+                         << " in entry " << entry << " are not sorted on disk, sorting." << std::endl;
+        tensor.sort();
       }
 
+      tensor.id(voxel_set_index);
 
-      _tensor_v.at(voxel_set_index).id(voxel_set_index);
-      // std::cout << "_tensor_v.at(voxel_set_index).at(cluster_id).size(): " << _tensor_v.at(voxel_set_index).at(cluster_id).size() << std::endl;
-
-      offset += voxels_slab_dims[0];
+      offset += n;
 
       // Set the meta for this object:
       // Skip the meta check during deserialization:
-      _tensor_v.at(voxel_set_index).meta(image_meta.at(voxel_set_index), false);
+      tensor.meta(image_meta.at(voxel_set_index), false);
     }
 
+    H5Pclose(xfer_plist_id);
 
     return;
 
   }
 
+  template<size_t dimension>
+  void EventSparseTensor<dimension>::deserialize_range(hid_t group, size_t first,
+      std::vector<std::shared_ptr<EventBase> > & products){
+
+    // The same steps as deserialize, once for all the entries: entries are written one
+    // after the other, so their voxel extents and metas are contiguous, and so are the
+    // voxels of all their sets.  That is one read per table, and the voxels are then
+    // split by set.
+    if (products.empty()) return;
+    open_in_datasets(group);
+
+    std::vector<Extents_t> input_extents(products.size());
+    read_in_extents(EXTENTS_DATASET, first, input_extents.size(), input_extents.data());
+
+    size_t n_sets = 0;
+    for (auto & extents : input_extents){
+      if (extents.n && extents.first != input_extents.front().first + n_sets){
+        // Not laid out by a larcv3 writer, read the entries one by one (clear() keeps
+        // the tensors, and deserialize leaves them alone for an empty entry):
+        for (auto & product : products)
+          static_cast<EventSparseTensor<dimension> &>(*product)._tensor_v.clear();
+        EventBase::deserialize_range(group, first, products);
+        return;
+      }
+      n_sets += extents.n;
+    }
+
+    std::vector<IDExtents_t> voxel_extents(n_sets);
+    std::vector<larcv3::ImageMeta<dimension> > image_meta(n_sets);
+    std::vector<larcv3::Voxel> voxels;
+    if (n_sets){
+      read_in_set_extents(VOXEL_EXTENTS_DATASET, input_extents.front().first, n_sets, voxel_extents.data());
+      read_in_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET,
+        input_extents.front().first, n_sets, image_meta.data());
+      hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+      read_voxels(sparse_tensor_voxels, voxel_extents, xfer_plist_id, voxels);
+      H5Pclose(xfer_plist_id);
+    }
+
+    size_t set_index = 0;
+    size_t offset = 0;
+    for (size_t i_entry = 0; i_entry < products.size(); i_entry ++){
+      auto & product = static_cast<EventSparseTensor<dimension> &>(*products[i_entry]);
+      product._tensor_v.clear();
+      product._tensor_v.resize(input_extents[i_entry].n);
+
+      for (size_t index = 0; index < product._tensor_v.size(); index ++, set_index ++){
+        auto & tensor = product._tensor_v[index];
+        size_t n = voxel_extents[set_index].n;
+        if (n > 0)
+          tensor.assign(&(voxels[offset]), &(voxels[offset]) + n, _trust_ordering);
+
+        if (_trust_ordering && _validate_ordering && !tensor.is_sorted()){
+          LARCV_SWARNING() << "Voxels of projection " << index << " in entry " << first + i_entry
+                           << " are not sorted on disk, sorting." << std::endl;
+          tensor.sort();
+        }
+
+        tensor.id(index);
+        offset += n;
+        tensor.meta(image_meta[set_index], false);
+      }
+    }
+  }
 
 template class EventSparseTensor<2>;
 template class EventSparseTensor<3>;
@@ -889,6 +663,10 @@ void init_eventsparse_tensor_base(pybind11::module m){
   ev_sparse_tensor.def("set", (void (Class::*)(const larcv3::SparseTensor<dimension> &))(&Class::set), "set");
   ev_sparse_tensor.def("set", (void (Class::*)(const larcv3::VoxelSet&, const larcv3::ImageMeta<dimension>&))(&Class::set), "set");
   ev_sparse_tensor.def("clear",              &Class::clear);
+  ev_sparse_tensor.def("trust_ordering",     (void (Class::*)(bool))(&Class::trust_ordering));
+  ev_sparse_tensor.def("trust_ordering",     (bool (Class::*)() const)(&Class::trust_ordering));
+  ev_sparse_tensor.def("validate_ordering",  (void (Class::*)(bool))(&Class::validate_ordering));
+  ev_sparse_tensor.def("validate_ordering",  (bool (Class::*)() const)(&Class::validate_ordering));
 
 
 /*
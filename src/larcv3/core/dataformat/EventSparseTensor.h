@@ -71,13 +71,37 @@ namespace larcv3 {
     void initialize (hid_t group, uint compression);
     void serialize  (hid_t group);
     void deserialize(hid_t group, size_t entry, bool reopen_groups=false);
+    void deserialize_range(hid_t group, size_t first,
+                           std::vector<std::shared_ptr<EventBase> > & products);
     void finalize   ();
+    void swap_data(EventBase & other)
+    { _tensor_v.swap(static_cast<EventSparseTensor<dimension>&>(other)._tensor_v); }
+    void copy_settings(const EventBase & other)
+    {
+      EventBase::copy_settings(other);
+      auto const & product = static_cast<const EventSparseTensor<dimension>&>(other);
+      _trust_ordering    = product._trust_ordering;
+      _validate_ordering = product._validate_ordering;
+    }
+
+    /// If true (default), voxels on disk are assumed sorted by id and are read in as-is
+    inline void trust_ordering(bool trust) { _trust_ordering = trust; }
+    inline bool trust_ordering() const { return _trust_ordering; }
+    /// If true, trusted voxels are checked after reading and re-sorted if out of order
+    inline void validate_ordering(bool validate) { _validate_ordering = validate; }
+    inline bool validate_ordering() const { return _validate_ordering; }
 
   private:
     void open_in_datasets(hid_t group);
     void open_out_datasets(hid_t group);
+    /// Create the voxels dataset, if it waits for the first flush (see serialize)
+    void prepare_flush(bool final);
 
     std::vector<larcv3::SparseTensor<dimension> >  _tensor_v;
+    uint _compression;
+
+    bool _trust_ordering;
+    bool _validate_ordering;
 
 
 
@@ -12,7 +12,8 @@
 #define EXTENTS_DATASET 1
 #define IMAGE_META_DATASET 2
 #define IMAGE_EXTENTS_DATASET 3
-#define N_DATASETS 4
+#define IMAGE_META_INDEX_DATASET 4
+#define N_DATASETS 5
 
 namespace larcv3 {
 
@@ -32,6 +33,7 @@ namespace larcv3 {
     _data_types[IMAGE_EXTENTS_DATASET] = larcv3::get_datatype<IDExtents_t>();
     _data_types[IMAGE_META_DATASET]    = larcv3::ImageMeta<dimension>::get_datatype();
     _data_types[IMAGES_DATASET]        = larcv3::get_datatype<float>();
+    _data_types[IMAGE_META_INDEX_DATASET] = larcv3::get_datatype<unsigned int>();
 
 
   }
@@ -80,18 +82,34 @@ namespace larcv3 {
        _open_in_datasets.resize(N_DATASETS);
        _open_in_dataspaces.resize(N_DATASETS);
 
-       _open_in_datasets[IMAGES_DATASET]          = H5Dopen(group,"images", H5P_DEFAULT);
+       hid_t dapl = dataset_access_plist();
+
+       _open_in_datasets[IMAGES_DATASET]          = H5Dopen(group,"images", dapl);
        _open_in_dataspaces[IMAGES_DATASET]        = H5Dget_space(_open_in_datasets[IMAGES_DATASET]);
 
-       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group,"extents", H5P_DEFAULT);
+       _open_in_datasets[EXTENTS_DATASET]         = H5Dopen(group,"extents", dapl);
        _open_in_dataspaces[EXTENTS_DATASET]       = H5Dget_space(_open_in_datasets[EXTENTS_DATASET]);
 
-       _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group,"image_meta", H5P_DEFAULT);
+       // Files written with a meta dictionary have an index into it instead of a meta table:
+       _open_in_datasets[IMAGE_META_INDEX_DATASET]  = H5I_INVALID_HID;
+       if (H5Lexists(group, "image_meta_index", H5P_DEFAULT) > 0){
+         _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group,"image_meta_dictionary", dapl);
+         _open_in_datasets[IMAGE_META_INDEX_DATASET]= H5Dopen(group,"image_meta_index", dapl);
+         _open_in_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_in_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+       else{
+         _open_in_datasets[IMAGE_META_DATASET]      = H5Dopen(group,"image_meta", dapl);
+       }
        _open_in_dataspaces[IMAGE_META_DATASET]    = H5Dget_space(_open_in_datasets[IMAGE_META_DATASET]);
 
-       _open_in_datasets[IMAGE_EXTENTS_DATASET]   = H5Dopen(group,"image_extents", H5P_DEFAULT);
+       _open_in_datasets[IMAGE_EXTENTS_DATASET]   = H5Dopen(group,"image_extents", dapl);
        _open_in_dataspaces[IMAGE_EXTENTS_DATASET] = H5Dget_space(_open_in_datasets[IMAGE_EXTENTS_DATASET]);
 
+       H5Pclose(dapl);
+
+       load_in_index(EXTENTS_DATASET, IMAGE_EXTENTS_DATASET, IMAGE_META_INDEX_DATASET);
+       load_in_dictionary(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET);
+
     }
 
     return;
@@ -111,9 +129,16 @@ namespace larcv3 {
        _open_out_dataspaces[EXTENTS_DATASET]       = H5Dget_space(_open_out_datasets[EXTENTS_DATASET]);
 
 
-       _open_out_datasets[IMAGE_META_DATASET]      = H5Dopen(group,"image_meta", H5P_DEFAULT);
+       _open_out_datasets[IMAGE_META_DATASET]      = H5Dopen(group,
+         _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", H5P_DEFAULT);
        _open_out_dataspaces[IMAGE_META_DATASET]    = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
 
+       _open_out_datasets[IMAGE_META_INDEX_DATASET]   = H5I_INVALID_HID;
+       if (_storage.meta_dictionary){
+         _open_out_datasets[IMAGE_META_INDEX_DATASET] = H5Dopen(group,"image_meta_index", H5P_DEFAULT);
+         _open_out_dataspaces[IMAGE_META_INDEX_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_INDEX_DATASET]);
+       }
+
        _open_out_datasets[IMAGE_EXTENTS_DATASET]   = H5Dopen(group,"image_extents", H5P_DEFAULT);
        _open_out_dataspaces[IMAGE_EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_EXTENTS_DATASET]);
 
@@ -125,11 +150,13 @@ namespace larcv3 {
   template<size_t dimension>
   void EventTensor<dimension>::finalize(){
     for (size_t i = 0; i < _open_in_datasets.size(); i ++){
+      if (_open_in_datasets[i] < 0) continue;
       H5Sclose(_open_in_dataspaces[i]);
       H5Dclose(_open_in_datasets[i]);
     }
     for (size_t i = 0; i < _open_out_datasets.size(); i ++){
-      H5Sclose(_open_in_dataspaces[i]);
+      if (_open_out_datasets[i] < 0) continue;
+      H5Sclose(_open_out_dataspaces[i]);
       H5Dclose(_open_out_datasets[i]);
     }
   }
@@ -172,7 +199,7 @@ namespace larcv3 {
      * Modify dataset creation properties, i.e. enable chunking.
      */
     hid_t extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    hsize_t      extents_chunk_dims[1] ={IMAGE_EXTENTS_CHUNK_SIZE};
+    hsize_t      extents_chunk_dims[1] ={index_chunk_size(IMAGE_EXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(extents_cparms, 1, extents_chunk_dims );
     if (compression){
       H5Pset_deflate(extents_cparms, compression);
@@ -207,7 +234,7 @@ namespace larcv3 {
      * Modify dataset creation properties, i.e. enable chunking.
      */
     hid_t image_extents_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    hsize_t      image_extents_chunk_dims[1] ={IMAGE_IDEXTENTS_CHUNK_SIZE};
+    hsize_t      image_extents_chunk_dims[1] ={index_chunk_size(IMAGE_IDEXTENTS_CHUNK_SIZE)};
     H5Pset_chunk(image_extents_cparms, 1, image_extents_chunk_dims );
     if (compression){
       H5Pset_deflate(image_extents_cparms, compression);
@@ -242,16 +269,16 @@ namespace larcv3 {
      * Modify dataset creation properties, i.e. enable chunking.
      */
     hid_t image_meta_cparms = H5Pcreate( H5P_DATASET_CREATE );
-    hsize_t      image_meta_chunk_dims[1] ={IMAGE_META_CHUNK_SIZE};
+    hsize_t      image_meta_chunk_dims[1] ={index_chunk_size(IMAGE_META_CHUNK_SIZE)};
     H5Pset_chunk(image_meta_cparms, 1, image_meta_chunk_dims );
     if (compression){
       H5Pset_deflate(image_meta_cparms, compression);
     }
 
-    // Create the extents dataset:
+    // Create the meta dataset, or the dictionary of metas:
     H5Dcreate(
       group,                           // hid_t loc_id  IN: Location identifier
-      "image_meta",                    // const char *name      IN: Dataset name
+      _storage.meta_dictionary ? "image_meta_dictionary" : "image_meta", // const char *name      IN: Dataset name
       _data_types[IMAGE_META_DATASET], // hid_t dtype_id  IN: Datatype identifier
       image_meta_dataspace,            // hid_t space_id  IN: Dataspace identifier
       lcpl,                            // hid_t lcpl_id IN: Link creation property list
@@ -259,6 +286,11 @@ namespace larcv3 {
       dapl                             // hid_t dapl_id IN: Dataset access property list
     );
 
+    // With a meta dictionary, the dictionary row of each image's meta:
+    if (_storage.meta_dictionary)
+      create_chunked_dataset(group, "image_meta_index", _data_types[IMAGE_META_INDEX_DATASET],
+        index_chunk_size(IMAGE_META_CHUNK_SIZE), compression);
+
     _compression = compression;
 
 
@@ -274,9 +306,7 @@ namespace larcv3 {
     /////////////////////////////////////////////////////////
     // Create the Image dataset
     /////////////////////////////////////////////////////////
-    // if ( ! group -> nameExists("images")){
-
-    if (  get_num_objects(group) != 4){
+    if (H5Lexists(group, "images", H5P_DEFAULT) <= 0){
         // std::cout << "Images dataset does not yet exist, creating it." << std::endl;
         // An image is stored as a flat vector, so it's type is float.
         // The image ID is store in the image_extents table, and the meta in the image_meta table
@@ -301,7 +331,7 @@ namespace larcv3 {
          * Modify dataset creation properties, i.e. enable chunking.
          */
         hid_t image_cparms = H5Pcreate( H5P_DATASET_CREATE );
-        hsize_t      image_chunk_dims[1] ={chunk_size};
+        hsize_t      image_chunk_dims[1] ={data_chunk_size(chunk_size)};
         H5Pset_chunk(image_cparms, 1, image_chunk_dims );
         if (_compression){
           H5Pset_deflate(image_cparms, _compression);
@@ -337,34 +367,17 @@ namespace larcv3 {
     // 5) Update the image_extents table with the image_extents vector for this object.
     // 6) Update the image_meta table with the image_meta vector for this object.
     // 7) Update the images table with the images from this event, using the image_extents vector
-
-
-
-    // Transfer property list, default:
-    hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+    //
+    // The tables are updated through the EventBase output buffers, which the
+    // IOManager flushes to the file.
 
 
     /////////////////////////////////////////////////////////
     // Step 1: Get the current dataset dimensions
     /////////////////////////////////////////////////////////
 
-    // Get the dataset current size
-    hsize_t extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[EXTENTS_DATASET], extents_dims_current, NULL);
-
-
-    // Get the dataset current size
-    hsize_t image_extents_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[IMAGE_EXTENTS_DATASET], image_extents_dims_current, NULL);
-
-        // Get the dataset current size
-    hsize_t image_meta_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[IMAGE_META_DATASET], image_meta_dims_current, NULL);
-
-
-    // Get the dataset current size
-    hsize_t images_dims_current[1];
-    H5Sget_simple_extent_dims(_open_out_dataspaces[IMAGES_DATASET], images_dims_current, NULL);
+    hsize_t image_extents_dims_current = out_size(IMAGE_EXTENTS_DATASET);
+    hsize_t images_dims_current        = out_size(IMAGES_DATASET);
 
 
     /////////////////////////////////////////////////////////
@@ -374,11 +387,9 @@ namespace larcv3 {
     // We need to make the image extents object first, which we can do from the vector of images.
     std::vector<IDExtents_t> image_extents;
 
-    size_t last_image_index = images_dims_current[0];
+    size_t last_image_index = images_dims_current;
     size_t n_new_images = _image_v.size();
-    size_t extents_offset = image_extents.size();
-    size_t new_image_size = 0;
-    image_extents.resize(extents_offset + n_new_images);
+    image_extents.resize(n_new_images);
 
 
     for (size_t image_id = 0; image_id < _image_v.size(); image_id ++){
@@ -386,9 +397,6 @@ namespace larcv3 {
         image_extents[image_id].id    = _image_v.at(image_id).meta().id();
         image_extents[image_id].first = last_image_index;
         last_image_index += _image_v.at(image_id).size();
-        new_image_size +=  _image_v.at(image_id).size();
-
-
     }
 
 
@@ -407,218 +415,39 @@ namespace larcv3 {
     // Step 4: Update the overall extents table
     /////////////////////////////////////////////////////////
 
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t extents_size[1];
-    extents_size[0] = extents_dims_current[0] + extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[EXTENTS_DATASET], extents_size);
-
-
-    // Create an extents object to go into the extents table:
-
     Extents_t next_extents;
-    next_extents.first = image_extents_dims_current[0];
+    next_extents.first = image_extents_dims_current;
     next_extents.n = image_extents.size();
 
-    /////////////////////////////////////////////////////////
-    // Write the new extents entry to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[EXTENTS_DATASET]);
-
-    H5Sselect_hyperslab(_open_out_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_dims_current, // start
-      NULL ,                // stride
-      extents_slab_dims,    // count
-      NULL                  // block
-      );
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[EXTENTS_DATASET],   // dataset_id,
-             _data_types[EXTENTS_DATASET],          // hit_t mem_type_id,
-             extents_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[EXTENTS_DATASET], //hid_t file_space_id,
-             xfer_plist_id,                         //hid_t xfer_plist_id,
-             &(next_extents)                        // const void * buf
-           );
+    append_rows(EXTENTS_DATASET, &next_extents, 1);
 
 
     /////////////////////////////////////////////////////////
     // Step 5: Update the image extents table
     /////////////////////////////////////////////////////////
 
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_extents_slab_dims[1];
-    image_extents_slab_dims[0] = image_extents.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t image_extents_size[1];
-    image_extents_size[0] = image_extents_dims_current[0] + image_extents_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[IMAGE_EXTENTS_DATASET], image_extents_size);
-
+    append_rows(IMAGE_EXTENTS_DATASET, image_extents.data(), image_extents.size());
 
 
     /////////////////////////////////////////////////////////
-    // Write the new image_extents to the dataset
+    // Step 6: Update the image meta table (or the meta dictionary and its index)
     /////////////////////////////////////////////////////////
 
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[IMAGE_EXTENTS_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_EXTENTS_DATASET]);
-
-    H5Sselect_hyperslab(_open_out_dataspaces[IMAGE_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      image_extents_dims_current, // start
-      NULL ,                      // stride
-      image_extents_slab_dims,    // count
-      NULL                        // block
-      );
-    // Define memory space:
-    hid_t image_extents_memspace = H5Screate_simple(1, image_extents_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[IMAGE_EXTENTS_DATASET],   // dataset_id,
-             _data_types[IMAGE_EXTENTS_DATASET],          // hit_t mem_type_id,
-             image_extents_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[IMAGE_EXTENTS_DATASET], //hid_t file_space_id,
-             xfer_plist_id,                               //hid_t xfer_plist_id,
-             &(image_extents[0])                          // const void * buf
-           );
-
-    /////////////////////////////////////////////////////////
-    // Step 6: Update the image meta table
-    /////////////////////////////////////////////////////////
-
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = image_meta.size();
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t image_meta_size[1];
-    image_meta_size[0] = image_meta_dims_current[0] + image_meta_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[IMAGE_META_DATASET], image_meta_size);
-
-
-
-    /////////////////////////////////////////////////////////
-    // Write the new image_meta to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Select as a hyperslab the last section of data for writing:
-    _open_out_dataspaces[IMAGE_META_DATASET] = H5Dget_space(_open_out_datasets[IMAGE_META_DATASET]);
-
-    H5Sselect_hyperslab(_open_out_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_dims_current, // start
-      NULL ,                   // stride
-      image_meta_slab_dims,    // count
-      NULL                     // block
-    );
-    // Define memory space:
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-
-    // Write the new data
-    H5Dwrite(_open_out_datasets[IMAGE_META_DATASET],   // dataset_id,
-             _data_types[IMAGE_META_DATASET],          // hit_t mem_type_id,
-             image_meta_memspace,                      // hid_t mem_space_id,
-             _open_out_dataspaces[IMAGE_META_DATASET], //hid_t file_space_id,
-             xfer_plist_id,                            //hid_t xfer_plist_id,
-             &(image_meta[0])                          // const void * buf
-           );
+    if (_storage.meta_dictionary)
+      append_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET, image_meta.data(), image_meta.size());
+    else
+      append_rows(IMAGE_META_DATASET, image_meta.data(), image_meta.size());
 
 
     /////////////////////////////////////////////////////////
     // Step 7: Write new images
     /////////////////////////////////////////////////////////
 
-
-
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t images_slab_dims[1];
-    images_slab_dims[0] = new_image_size;
-
-
-    // Create a size vector for the FULL dataset: previous + current
-    hsize_t images_size[1];
-    images_size[0] = images_dims_current[0] + images_slab_dims[0];
-
-    // Extend the dataset to accomodate the new data
-    H5Dset_extent(_open_out_datasets[IMAGES_DATASET], images_size);
-
-    _open_out_dataspaces[IMAGES_DATASET] = H5Dget_space(_open_out_datasets[IMAGES_DATASET]);
-
-
-    // Write all of the images to file:
-
-    // Keep track of starting index for a write:
-    size_t starting_index = images_dims_current[0];
-
     for (size_t image_id = 0; image_id < _image_v.size(); image_id ++){
-
-        hsize_t new_images_slab_dims[1];
-        hsize_t offset_images_slab_dims[1];
-
-        new_images_slab_dims[0] = _image_v.at(image_id).size();
-        offset_images_slab_dims[0] = starting_index;
-
-        // std::cout << "[" << image_id << "][" << cluster_id << "]: \n"
-        //           << "  Offset: " << offset_images_slab_dims[0]
-        //           << "\n  starting_index: " << starting_index
-        //           << "\n  N: " << new_images_slab_dims[0]
-        //           << "\n  N: " << _image_v.at(image_id).at(cluster_id).size()
-        //           << std::endl;
-
-        // Select as a hyperslab the last section of data for writing:
-        H5Sselect_hyperslab(_open_out_dataspaces[IMAGES_DATASET],
-              H5S_SELECT_SET,
-              offset_images_slab_dims, // start
-              NULL ,                   // stride
-              new_images_slab_dims,    // count
-              NULL                     // block
-            );
-
-        // Define memory space:
-        hid_t images_memspace = H5Screate_simple(1, new_images_slab_dims, NULL);
-
-
-        // Write the new data
-        H5Dwrite(_open_out_datasets[IMAGES_DATASET],   // dataset_id,
-                 _data_types[IMAGES_DATASET],          // hit_t mem_type_id,
-                 images_memspace,                      // hid_t mem_space_id,
-                 _open_out_dataspaces[IMAGES_DATASET], //hid_t file_space_id,
-                 xfer_plist_id,                            //hid_t xfer_plist_id,
-                 &(_image_v.at(image_id).as_vector()[0])                          // const void * buf
-               );
-        starting_index += new_images_slab_dims[0];
+        const auto & image = _image_v.at(image_id).as_vector();
+        append_rows(IMAGES_DATASET, image.data(), image.size());
     }
 
-
-
-
-
-
-
     return;
   }
   template<size_t dimension>
@@ -648,46 +477,10 @@ namespace larcv3 {
     // Step 1: Get the extents information from extents dataset
     /////////////////////////////////////////////////////////
 
-    // H5::DataSet extents_dataset = group->openDataSet("extents");
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace extents_dataspace = extents_dataset.getSpace();
-
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t extents_slab_dims[1];
-    extents_slab_dims[0] = 1;
-
-    hsize_t extents_offset[1];
-    extents_offset[0] = entry;
-
-    /////////////////////////////////////////////////////////
-    // Read this extents entry to the dataset
-    /////////////////////////////////////////////////////////
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset.getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      extents_offset,     // start
-      NULL ,              // stride
-      extents_slab_dims,  // count
-      NULL                // block
-    );
-
-    // Define memory space:
-    hid_t extents_memspace = H5Screate_simple(1, extents_slab_dims, NULL);
-
+    // From the preloaded index, if there is one:
     Extents_t input_extents;
-    // Read the data
-    H5Dread(
-      _open_in_datasets[EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                         // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(input_extents)                       // void * buf  OUT: Buffer to receive data read from file.
-    );
+    read_in_extents(EXTENTS_DATASET, entry, 1, &input_extents);
+
     /////////////////////////////////////////////////////////
     // Step 2: Get the image_extents information
     /////////////////////////////////////////////////////////
@@ -697,46 +490,13 @@ namespace larcv3 {
 
     // If there are no voxels, dont read anything:
     if ( input_extents.n == 0){
+        _image_v.clear();
+        H5Pclose(xfer_plist_id);
         return;
     }
 
-    // H5::DataSet image_extents_dataset = group->openDataSet("image_extents");
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace image_extents_dataspace = _open_in_datasets[IMAGE_EXTENTS_DATASET].getSpace();
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_extents_slab_dims[1];
-    image_extents_slab_dims[0] = input_extents.n;
-
-    hsize_t image_extents_offset[1];
-    image_extents_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset.getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[IMAGE_EXTENTS_DATASET],
-      H5S_SELECT_SET,
-      image_extents_offset, // start
-      NULL ,  // stride
-      image_extents_slab_dims, //count
-      NULL // block
-    );
-
-
-    hid_t image_extents_memspace = H5Screate_simple(1, image_extents_slab_dims, NULL);
-
-    std::vector<IDExtents_t> image_extents;
-
-    // Reserve space for reading in image_extents:
-    image_extents.resize(input_extents.n);
-    H5Dread(
-      _open_in_datasets[IMAGE_EXTENTS_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[IMAGE_EXTENTS_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      image_extents_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[IMAGE_EXTENTS_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                               // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(image_extents[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
+    std::vector<IDExtents_t> image_extents(input_extents.n);
+    read_in_set_extents(IMAGE_EXTENTS_DATASET, input_extents.first, input_extents.n, image_extents.data());
 
 
     /////////////////////////////////////////////////////////
@@ -744,43 +504,10 @@ namespace larcv3 {
     /////////////////////////////////////////////////////////
 
 
-    // H5::DataSet image_meta_dataset = group->openDataSet("image_meta");
-
-    // Get a dataspace inside this file:
-    // H5::DataSpace image_meta_dataspace = image_meta_dataset.getSpace();
-
-    // Create a dimension for the data to add (which is the hyperslab data)
-    hsize_t image_meta_slab_dims[1];
-    image_meta_slab_dims[0] = input_extents.n;
-
-    hsize_t image_meta_offset[1];
-    image_meta_offset[0] = input_extents.first;
-
-    // Now, select as a hyperslab the last section of data for writing:
-    // extents_dataspace = extents_dataset.getSpace();
-    H5Sselect_hyperslab(_open_in_dataspaces[IMAGE_META_DATASET],
-      H5S_SELECT_SET,
-      image_meta_offset, // start
-      NULL ,  // stride
-      image_meta_slab_dims, //count
-      NULL // block
-    );
-
-    hid_t image_meta_memspace = H5Screate_simple(1, image_meta_slab_dims, NULL);
-
-    std::vector<ImageMeta<dimension>> image_meta;
-
-    // Reserve space for reading in image_meta:
-    image_meta.resize(input_extents.n);
-
-    H5Dread(
-      _open_in_datasets[IMAGE_META_DATASET],    // hid_t dataset_id  IN: Identifier of the dataset read from.
-      _data_types[IMAGE_META_DATASET],          // hid_t mem_type_id IN: Identifier of the memory datatype.
-      image_meta_memspace,                      // hid_t mem_space_id  IN: Identifier of the memory dataspace.
-      _open_in_dataspaces[IMAGE_META_DATASET],  // hid_t file_space_id IN: Identifier of the dataset's dataspace in the file.
-      xfer_plist_id,                            // hid_t xfer_plist_id     IN: Identifier of a transfer property list for this I/O operation.
-      &(image_meta[0])                          // void * buf  OUT: Buffer to receive data read from file.
-    );
+    // From the meta dictionary, if the file has one:
+    std::vector<ImageMeta<dimension>> image_meta(input_extents.n);
+    read_in_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET,
+      input_extents.first, input_extents.n, image_meta.data());
 
 
 
@@ -849,6 +576,45 @@ namespace larcv3 {
     return;
   }
 
+  template<size_t dimension>
+  void EventTensor<dimension>::deserialize_range(hid_t group, size_t first,
+      std::vector<std::shared_ptr<EventBase> > & products){
+
+    // The index tables are read once for all the entries.  The images are already
+    // large reads, so each one is still read straight into its tensor.
+    if (products.empty()) return;
+    open_in_datasets(group);
+
+    std::vector<Extents_t> input_extents(products.size());
+    read_in_extents(EXTENTS_DATASET, first, input_extents.size(), input_extents.data());
+
+    size_t n_images = 0;
+    for (auto & extents : input_extents){
+      if (extents.n && extents.first != input_extents.front().first + n_images){
+        EventBase::deserialize_range(group, first, products);
+        return;
+      }
+      n_images += extents.n;
+    }
+
+    std::vector<IDExtents_t> image_extents(n_images);
+    std::vector<ImageMeta<dimension> > image_meta(n_images);
+    read_in_set_extents(IMAGE_EXTENTS_DATASET, input_extents.front().first, n_images, image_extents.data());
+    read_in_dictionary_rows(IMAGE_META_DATASET, IMAGE_META_INDEX_DATASET,
+      input_extents.front().first, n_images, image_meta.data());
+
+    size_t image_index = 0;
+    for (size_t i_entry = 0; i_entry < products.size(); i_entry ++){
+      auto & product = static_cast<EventTensor<dimension> &>(*products[i_entry]);
+      product._image_v.clear();
+      for (size_t index = 0; index < input_extents[i_entry].n; index ++, image_index ++){
+        product._image_v.push_back(Tensor<dimension>(image_meta[image_index]));
+        read_in_rows(IMAGES_DATASET, image_extents[image_index].first, image_extents[image_index].n,
+                     &(product._image_v.back()._img[0]));
+      }
+    }
+  }
+
   template class EventTensor<1>;
   template class EventTensor<2>;
   template class EventTensor<3>;
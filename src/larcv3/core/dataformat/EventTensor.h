@@ -68,7 +68,11 @@ namespace larcv3 {
     void initialize (hid_t group, uint compression);
     void serialize  (hid_t group);
     void deserialize(hid_t group, size_t entry, bool reopen_groups=false);
+    void deserialize_range(hid_t group, size_t first,
+                           std::vector<std::shared_ptr<EventBase> > & products);
     void finalize   ();
+    void swap_data(EventBase & other)
+    { _image_v.swap(static_cast<EventTensor<dimension>&>(other)._image_v); }
 
   private:
     void open_in_datasets(hid_t group);
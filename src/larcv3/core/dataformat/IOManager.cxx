@@ -10,8 +10,6 @@
 #define EVENT_ID_CHUNK_SIZE 100
 
 
-#include <mutex>
-std::mutex __ioman_mtx;
 
 #ifdef LARCV_OPENMP
 omp_lock_t __ioman_omp_lock;
@@ -19,11 +17,30 @@ omp_lock_t __ioman_omp_lock;
 
 namespace larcv3 {
 
+std::recursive_mutex & IOManager::h5_mutex() {
+  static std::recursive_mutex mtx;
+  return mtx;
+}
+
+std::unique_lock<std::recursive_mutex> IOManager::h5_lock() {
+  // A thread-safe HDF5 build has its own global lock, no need for a second one:
+  static const bool threadsafe = [](){
+    hbool_t is_ts = false;
+    H5is_library_threadsafe(&is_ts);
+    return bool(is_ts);
+  }();
+  if (threadsafe) return std::unique_lock<std::recursive_mutex>();
+  return std::unique_lock<std::recursive_mutex>(h5_mutex());
+}
+
 IOManager::IOManager(IOMode_t mode, std::string name)
     : larcv_base(name),
       _io_mode(mode),
       _prepared(false),
       _compression_override(1),
+      _voxel_encoding(kVoxelLegacy),
+      _write_buffer_bytes(0),
+      _write_buffer_entries(0),
       _out_index(0),
       _out_entries(0),
       _out_file_name(""),
@@ -32,15 +49,18 @@ IOManager::IOManager(IOMode_t mode, std::string name)
       _in_entries_total(0),
       _in_file_v(),
       _in_dir_v(),
+      _in_open_file(H5I_INVALID_HID),
+      _max_open_files(32),
+      _in_file_use_ctr(0),
       _out_group_v(),
       _key_list(),
       _product_ctr(0),
       _product_ptr_v(),
       _product_type_v(),
       _producer_name_v(),
-      _h5_core_driver(false),
-      _force_reopen_groups(false) {
+      _h5_core_driver(false) {
   reset();
+  auto h5 = h5_lock();
   _fapl = H5Pcreate(H5P_FILE_ACCESS);
   xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
   _event_id_datatype = larcv3::EventID::get_datatype();
@@ -93,6 +113,52 @@ void IOManager::set_core_driver(const bool opt) { _h5_core_driver = opt; }
 
 void IOManager::set_out_file(const std::string name) { _out_file_name = name; }
 
+void IOManager::set_chunk_size(const std::string& product, size_t data_chunk_size, size_t index_chunk_size) {
+  _data_chunk_size_m[product]  = data_chunk_size;
+  _index_chunk_size_m[product] = index_chunk_size;
+}
+
+void IOManager::set_chunk_cache(size_t bytes, size_t slots, double w0) {
+  _chunk_cache.chunk_cache_bytes = bytes;
+  _chunk_cache.chunk_cache_slots = slots;
+  _chunk_cache.chunk_cache_w0    = w0;
+}
+
+void IOManager::set_preload_index(size_t max_bytes) { _chunk_cache.preload_index_bytes = max_bytes; }
+
+size_t IOManager::preloaded_index_bytes() const {
+  size_t bytes = 0;
+  for (size_t id = 0; id < _product_ctr; ++id)
+    if (_product_ptr_v[id]) bytes += _product_ptr_v[id]->in_index_bytes();
+  return bytes;
+}
+
+void IOManager::set_voxel_encoding(VoxelEncoding_t encoding) { _voxel_encoding = encoding; }
+
+void IOManager::set_meta_dictionary(bool enable) { _chunk_cache.meta_dictionary = enable; }
+
+void IOManager::set_write_buffer(size_t bytes, size_t entries) {
+  _write_buffer_bytes   = bytes;
+  _write_buffer_entries = entries;
+}
+
+void IOManager::set_max_open_files(size_t max_open_files) { _max_open_files = max_open_files; }
+
+void IOManager::set_manifest(const std::string & name) { _manifest_name = name; }
+
+H5StorageConfig IOManager::storage_config(const ProducerName_t& name) const {
+  H5StorageConfig storage = _chunk_cache;
+  storage.voxel_encoding = _voxel_encoding;
+  // A setting for this exact product wins over one for its type:
+  for (auto const & key : {name.first, name.first + "_" + name.second}) {
+    auto data_iter = _data_chunk_size_m.find(key);
+    if (data_iter != _data_chunk_size_m.end()) storage.data_chunk_size = data_iter->second;
+    auto index_iter = _index_chunk_size_m.find(key);
+    if (index_iter != _index_chunk_size_m.end()) storage.index_chunk_size = index_iter->second;
+  }
+  return storage;
+}
+
 std::string IOManager::product_type(const size_t id) const {
   if (id > _product_type_v.size()) {
     LARCV_CRITICAL() << "Product ID " << id << " does not exist... "
@@ -112,6 +178,39 @@ void IOManager::configure(const PSet& cfg) {
 
   _compression_override = cfg.get<uint>("Compression", _compression_override);
 
+  // Chunking per product type or per product, for example ChunkSize: { sparse3d: 20000 }
+  if (cfg.contains_pset("ChunkSize")) {
+    auto const chunk_cfg = cfg.get<larcv3::PSet>("ChunkSize");
+    for (auto const & key : chunk_cfg.value_keys())
+      _data_chunk_size_m[key] = chunk_cfg.get<size_t>(key);
+  }
+  if (cfg.contains_pset("IndexChunkSize")) {
+    auto const chunk_cfg = cfg.get<larcv3::PSet>("IndexChunkSize");
+    for (auto const & key : chunk_cfg.value_keys())
+      _index_chunk_size_m[key] = chunk_cfg.get<size_t>(key);
+  }
+  _chunk_cache.chunk_cache_bytes = cfg.get<size_t>("ChunkCacheBytes", _chunk_cache.chunk_cache_bytes);
+  _chunk_cache.chunk_cache_slots = cfg.get<size_t>("ChunkCacheSlots", _chunk_cache.chunk_cache_slots);
+  _chunk_cache.chunk_cache_w0    = cfg.get<double>("ChunkCacheW0", _chunk_cache.chunk_cache_w0);
+  // Largest product index of an input file loaded into memory, 0 (the default) for none:
+  _chunk_cache.preload_index_bytes = cfg.get<size_t>("PreloadIndexBytes", _chunk_cache.preload_index_bytes);
+
+  // Voxel encoding of the output file, 0 (legacy), 1 (32 bit ids) or 2 (32 bit id deltas):
+  _voxel_encoding = (VoxelEncoding_t)(cfg.get<int>("VoxelEncoding", _voxel_encoding));
+
+  // Image metas of the output file stored once each, with an index per projection:
+  _chunk_cache.meta_dictionary = cfg.get<bool>("MetaDictionary", _chunk_cache.meta_dictionary);
+
+  // Output write buffering, 0 means no limit (both 0 writes every entry at once):
+  _write_buffer_bytes   = cfg.get<size_t>("WriteBufferBytes", _write_buffer_bytes);
+  _write_buffer_entries = cfg.get<size_t>("WriteBufferEntries", _write_buffer_entries);
+
+  // Input files kept open at once, 32 by default; 0 keeps every file open:
+  _max_open_files = cfg.get<size_t>("MaxOpenFiles", _max_open_files);
+
+  // Manifest of the input files, read instead of opening each of them at initialize:
+  _manifest_name = cfg.get<std::string>("Manifest", _manifest_name);
+
   _h5_core_driver = cfg.get<bool>("UseH5CoreDriver", false);
   if (_h5_core_driver) {
     LARCV_INFO() << "File will be stored entirely on memory." << std::endl;
@@ -175,8 +274,9 @@ void IOManager::configure(const PSet& cfg) {
 
 bool IOManager::initialize(int color) {
   LARCV_DEBUG() << "start" << std::endl;
-  // Lock:
-  __ioman_mtx.lock();
+  // Opening the files is nearly all HDF5, so hold both locks throughout:
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+  auto h5 = h5_lock();
 
 // If openmp, always intialize the lock:
 #ifdef LARCV_OPENMP
@@ -332,7 +432,6 @@ bool IOManager::initialize(int color) {
   // _in_index = 0;
   _out_index = 0;
   _prepared = true;
-  __ioman_mtx.unlock();
 
 
   return true;
@@ -360,6 +459,7 @@ size_t IOManager::register_producer(const ProducerName_t& name) {
       (std::shared_ptr<EventBase>)(DataProductFactory::get().create(name));
   _product_type_v[_product_ctr] = name.first;
   _producer_name_v[_product_ctr] = name.second;
+  _product_ptr_v[_product_ctr]->_storage = storage_config(name);
 
   // Determine the status of this product.  Check if it is in the input file:
   auto in_input_iter = _in_key_list.find(name);
@@ -479,10 +579,18 @@ void IOManager::prepare_input() {
 
   // List of total entries in input files?
   _in_entries_v.reserve(_in_file_v.size());
+  _in_offsets_v.clear();
+  _in_offsets_v.reserve(_in_file_v.size() + 1);
 
   // List of producer/product pairs in the input files
   _in_key_list.clear();
 
+  // A manifest already knows all of this:
+  if (!_manifest_name.empty()) {
+    prepare_input_from_manifest();
+    return;
+  }
+
   LARCV_INFO() << "Start inspecting " << _in_file_v.size() << "files"
                << std::endl;
   for (size_t i_file = 0; i_file < _in_file_v.size(); ++i_file) {
@@ -490,40 +598,29 @@ void IOManager::prepare_input() {
     // auto const& dname = _in_dir_v[i_file];
 
     LARCV_NORMAL() << "Opening a file in READ mode: " << fname << std::endl;
-    open_new_input_file(fname);
+    auto & in_file = open_input_file(i_file);
     read_current_event_id();
 
-    // Each file has (or should have) two groups: "Data" and "Events"
-
-    try {
-      H5Gopen(_in_open_file, "/Data", H5P_DEFAULT);
-      H5Gopen(_in_open_file, "/Events", H5P_DEFAULT);
-    } catch (...) {
+    // Each file has (or should have) two groups: "Data" and "Events".
+    // Events/event_id was opened with the file.
+    hid_t data_group = H5Gopen(in_file.file, "/Data", H5P_DEFAULT);
+    if (data_group < 0) {
       LARCV_CRITICAL() << "File " << fname
                        << " does not appear to be a larcv3 file, exiting."
                        << std::endl;
       throw larbys();
     }
 
-    // Re-open those groups after the check
-    data_group = H5Gopen(_in_open_file, "/Data", H5P_DEFAULT);
-    events_group = H5Gopen(_in_open_file, "/Events", H5P_DEFAULT);
-
-    // Vist the extents group and determine how many events are present:
-
-    hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS);
-
-    hid_t extents_dataset = H5Dopen(events_group, "event_id", dapl);
-    // Number of objects:
+    // The size of the event ID dataset is the number of events:
     hsize_t dims_current[1];
-    hid_t extents_space = H5Dget_space(extents_dataset);
-    H5Sget_simple_extent_dims(extents_space, dims_current, NULL );
+    H5Sget_simple_extent_dims(in_file.event_id_dataspace, dims_current, NULL );
     // Number of entries is:
 
     LARCV_NORMAL() << "File " << fname << " has " << dims_current[0] << " entries"
                  << std::endl;
 
     // Append the number of events:
+    _in_offsets_v.push_back(_in_entries_total);
     _in_entries_v.push_back(dims_current[0]);
     _in_entries_total += dims_current[0];
 
@@ -564,24 +661,9 @@ void IOManager::prepare_input() {
         // continue;
       }
 
-      if (_read_only.size()) {
-        bool skip = true;
-        auto const& type_name_iter = _read_only.find(type_name);
-        if (type_name_iter != _read_only.end()) {
-          auto const& type_name_s = (*type_name_iter).second;
-          auto const& name_iter = type_name_s.find(producer_name);
-          if (name_iter != type_name_s.end()) skip = false;
-        }
-        if (skip) {
-          LARCV_NORMAL() << "Skipping: producer=" << producer_name
-                         << " type= " << type_name << std::endl;
-          continue;
-        }
-        LARCV_INFO() << "Not skipping: producer=" << producer_name
-                     << " type= " << type_name << std::endl;
-      }
-
       ProducerName_t name(type_name, producer_name);
+      if (skip_input_product(name)) continue;
+
       // If this is the first file, attempt to register the producer:
       if (i_file == 0) {
         auto id = register_producer(name);
@@ -598,56 +680,249 @@ void IOManager::prepare_input() {
     // After looping over all the objects, make sure there are none missing.
     // We've made sure every one found is supposed to be there, so it suffices
     // to make sure we have the same amount:
+    H5Gclose(data_group);
     if (_key_list.size() != _in_key_list.size()) {
       LARCV_CRITICAL() << "Group number mismatch across files!" << std::endl;
       throw larbys();
     }
+
+    // Files are reopened when they are read; only the first one stays open:
+    if (i_file > 0) close_input_file(i_file);
   }
+  _in_offsets_v.push_back(_in_entries_total);
 
   // Make sure the first file is open:
   if (_in_file_v.size() > 0)
-    open_new_input_file(_in_file_v[0]);
+    open_input_file(0);
 
 
 }
 
+void IOManager::prepare_input_from_manifest() {
 
+  LARCV_INFO() << "Reading the manifest " << _manifest_name << std::endl;
+  _manifest.read(_manifest_name);
 
-void IOManager::open_new_input_file(std::string filename){
+  // Without input files of its own, read every file in the manifest:
+  if (_in_file_v.empty()) {
+    _in_file_v = _manifest.files();
+    _in_dir_v.resize(_in_file_v.size(), "");
+  }
 
-  // Close the currently open file if it is open:
-  // H5Fclose(_in_open_file);
+  _in_manifest_index_v.clear();
+  for (auto const & fname : _in_file_v) {
+    size_t i_manifest = _manifest.file_index(fname);
+    if (i_manifest == kINVALID_SIZE) {
+      LARCV_CRITICAL() << "File " << fname << " is not in the manifest "
+                       << _manifest_name << std::endl;
+      throw larbys();
+    }
+    _in_manifest_index_v.push_back(i_manifest);
+    _in_offsets_v.push_back(_in_entries_total);
+    _in_entries_v.push_back(_manifest.entries()[i_manifest]);
+    _in_entries_total += _in_entries_v.back();
+  }
+  _in_offsets_v.push_back(_in_entries_total);
+
+  for (auto const & name : _manifest.products()) {
+    if (skip_input_product(name)) continue;
+    auto id = register_producer(name);
+    LARCV_INFO() << "Registered: producer=" << name.second
+                 << " Key=" << id << std::endl;
+    _product_status_v[id] = kInputFileUnread;
+    _in_key_list.insert(std::make_pair(name, id));
+  }
 
+  LARCV_NORMAL() << "Manifest lists " << _in_entries_total << " entries in "
+                 << _in_file_v.size() << " files" << std::endl;
 
+  // The other files open when they are first read; open the first one for the
+  // event ID of entry 0:
+  if (_in_file_v.size() > 0) {
+    open_input_file(0);
+    if (_in_entries_v[0]) read_current_event_id();
+  }
+}
 
-  try{
-    _in_open_file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, _fapl);
+bool IOManager::skip_input_product(const ProducerName_t & name) const {
+  if (_read_only.empty()) return false;
+  auto const& type_name_iter = _read_only.find(name.first);
+  if (type_name_iter != _read_only.end() &&
+      type_name_iter->second.find(name.second) != type_name_iter->second.end()) {
+    LARCV_INFO() << "Not skipping: producer=" << name.second
+                 << " type= " << name.first << std::endl;
+    return false;
   }
-  catch ( ... ) {
-    LARCV_CRITICAL() << "Open attempt failed for a file: " << filename
-                     << std::endl;
+  LARCV_NORMAL() << "Skipping: producer=" << name.second
+                 << " type= " << name.first << std::endl;
+  return true;
+}
+
+std::vector<size_t> IOManager::voxel_counts(const std::string & type, const std::string & producer) const {
+  std::vector<size_t> counts;
+  ProducerName_t name(type, producer);
+  if (_in_manifest_index_v.empty() || !_manifest.has_voxel_counts(name)) return counts;
+
+  // The manifest's counts are in its own file order, the input files may be a subset:
+  auto const & manifest_counts = _manifest.voxel_counts(name);
+  counts.reserve(_in_entries_total);
+  for (size_t i_file = 0; i_file < _in_file_v.size(); ++i_file) {
+    auto first = manifest_counts.begin() + _manifest.offsets()[_in_manifest_index_v[i_file]];
+    counts.insert(counts.end(), first, first + _in_entries_v[i_file]);
+  }
+  return counts;
+}
+
+
+size_t IOManager::entries_per_chunk(const std::string & type, const std::string & producer) const {
+  if (_in_file_v.empty()) {
+    LARCV_CRITICAL() << "No input files to find the chunking of" << std::endl;
     throw larbys();
   }
-  if (_in_open_file < 0){
-    LARCV_CRITICAL() << "Open attempt failed for a file: " << filename
-                     << std::endl;
+  std::string group_name;
+  if (!type.empty()) group_name = type + "_" + producer + "_group";
+
+  auto h5 = h5_lock();
+  hid_t file = H5Fopen(_in_file_v.front().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t data_group = file < 0 ? file : H5Gopen(file, "/Data", H5P_DEFAULT);
+  if (data_group < 0) {
+    if (file >= 0) H5Fclose(file);
+    LARCV_CRITICAL() << "Can not read the file " << _in_file_v.front() << std::endl;
     throw larbys();
   }
 
-  hid_t group = H5Gopen(_in_open_file, "Events", H5P_DEFAULT);
+  size_t result = 1;
+  hsize_t most_bytes = 0;
+  hsize_t  num_groups[1] = {0};
+  H5Gget_num_objs(data_group, num_groups);
+  for (size_t i_group = 0; i_group < num_groups[0]; ++i_group) {
+    char temp_name[128];
+    H5Gget_objname_by_idx(data_group, i_group, temp_name, 128);
+    if (!group_name.empty() && group_name != temp_name) continue;
+    hid_t group = H5Gopen(data_group, temp_name, H5P_DEFAULT);
+
+    // Every product has one extents row per entry; the biggest dataset holds its payload:
+    hsize_t entries = 0, rows = 0, chunk_rows = 0, bytes = 0;
+    hsize_t  num_datasets[1] = {0};
+    H5Gget_num_objs(group, num_datasets);
+    for (size_t i_dataset = 0; i_dataset < num_datasets[0]; ++i_dataset) {
+      char dataset_name[128];
+      H5Gget_objname_by_idx(group, i_dataset, dataset_name, 128);
+      hid_t dataset = H5Dopen(group, dataset_name, H5P_DEFAULT);
+      hid_t space   = H5Dget_space(dataset);
+      hid_t type_id = H5Dget_type(dataset);
+      hid_t cparms  = H5Dget_create_plist(dataset);
+      hsize_t dims[H5S_MAX_RANK], chunk[H5S_MAX_RANK];
+      H5Sget_simple_extent_dims(space, dims, NULL);
+      hsize_t dataset_bytes = dims[0] * H5Tget_size(type_id);
+      if (std::string(dataset_name) == "extents") entries = dims[0];
+      if (dataset_bytes > bytes && H5Pget_layout(cparms) == H5D_CHUNKED) {
+        H5Pget_chunk(cparms, H5S_MAX_RANK, chunk);
+        bytes = dataset_bytes;
+        rows = dims[0];
+        chunk_rows = chunk[0];
+      }
+      H5Pclose(cparms);
+      H5Tclose(type_id);
+      H5Sclose(space);
+      H5Dclose(dataset);
+    }
+    H5Gclose(group);
 
-  hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS);
-  _active_in_event_id_dataset   = H5Dopen(group, "event_id", dapl);
-  _active_in_event_id_dataspace = H5Dget_space(_active_in_event_id_dataset);
+    if (entries && rows && bytes > most_bytes) {
+      most_bytes = bytes;
+      // A chunk can be bigger than the whole dataset:
+      result = std::max(size_t(1), size_t(std::min(entries, chunk_rows * entries / rows)));
+    }
+  }
+  H5Gclose(data_group);
+  H5Fclose(file);
 
+  if (!group_name.empty() && !most_bytes) {
+    LARCV_CRITICAL() << "No chunked data for " << type << " " << producer << " in "
+                     << _in_file_v.front() << std::endl;
+    throw larbys();
+  }
+  LARCV_INFO() << result << " entries per chunk in " << _in_file_v.front() << std::endl;
+  return result;
 }
 
-bool IOManager::read_entry(const size_t index, bool force_reload) {
+IOManager::InputFile & IOManager::open_input_file(size_t i_file){
+
+  auto iter = _in_open_files.find(i_file);
+  if (iter == _in_open_files.end()) {
+    // Make room by closing the file that was read least recently:
+    while (_max_open_files && !_in_open_files.empty() && _in_open_files.size() >= _max_open_files) {
+      auto oldest = std::min_element(_in_open_files.begin(), _in_open_files.end(),
+        [](const std::pair<const size_t, InputFile> & a, const std::pair<const size_t, InputFile> & b)
+          { return a.second.last_used < b.second.last_used; });
+      close_input_file(oldest->first);
+    }
+
+    auto const & filename = _in_file_v[i_file];
+    // Files listed in a manifest must be the ones it describes:
+    if (!_in_manifest_index_v.empty() && _manifest.stale(_in_manifest_index_v[i_file])) {
+      LARCV_CRITICAL() << "File " << filename << " changed since the manifest "
+                       << _manifest_name << " was made, rebuild it" << std::endl;
+      throw larbys();
+    }
+    InputFile in_file;
+    in_file.file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, _fapl);
+    if (in_file.file < 0){
+      LARCV_CRITICAL() << "Open attempt failed for a file: " << filename
+                       << std::endl;
+      throw larbys();
+    }
+
+    in_file.event_id_dataset = H5Dopen(in_file.file, "/Events/event_id", H5P_DEFAULT);
+    if (in_file.event_id_dataset < 0){
+      H5Fclose(in_file.file);
+      LARCV_CRITICAL() << "File " << filename
+                       << " does not appear to be a larcv3 file, exiting."
+                       << std::endl;
+      throw larbys();
+    }
+    in_file.event_id_dataspace = H5Dget_space(in_file.event_id_dataset);
 
-  __ioman_mtx.lock();
+    iter = _in_open_files.insert(std::make_pair(i_file, in_file)).first;
+  }
+
+  iter->second.last_used = _in_file_use_ctr++;
+
+  _in_active_file_index         = i_file;
+  _in_open_file                 = iter->second.file;
+  _active_in_event_id_dataset   = iter->second.event_id_dataset;
+  _active_in_event_id_dataspace = iter->second.event_id_dataspace;
+
+  return iter->second;
+}
+
+void IOManager::close_input_file(size_t i_file){
 
-  // Don't reopen groups unless absolutely necessary:
-  _force_reopen_groups = false;
+  auto iter = _in_open_files.find(i_file);
+  if (iter == _in_open_files.end()) return;
+
+  // The file only really closes once nothing in it is open:
+  for (auto const & id_group : iter->second.groups) {
+    if (_product_ptr_v[id_group.first]) _product_ptr_v[id_group.first]->close_in_group(id_group.second);
+    H5Gclose(id_group.second);
+  }
+  H5Sclose(iter->second.event_id_dataspace);
+  H5Dclose(iter->second.event_id_dataset);
+  H5Fclose(iter->second.file);
+
+  if (iter->second.file == _in_open_file) {
+    _in_open_file                 = H5I_INVALID_HID;
+    _active_in_event_id_dataset   = H5I_INVALID_HID;
+    _active_in_event_id_dataspace = H5I_INVALID_HID;
+  }
+
+  _in_open_files.erase(iter);
+}
+
+bool IOManager::read_entry(const size_t index, bool force_reload) {
+
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
 
   LARCV_DEBUG() << "start" << std::endl;
   if (_io_mode == kWRITE) {
@@ -669,37 +944,27 @@ bool IOManager::read_entry(const size_t index, bool force_reload) {
     _set_event_id.clear();
     // read the entry from the event_id tree
 
-    // First, what file is this?
-    bool found = false;
-    _current_offset = 0;
-    size_t _this_file_index = kINVALID_SIZE;
-    for (size_t i = 0; i < _in_entries_v.size(); ++i) {
-      if (_in_index < _in_entries_v.at(i) + _current_offset) {
-        found = true;
-        _this_file_index = i;
-        break;
-      } else {
-        _current_offset += _in_entries_v.at(i);
-      }
-    }
-    if (!found || _this_file_index == kINVALID_SIZE) {
-      LARCV_CRITICAL() << "Could not locate entry " << _in_index << std::endl;
-      throw larbys();
-    }
+    // First, what file is this?  It's the last one starting at or before the entry
+    // (empty files start where the next one does, so they are never picked):
+    size_t i_file = std::upper_bound(_in_offsets_v.begin(), _in_offsets_v.end(), _in_index)
+                    - _in_offsets_v.begin() - 1;
+    _current_offset = _in_offsets_v[i_file];
 
-    if (_this_file_index != _in_active_file_index) {
-      // Open a new file for reading:
-      _in_active_file_index = _this_file_index;
-      open_new_input_file(_in_file_v[_in_active_file_index]);
+    // Only the file switch and the event ID read need HDF5:
+    auto h5 = h5_lock();
 
-      LARCV_INFO() << "Opening new file for continued event reading"
-                     << std::endl;
-      _force_reopen_groups = true;
+    if (i_file != _in_active_file_index || _in_open_files.find(i_file) == _in_open_files.end()) {
+      LARCV_INFO() << "Switching to file " << i_file << " for continued event reading"
+                   << std::endl;
     }
+    // Files already in the cache are not reopened:
+    open_input_file(i_file);
 
 
     read_current_event_id();
 
+    if (h5.owns_lock()) h5.unlock();
+
     // Make sure to reset all the data status:
     for (size_t id = 0; id < _product_status_v.size(); ++id){
     if (!_product_ptr_v[id]) break;
@@ -714,11 +979,111 @@ bool IOManager::read_entry(const size_t index, bool force_reload) {
   }
   LARCV_DEBUG() << "Current input group index: " << _in_index << std::endl;
 
-  __ioman_mtx.unlock();
+  return true;
+}
+
+bool IOManager::read_entries(const std::vector<size_t> & entries) {
+
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+  LARCV_DEBUG() << "start" << std::endl;
+  if (_io_mode != kREAD) {
+    LARCV_WARNING() << "Entries are only read ahead in kREAD mode" << std::endl;
+    return false;
+  }
+  if (!_prepared) {
+    LARCV_CRITICAL() << "Cannot be called before initialize()!" << std::endl;
+    throw larbys();
+  }
+
+  clear_read_ahead();
+
+  std::vector<size_t> ids;
+  for (size_t id = 0; id < _product_ctr; ++id) {
+    if (_product_used_v[id]) ids.push_back(id);
+  }
+  if (ids.empty()) return true;
+
+  std::vector<size_t> sorted(entries);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  while (!sorted.empty() && sorted.back() >= _in_entries_total) sorted.pop_back();
+
+  auto h5 = h5_lock();
+
+  // Reading ahead opens other files, the active one is made active again at the end:
+  size_t active_file_index = _in_active_file_index;
+  bool active_file_open = _in_open_files.find(active_file_index) != _in_open_files.end();
+
+  size_t begin = 0;
+  while (begin < sorted.size()) {
+    // A run of consecutive entries, all in the file of the first one:
+    size_t i_file = std::upper_bound(_in_offsets_v.begin(), _in_offsets_v.end(), sorted[begin])
+                    - _in_offsets_v.begin() - 1;
+    size_t end = begin + 1;
+    while (end < sorted.size() && sorted[end] == sorted[end - 1] + 1 &&
+           sorted[end] < _in_offsets_v[i_file + 1]) ++end;
+    size_t n_entries = end - begin;
+    // A lone entry gains nothing over being read by get_data:
+    if (n_entries < 2) { begin = end; continue; }
+
+    for (size_t i = begin; i < end; ++i)
+      _read_ahead_m[sorted[i]].resize(_product_ctr);
+
+    try {
+      auto & in_file = open_input_file(i_file);
+      for (auto const & id : ids) {
+        auto & pool = _read_ahead_pool_v[id];
+        while (pool.size() < n_entries)
+          pool.push_back((std::shared_ptr<EventBase>)(DataProductFactory::get().create(
+            ProducerName_t(_product_type_v[id], _producer_name_v[id]))));
+        std::vector<std::shared_ptr<EventBase>> products(pool.end() - n_entries, pool.end());
+        pool.resize(pool.size() - n_entries);
+        // Read as the product itself would be, whatever it was configured with since:
+        for (auto & product : products) product->copy_settings(*_product_ptr_v[id]);
+
+        hid_t group = input_group(in_file, id);
+        _product_ptr_v[id]->select_in_group(group);
+        _product_ptr_v[id]->deserialize_range(group, sorted[begin] - _in_offsets_v[i_file], products);
+        for (size_t i = 0; i < n_entries; ++i)
+          _read_ahead_m[sorted[begin + i]][id] = products[i];
+      }
+    }
+    catch (...) {
+      LARCV_CRITICAL() << "Exception caught reading ahead entries " << sorted[begin] << " to "
+                       << sorted[end - 1] << ", closing input file gracefully" << std::endl;
+      clear_read_ahead();
+      close_input_file(i_file);
+      throw;
+    }
+    begin = end;
+  }
+
+  if (active_file_open) open_input_file(active_file_index);
+  else _in_active_file_index = active_file_index;
 
   return true;
 }
 
+hid_t IOManager::input_group(InputFile & in_file, size_t id) {
+  auto iter = in_file.groups.find(id);
+  if (iter != in_file.groups.end()) return iter->second;
+  // The group name is "product_producer_group"
+  std::string group_name = _product_type_v[id];
+  group_name = "Data/" + group_name + "_" + _producer_name_v[id] + "_group";
+  hid_t group = H5Gopen(in_file.file, group_name.c_str(), H5P_DEFAULT);
+  in_file.groups[id] = group;
+  return group;
+}
+
+void IOManager::clear_read_ahead() {
+  for (auto & entry_products : _read_ahead_m) {
+    for (size_t id = 0; id < entry_products.second.size(); ++id)
+      if (entry_products.second[id]) _read_ahead_pool_v[id].push_back(entry_products.second[id]);
+  }
+  _read_ahead_m.clear();
+}
+
 void IOManager::read_current_event_id(){
       // Now, we can open the events folder and figure out what's what.
 
@@ -758,6 +1123,8 @@ void IOManager::read_current_event_id(){
 
 bool IOManager::save_entry() {
 
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
   LARCV_DEBUG() << "start" << std::endl;
   if (!_prepared) {
     LARCV_CRITICAL() << "Cannot be called before initialize()!" << std::endl;
@@ -789,6 +1156,9 @@ bool IOManager::save_entry() {
 
   LARCV_INFO() << "Saving new entry " << std::endl;
 
+  // Serializing creates and opens datasets, and may flush the write buffer:
+  auto h5 = h5_lock();
+
 
   set_id();
 
@@ -851,63 +1221,88 @@ bool IOManager::save_entry() {
   _out_entries += 1;
   _out_index += 1;
 
+  // Write the buffered entries once they reach the budget:
+  _buffered_entries += 1;
+  bool do_flush = !_write_buffer_bytes && !_write_buffer_entries;
+  if (_write_buffer_entries && _buffered_entries >= _write_buffer_entries) do_flush = true;
+  if (_write_buffer_bytes) {
+    size_t bytes = _event_id_buffer.size() * sizeof(larcv3::EventID);
+    for (size_t i = 0; i < _out_group_v.size(); ++i) {
+      if (!_store_id_bool.empty() && !_store_id_bool[i]) continue;
+      bytes += _product_ptr_v[i]->buffered_bytes();
+    }
+    if (bytes >= _write_buffer_bytes) do_flush = true;
+  }
+  if (do_flush) flush_buffers(false);
+
   return true;
 }
 
-void IOManager::append_event_id() {
-  //////////////////////////////////////////////////////////////////
-  // First, we get information about the current status of the dataset:
-  //////////////////////////////////////////////////////////////////
-  // Get the dataspace of the event ID dataset:
-  hid_t dataspace = H5Dget_space(_out_event_id_ds);
-
-  // Get the dataset current size
-  // The eventID table is exclusively rank-1
-  hsize_t dims_current[1];
-  // hsize_t * dims_current = new hsize_t[rank];
-  H5Sget_simple_extent_dims(dataspace, dims_current, NULL);
-
-  // Create a dimension for the data to add (which is the hyperslab data)
-  hsize_t dims_of_slab[1];
-  // For EventID, only adding one object per event
-  dims_of_slab[0] = 1;
-
-  //////////////////////////////////////////////////////////////////
-  // Now we need to extend the dataset to accomodate the new dimensions
-  //////////////////////////////////////////////////////////////////
-
-  // Create a size vector for the FULL dataset: previous + current
-  hsize_t size[1];
-  size[0] = dims_current[0] + dims_of_slab[0];
-
-  // Extend the dataset to accomodate the new data
-  H5Dset_extent(_out_event_id_ds, size);
-
-  // Now, select as a hyperslab the last section of data for writing:
-  dataspace = H5Dget_space(_out_event_id_ds);
-
-  H5Sselect_hyperslab(dataspace,
-    H5S_SELECT_SET,
-    dims_current, // start
-    NULL ,        // stride
-    dims_of_slab, // count
-    NULL          // block
-  );
-
-  // Define memory space:
-  hid_t memspace = H5Screate_simple(1, dims_of_slab, NULL);
-
-
-  // Write the new data
-  H5Dwrite(_out_event_id_ds,        // dataset_id,
-           _event_id_datatype,      // hit_t mem_type_id,
-           memspace,                // hid_t mem_space_id,
-           dataspace,               //hid_t file_space_id,
-           xfer_plist_id,           //hid_t xfer_plist_id,
-           &_event_id               // const void * buf
-         );
+void IOManager::flush() {
+  flush_buffers(true);
+}
+
+void IOManager::flush_buffers(bool final) {
+  if (_io_mode == kREAD) return;
+
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+  auto h5 = h5_lock();
+
+  LARCV_DEBUG() << "Flushing " << _buffered_entries << " buffered entries" << std::endl;
+
+  // Same products as save_entry writes: all of them, unless some are selected
+  for (size_t i = 0; i < _out_group_v.size(); ++i) {
+    if (!_store_id_bool.empty() && !_store_id_bool[i]) continue;
+    _product_ptr_v[i]->flush(final);
+  }
 
+  if (!_event_id_buffer.empty()) {
+    hsize_t dims_of_slab[1];
+    dims_of_slab[0] = _event_id_buffer.size();
 
+    hsize_t dims_current[1];
+    dims_current[0] = _event_ids_written;
+
+    // Extend the dataset to accomodate all of the buffered IDs
+    hsize_t size[1];
+    size[0] = dims_current[0] + dims_of_slab[0];
+    H5Dset_extent(_out_event_id_ds, size);
+
+    // Select as a hyperslab the last section of data for writing:
+    hid_t dataspace = H5Dget_space(_out_event_id_ds);
+    H5Sselect_hyperslab(dataspace,
+      H5S_SELECT_SET,
+      dims_current, // start
+      NULL ,        // stride
+      dims_of_slab, // count
+      NULL          // block
+    );
+
+    // Define memory space:
+    hid_t memspace = H5Screate_simple(1, dims_of_slab, NULL);
+
+    // Write the new data
+    H5Dwrite(_out_event_id_ds,          // dataset_id,
+             _event_id_datatype,        // hit_t mem_type_id,
+             memspace,                  // hid_t mem_space_id,
+             dataspace,                 //hid_t file_space_id,
+             xfer_plist_id,             //hid_t xfer_plist_id,
+             &(_event_id_buffer[0])     // const void * buf
+           );
+
+    H5Sclose(memspace);
+    H5Sclose(dataspace);
+
+    _event_ids_written = size[0];
+    _event_id_buffer.clear();
+  }
+
+  _buffered_entries = 0;
+}
+
+void IOManager::append_event_id() {
+  // The ID is written with the rest of the entry when the write buffer is flushed
+  _event_id_buffer.push_back(_event_id);
 }
 
 void IOManager::clear_entry() {
@@ -963,13 +1358,17 @@ ProducerID_t IOManager::producer_id(const ProducerName_t& name) const {
 
 std::shared_ptr<EventBase> IOManager::get_data(const std::string& type,
                                const std::string& producer) {
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
   LARCV_DEBUG() << "start" << std::endl;
 
   auto prod_name = ProducerName_t(type, producer);
   auto id = producer_id(prod_name);
 
   if (id == kINVALID_SIZE) {
+    // New products make their HDF5 datatypes, and output groups when writing:
+    auto h5 = h5_lock();
     id = register_producer(prod_name);
+    if (h5.owns_lock()) h5.unlock();
     if (_io_mode == kREAD) {
       LARCV_NORMAL() << type << " created w/ producer name " << producer
                      << " but won't be stored in file (kREAD mode)"
@@ -984,7 +1383,7 @@ std::shared_ptr<EventBase> IOManager::get_data(const std::string& type,
 }
 
 std::shared_ptr<EventBase> IOManager::get_data(const size_t id) {
-  __ioman_mtx.lock();
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
 
   LARCV_DEBUG() << "start" << std::endl;
 
@@ -999,35 +1398,38 @@ std::shared_ptr<EventBase> IOManager::get_data(const size_t id) {
     // Reading in is just getting the group, calling deserialize with the right
     // index.
 
-    // The group name is "product_producer_group"
-    std::string group_name = _product_type_v[id];
-    group_name = "Data/" + group_name + "_" + _producer_name_v[id] + "_group";
-
+    _product_used_v[id] = true;
 
-    hid_t group;
-    auto iter = _groups.find(group_name);
-    if (iter == _groups.end() || _force_reopen_groups) {
-      group = H5Gopen(_in_open_file, group_name.c_str(), H5P_DEFAULT);
-      // _in_open_file.openGroup(group_name.c_str());
-      _groups[group_name] = group;
-    } else {
-      group = iter->second;
+    // Read ahead by read_entries, it's only a swap:
+    auto ahead = _read_ahead_m.find(_in_index);
+    if (ahead != _read_ahead_m.end() && id < ahead->second.size() && ahead->second[id]) {
+      _product_ptr_v[id]->swap_data(*ahead->second[id]);
+      _read_ahead_pool_v[id].push_back(ahead->second[id]);
+      ahead->second[id].reset();
+      _product_status_v[id] = kInputFileRead;
+      return _product_ptr_v[id];
     }
 
+    auto h5 = h5_lock();
+
+    // Groups stay open with their file, and each product keeps its datasets per group,
+    // so going back to a file in the cache opens nothing:
+    auto & in_file = open_input_file(_in_active_file_index);
+    hid_t group = input_group(in_file, id);
+
     try {
-      _product_ptr_v[id]->deserialize(group, _in_index - _current_offset, _force_reopen_groups);
+      _product_ptr_v[id]->select_in_group(group);
+      _product_ptr_v[id]->deserialize(group, _in_index - _current_offset, false);
       _product_status_v[id] = kInputFileRead;
     }
     catch (...){
       // When there is an error in deserialization, close the open input file gracefully:
       if(_io_mode != kWRITE){
         LARCV_CRITICAL() << "Exception caught in deserialization, closing input file gracefully" << std::endl;
-        H5Fclose(_in_open_file);
-        // _in_open_file.close();
+        close_input_file(_in_active_file_index);
       }
     }
   }
-  __ioman_mtx.unlock();
   return _product_ptr_v[id];
 }
 
@@ -1101,9 +1503,15 @@ int IOManager::close_all_objects(hid_t fid) {
 
 void IOManager::finalize() {
 
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+  auto h5 = h5_lock();
+
   if (_io_mode != kREAD) {
 
 
+    // Anything still in the write buffer has to reach the file before it closes:
+    flush();
+
     close_all_objects(_out_file);
 
     LARCV_NORMAL() << "Closing output file" << std::endl;
@@ -1121,9 +1529,17 @@ void IOManager::finalize() {
 
 void IOManager::reset() {
   LARCV_DEBUG() << "start" << std::endl;
+  if (!_in_open_files.empty()) {
+    auto h5 = h5_lock();
+    while (!_in_open_files.empty()) close_input_file(_in_open_files.begin()->first);
+  }
   _event_id.clear();
   _set_event_id.clear();
   _in_entries_v.clear();
+  _in_offsets_v.clear();
+  _in_manifest_index_v.clear();
+  _manifest = Manifest();
+  _manifest_name = "";
   _out_group_v.clear();
   // _out_group_v.resize(1000, nullptr);
   _product_ptr_v.clear();
@@ -1134,12 +1550,20 @@ void IOManager::reset() {
   _producer_name_v.resize(1000, "");
   _product_status_v.clear();
   _product_status_v.resize(1000, kUnknown);
+  _product_used_v.clear();
+  _product_used_v.resize(1000, false);
+  _read_ahead_m.clear();
+  _read_ahead_pool_v.clear();
+  _read_ahead_pool_v.resize(1000);
   _product_ctr = 0;
   _in_index = 0;
   _current_offset = 0;
   _out_index = 0;
   _in_entries_total = 0;
   _prepared = false;
+  _buffered_entries = 0;
+  _event_id_buffer.clear();
+  _event_ids_written = 0;
   _out_file_name = "";
   _in_file_v.clear();
   _in_dir_v.clear();
@@ -1168,13 +1592,18 @@ void init_iomanager(pybind11::module m){
   iomanager.def(pybind11::init<Class::IOMode_t, std::string>(),
     pybind11::arg("mode")=Class::kREAD,
     pybind11::arg("name") = "IOManager");
-  iomanager.def(pybind11::init<const larcv3::PSet&>());
+  // Anything that can touch the file releases the GIL, so other python threads
+  // (including other IOManagers) keep running while this one reads or writes.
+  iomanager.def(pybind11::init<const larcv3::PSet&>(), larcv3::release_gil());
   iomanager.def(pybind11::init<std::string, std::string >(),
     pybind11::arg("config_file"),
-    pybind11::arg("name") = "IOManager");
+    pybind11::arg("name") = "IOManager",
+    larcv3::release_gil());
 
-  iomanager.def("get_data",    (std::shared_ptr<larcv3::EventBase> (Class::*)(const std::string&, const std::string&) )(&Class::get_data));
-  iomanager.def("get_data",    (std::shared_ptr<larcv3::EventBase> (Class::*)(const larcv3::ProducerID_t))(&Class::get_data));
+  iomanager.def("get_data",    (std::shared_ptr<larcv3::EventBase> (Class::*)(const std::string&, const std::string&) )(&Class::get_data),
+    larcv3::release_gil());
+  iomanager.def("get_data",    (std::shared_ptr<larcv3::EventBase> (Class::*)(const larcv3::ProducerID_t))(&Class::get_data),
+    larcv3::release_gil());
 
   // For some reason, set_id requires more work:
   iomanager.def("set_id", (void (Class::*)(const long, const long, const long))(&Class::set_id));
@@ -1188,21 +1617,53 @@ void init_iomanager(pybind11::module m){
   iomanager.def("set_core_driver",   &Class::set_core_driver,
     pybind11::arg("opt")=true);
   iomanager.def("set_out_file",      &Class::set_out_file);
+  iomanager.def("set_chunk_size",    &Class::set_chunk_size,
+    pybind11::arg("product"),
+    pybind11::arg("data_chunk_size"),
+    pybind11::arg("index_chunk_size")=0);
+  iomanager.def("set_chunk_cache",   &Class::set_chunk_cache,
+    pybind11::arg("bytes"),
+    pybind11::arg("slots")=0,
+    pybind11::arg("w0")=-1.);
+  iomanager.def("set_preload_index", &Class::set_preload_index);
+  iomanager.def("preloaded_index_bytes", &Class::preloaded_index_bytes);
+  iomanager.def("set_voxel_encoding",&Class::set_voxel_encoding);
+  iomanager.def("set_meta_dictionary",&Class::set_meta_dictionary);
+  iomanager.def("set_write_buffer",  &Class::set_write_buffer,
+    pybind11::arg("bytes"),
+    pybind11::arg("entries")=0);
+  iomanager.def("flush",             &Class::flush, larcv3::release_gil());
+  iomanager.def("set_max_open_files",&Class::set_max_open_files);
+  iomanager.def("set_manifest",      &Class::set_manifest);
+  iomanager.def("manifest",          &Class::manifest,
+    pybind11::return_value_policy::reference_internal);
+  iomanager.def("voxel_counts",      &Class::voxel_counts,
+    pybind11::arg("type"),
+    pybind11::arg("producer"));
   iomanager.def("producer_id",       &Class::producer_id);
   iomanager.def("product_type",      &Class::product_type);
-  iomanager.def("configure",         &Class::configure);
+  iomanager.def("configure",         &Class::configure, larcv3::release_gil());
   iomanager.def("initialize",        &Class::initialize,
-    pybind11::arg("color")=0);
+    pybind11::arg("color")=0,
+    larcv3::release_gil());
   iomanager.def("read_entry",        &Class::read_entry,
     pybind11::arg("index"),
-    pybind11::arg("force_reload")=false);
-  iomanager.def("save_entry",        &Class::save_entry);
-  iomanager.def("finalize",          &Class::finalize);
+    pybind11::arg("force_reload")=false,
+    larcv3::release_gil());
+  iomanager.def("read_entries",      &Class::read_entries,
+    pybind11::arg("entries"),
+    larcv3::release_gil());
+  iomanager.def("save_entry",        &Class::save_entry, larcv3::release_gil());
+  iomanager.def("finalize",          &Class::finalize, larcv3::release_gil());
   iomanager.def("clear_entry",       &Class::clear_entry);
   iomanager.def("current_entry",     &Class::current_entry);
   iomanager.def("get_n_entries_out", &Class::get_n_entries_out);
   iomanager.def("get_file_out_name", &Class::get_file_out_name);
   iomanager.def("get_n_entries",     &Class::get_n_entries);
+  iomanager.def("get_n_entries_per_file", &Class::get_n_entries_per_file);
+  iomanager.def("entries_per_chunk", &Class::entries_per_chunk,
+    pybind11::arg("type")     = "",
+    pybind11::arg("producer") = "");
 
   iomanager.def("event_id",          &Class::event_id);
   iomanager.def("last_event_id",     &Class::last_event_id);
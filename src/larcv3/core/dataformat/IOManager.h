@@ -19,6 +19,7 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <mutex>
 
 #include "hdf5.h"
 
@@ -31,6 +32,7 @@
 #include "larcv3/core/base/PSet.h"
 #include "larcv3/core/dataformat/EventBase.h"
 #include "larcv3/core/dataformat/EventID.h"
+#include "larcv3/core/dataformat/Manifest.h"
 
 //#include "ProductMap.h"
 namespace larcv3 {
@@ -39,6 +41,14 @@ namespace larcv3 {
   /**
     \class IOManager
     \brief LArCV3 file IO hanlder class: it can read/write LArCV3 file.
+
+    Concurrency: each IOManager has its own mutex, taken by initialize, read_entry,
+    get_data, save_entry, flush and finalize, so calls on one instance from several
+    threads are serialized.  Different instances share nothing but the HDF5 library,
+    which (unless it was built thread-safe) must only be entered by one thread at a
+    time.  That process-wide lock, h5_mutex(), is held only around the HDF5 calls,
+    so several IOManagers (for example train and test loaders) can do everything
+    else in parallel.  Always take the instance mutex before h5_mutex().
   */
   class IOManager : public larcv3::larcv_base {
 
@@ -65,11 +75,68 @@ namespace larcv3 {
     void clear_in_file();
     void set_core_driver(const bool opt = true);
     void set_out_file(const std::string name);
+    /// Chunk sizes for a product type ("sparse3d") or one product ("sparse3d_voxels"),
+    /// applied to products registered after this call.  0 keeps the product's default.
+    void set_chunk_size(const std::string& product, size_t data_chunk_size, size_t index_chunk_size = 0);
+    /// Chunk cache of every dataset opened for reading.  0 (or negative w0) keeps the HDF5 default.
+    void set_chunk_cache(size_t bytes, size_t slots = 0, double w0 = -1.);
+    /// Load the index (the extents tables) of each product into memory when it is first read
+    /// from an input file, if it takes at most max_bytes, so each entry goes straight to its
+    /// data.  Bigger indexes are still read entry by entry.  0 (the default) preloads nothing.
+    void set_preload_index(size_t max_bytes);
+    /// Memory held by the preloaded indexes, of every product in every open input file
+    size_t preloaded_index_bytes() const;
+    /// On-disk encoding of the voxels of sparse products in the output file.  kVoxelLegacy
+    /// (the default) is readable by any larcv3; the 32 bit encodings need ids below 2^32.
+    void set_voxel_encoding(VoxelEncoding_t encoding);
+    /// Write the image metas of sparse and dense tensors and sparse clusters to the output file
+    /// as a dictionary of the distinct metas plus the dictionary row of each projection,
+    /// instead of one full meta per projection.  Readers load the dictionary once per file.
+    /// Off (the default) keeps the image_meta table older larcv3 versions read.
+    void set_meta_dictionary(bool enable);
+    /// Hold saved entries in memory until they reach this many bytes or entries (0 for
+    /// no limit), then write them with one extent change and one write per dataset.
+    /// With both at 0 (the default) every entry is written when it is saved, except that
+    /// products sizing their chunks automatically hold their bulk data (sparse voxels) until
+    /// they have a few entries to size them from.
+    void set_write_buffer(size_t bytes, size_t entries = 0);
+    /// Write all entries held in the write buffer.  finalize() always does this.
+    void flush();
+    /// Number of input files kept open at once (32 by default), 0 for no limit.  When the
+    /// limit is reached the least recently read file is closed to make room.  Reopening
+    /// a file costs far more than reading an entry, so raise this if random access keeps
+    /// cycling through more files; the limit bounds the number of file handles and the
+    /// memory held by the files' caches.
+    void set_max_open_files(size_t max_open_files);
+    /// Take the input files' entries and products from a manifest (see Manifest)
+    /// instead of opening every file at initialize().  Files then open when they are
+    /// first read, and refuse to if they changed since the manifest was made.  Input
+    /// files must be in the manifest; with none given, all of its files are read.
+    void set_manifest(const std::string & name);
+    /// The manifest read at initialize(), empty without one
+    const Manifest & manifest() const { return _manifest; }
+    /// Voxels in each input entry of a sparse product, if the manifest counted them
+    /// (empty otherwise)
+    std::vector<size_t> voxel_counts(const std::string & type, const std::string & producer) const;
+    /// Entries that share one compressed chunk of a product's largest dataset, in the first
+    /// input file: reading any of them decompresses the chunk.  With no type, the product
+    /// with the most bytes is used.  At least 1.
+    size_t entries_per_chunk(const std::string & type = "", const std::string & producer = "") const;
+    /// Process-wide lock for calls into a non thread-safe HDF5 library
+    static std::recursive_mutex & h5_mutex();
+    /// Locks h5_mutex(), unless the HDF5 library is thread-safe on its own
+    static std::unique_lock<std::recursive_mutex> h5_lock();
     ProducerID_t producer_id(const ProducerName_t& name) const;
     std::string product_type(const size_t id) const;
     void configure(const PSet& cfg);
     bool initialize(int color=0);
     bool read_entry(const size_t index, bool force_reload = false);
+    /// Read ahead the products of several entries, for the read_entry calls that follow.
+    /// Runs of consecutive entries in one file are read with one deserialize_range per
+    /// product (a few large reads in place of a few small ones per entry).  Only products
+    /// already read with get_data are read ahead; the others are read per entry as usual.
+    /// The entries read ahead are kept until the next call.
+    bool read_entries(const std::vector<size_t> & entries);
     bool save_entry();
     void finalize();
     void clear_entry();
@@ -85,6 +152,10 @@ namespace larcv3 {
     size_t get_n_entries() const
     { return (_in_entries_total ? _in_entries_total : _out_entries); }
 
+    /// Entries in each input file, in order
+    const std::vector<size_t>& get_n_entries_per_file() const
+    { return _in_entries_v; }
+
     std::shared_ptr<EventBase> get_data(const std::string& type, const std::string& producer);
     std::shared_ptr<EventBase> get_data(const ProducerID_t id);
     //
@@ -143,12 +214,41 @@ namespace larcv3 {
   protected:
     void   set_id();
     void   prepare_input();
+    void   prepare_input_from_manifest();
+    /// True if ReadOnlyName/ReadOnlyType leave this input product out
+    bool   skip_input_product(const ProducerName_t & name) const;
     size_t register_producer(const ProducerName_t& name);
-
-    void open_new_input_file(std::string filename);
+    H5StorageConfig storage_config(const ProducerName_t& name) const;
+
+    /**
+      \struct InputFile
+      An open input file with its event ID dataset and the groups of the products read from it
+    */
+    struct InputFile {
+      InputFile()
+        : file(H5I_INVALID_HID), event_id_dataset(H5I_INVALID_HID)
+        , event_id_dataspace(H5I_INVALID_HID), last_used(0) {}
+      hid_t file;
+      hid_t event_id_dataset;
+      hid_t event_id_dataspace;
+      std::map<ProducerID_t, hid_t> groups;
+      size_t last_used;
+    };
+    /// Make file i_file the active input file, opening it (and closing the least
+    /// recently used one if the cache is full) if it isn't open yet
+    InputFile & open_input_file(size_t i_file);
+    /// Close input file i_file and everything the products opened in it
+    void close_input_file(size_t i_file);
     void read_current_event_id();
+    /// Group of product id in an open input file, opened the first time
+    hid_t input_group(InputFile & in_file, size_t id);
+    /// Return the products read ahead to the pool
+    void clear_read_ahead();
 
     void append_event_id();
+    /// Write the buffered entries.  Unless the flush is final, products may hold back the
+    /// rows of datasets they haven't created yet (see EventBase::prepare_flush).
+    void flush_buffers(bool final);
 
     // Closes the objects currently open in file with id fid
     int close_all_objects(hid_t fid);
@@ -159,11 +259,23 @@ namespace larcv3 {
     // IOManager supports only one output file, but multiple input files.
     // Files are checked for consistency in which groups are present.
 
+    // Serializes calls on this instance (recursive: save_entry calls get_data and flush):
+    std::recursive_mutex _mutex;
+
     // General Parameters
     IOMode_t    _io_mode;
     bool        _prepared;
     // This can override the compression level across the entire file:
     uint _compression_override;
+    // HDF5 chunking, keyed by product type or by "type_producer", and the chunk cache:
+    std::map<std::string, size_t> _data_chunk_size_m;
+    std::map<std::string, size_t> _index_chunk_size_m;
+    H5StorageConfig _chunk_cache;
+    VoxelEncoding_t _voxel_encoding;
+    // Write buffer budget, and what is held in it:
+    size_t _write_buffer_bytes;
+    size_t _write_buffer_entries;
+    size_t _buffered_entries;
 
 
     // Parameters controlling output file large scale tracking:
@@ -188,10 +300,20 @@ namespace larcv3 {
     std::vector<std::string>        _in_file_v;
     // List of input directory names:
     std::vector<std::string>        _in_dir_v;
-    // Currently open file:
+    // Currently active file:
     hid_t       _in_open_file;
     // List of total entries in input files
     std::vector<size_t>             _in_entries_v;
+    // Entries before each input file, plus the total at the end, for binary search:
+    std::vector<size_t>             _in_offsets_v;
+    // Open input files by file index, at most _max_open_files of them (0 for all):
+    std::map<size_t, InputFile>     _in_open_files;
+    size_t      _max_open_files;
+    size_t      _in_file_use_ctr;
+    // Optional manifest of the input files, and each input file's index in it:
+    std::string                     _manifest_name;
+    Manifest                        _manifest;
+    std::vector<size_t>             _in_manifest_index_v;
 
     // Parameters for the event ID management:
     EventID   _event_id;
@@ -201,9 +323,6 @@ namespace larcv3 {
     hid_t     _active_in_event_id_dataset;
     hid_t     _active_in_event_id_dataspace;
 
-    hid_t data_group;
-    hid_t events_group;
-
 
     // Parameters controlling the internals of an event.
     // Dealing with input groups:
@@ -222,8 +341,6 @@ namespace larcv3 {
     // Hold a copy of the file access property list:
     hid_t  _fapl; //FileAccPropList
 
-    std::map<std::string, hid_t> _groups;
-
 
     // Keeping track of products and producers:
     size_t                          _product_ctr;
@@ -231,6 +348,11 @@ namespace larcv3 {
     std::vector<std::string>        _product_type_v;
     std::vector<std::string>        _producer_name_v;
     std::vector<ProductStatus_t>    _product_status_v;
+    // Products get_data has read from the input, the ones read_entries reads ahead:
+    std::vector<bool>               _product_used_v;
+    // Products read ahead, by entry then id (null if not read ahead), and spare ones by id:
+    std::map<size_t, std::vector<std::shared_ptr<larcv3::EventBase>>> _read_ahead_m;
+    std::vector<std::vector<std::shared_ptr<larcv3::EventBase>>>     _read_ahead_pool_v;
 
     // General IO:
     std::map<std::string,std::set<std::string> > _store_only;
@@ -243,11 +365,10 @@ namespace larcv3 {
     // IOManager has to control the EventID dataset it's self for the output file.
     hid_t  _out_event_id_ds;  // dataset
     hid_t _event_id_datatype; // datatype
+    std::vector<larcv3::EventID> _event_id_buffer; // IDs not yet written
+    hsize_t _event_ids_written;                    // IDs already in the dataset
     hid_t xfer_plist_id;
 
-    // Internal bookkeeping for when the input file switches:
-    bool _force_reopen_groups;
-
     // MPI Variables:
 #ifdef LARCV_MPI
 
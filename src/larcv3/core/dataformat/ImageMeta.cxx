@@ -112,7 +112,7 @@ std::vector<size_t>  ImageMeta<dimension>::strides()          const{
   
   if (_valid ){
 
-    std::vector<size_t> strides(0,dimension);
+    std::vector<size_t> strides(dimension);
     size_t stride = sizeof(float);
     for (size_t j = 0; j < dimension; j ++ ){
       size_t axis = dimension - j - 1;
@@ -231,28 +231,13 @@ void ImageMeta<dimension>::index( const std::vector<size_t> & coordinates, std::
 
   if (_valid){
 
-    if (coordinates.size() != dimension){
+    if (coordinates.size() % dimension != 0){
       LARCV_CRITICAL() << "Incomplete coordinates submitted for conversion to index, abort." << std::endl;
       throw larbys();
     }
 
-    output_index.clear();
-    output_index.resize(coordinates.size());
-
-#ifdef LARCV_OPENMP
-    #pragma omp parallel for
-#endif
-    for (size_t i = 0; i < coordinates.size(); i ++){
-      // size_t index = 0;
-      size_t stride = 1;
-    for (size_t j = 0; j < dimension; j ++ ){
-        size_t axis = dimension - j - 1;
-        output_index.at(i) += coordinates[axis]*stride;
-        stride *= _number_of_voxels[axis];
-        // dims[axis] = _image_sizes[axis] / _number_of_voxels[axis];
-      }
-    }
-
+    output_index.resize(coordinates.size() / dimension);
+    ravel(coordinates.data(), output_index.size(), output_index.data());
 
     return;
   }
@@ -297,22 +282,7 @@ void ImageMeta<dimension>::coordinates( const std::vector<size_t> & index,  std:
   if (_valid ){
 
     output_coordinates.resize(index.size() * dimension);
-
-    size_t i_index(0), axis, stride, index_copy, i;
-#ifdef LARCV_OPENMP
-    #pragma omp parallel for private(axis, stride, index_copy)
-#endif
-    for (i_index = 0; i_index < index.size(); ++ i_index){
-      index_copy = index.at(i_index);
-
-      for (i = 0; i < dimension; i ++ ){
-        axis = dimension - i - 1;
-        stride = _number_of_voxels[axis];
-        output_coordinates.at(i_index*dimension + axis) = index_copy % stride;
-        index_copy = index_copy / stride;
-      }
-
-    }
+    unravel(index.data(), index.size(), output_coordinates.data(), dimension);
 
     return;
   }
@@ -724,6 +694,12 @@ void init_imagemeta_base(pybind11::module m){
     imagemeta.def("coordinates", 
       (void (Class::*)(const std::vector<size_t> &, std::vector<size_t> & )const)(&Class::coordinates));
     imagemeta.def("coordinate", &Class::coordinate);
+
+    imagemeta.def("ravel_strides", &Class::ravel_strides);
+    imagemeta.def("ravel",
+      (size_t (Class::*)( const std::array<size_t, dimension> & ) const)(&Class::ravel));
+    imagemeta.def("unravel",
+      (std::array<size_t, dimension> (Class::*)( size_t ) const)(&Class::unravel));
  
     imagemeta.def("position",
       (std::vector<double> (Class::*)(size_t) const)(&Class::position));
@@ -109,6 +109,70 @@ class ImageMeta {
 
 
 
+  /// Allocation-free kernels for hot loops.  These do not check is_valid() or bounds,
+  /// so the caller should check the meta once before looping.
+  /// Strides (in elements, not bytes) of each axis for raveling coordinates to an index
+  inline std::array<size_t, dimension> ravel_strides() const {
+    std::array<size_t, dimension> strides;
+    size_t stride = 1;
+    for (size_t j = 0; j < dimension; j ++ ){
+      size_t axis = dimension - j - 1;
+      strides[axis] = stride;
+      stride *= _number_of_voxels[axis];
+    }
+    return strides;
+  }
+
+  /// Fixed size version of index( coordinate )
+  inline size_t ravel(const std::array<size_t, dimension> & coordinate) const {
+    size_t index = 0;
+    size_t stride = 1;
+    for (size_t j = 0; j < dimension; j ++ ){
+      size_t axis = dimension - j - 1;
+      index += coordinate[axis]*stride;
+      stride *= _number_of_voxels[axis];
+    }
+    return index;
+  }
+
+  /// Fixed size version of coordinates( index )
+  inline std::array<size_t, dimension> unravel(size_t index) const {
+    std::array<size_t, dimension> coordinate;
+    for (size_t j = 0; j < dimension; j ++ ){
+      size_t axis = dimension - j - 1;
+      coordinate[axis] = index % _number_of_voxels[axis];
+      index = index / _number_of_voxels[axis];
+    }
+    return coordinate;
+  }
+
+  /// Batched unravel of n_index indexes.  The coordinates of index i are written to
+  /// output[i*output_stride + axis], so they can go straight into an interleaved buffer
+  template<typename T>
+  inline void unravel(const size_t * index, size_t n_index, T * output, size_t output_stride) const {
+    const std::array<size_t, dimension> strides = ravel_strides();
+    for (size_t i = 0; i < n_index; i ++){
+      size_t remainder = index[i];
+      T * out = output + i*output_stride;
+      for (size_t axis = 0; axis < dimension; axis ++){
+        size_t c = remainder / strides[axis];
+        remainder -= c * strides[axis];
+        out[axis] = T(c);
+      }
+    }
+  }
+
+  /// Batched ravel of n_index coordinates, read from coordinates[i*dimension + axis]
+  inline void ravel(const size_t * coordinates, size_t n_index, size_t * output) const {
+    const std::array<size_t, dimension> strides = ravel_strides();
+    for (size_t i = 0; i < n_index; i ++){
+      size_t index = 0;
+      for (size_t axis = 0; axis < dimension; axis ++)
+        index += coordinates[i*dimension + axis] * strides[axis];
+      output[i] = index;
+    }
+  }
+
   /// Convert 1D index to overall coordiante along specified axis
   size_t coordinate(size_t index, size_t axis) const;
   /// There is no vectorized version of the single axis coordinate, open an issue if you need it.
@@ -0,0 +1,442 @@
+#ifndef __LARCV3DATAFORMAT_MANIFEST_CXX
+#define __LARCV3DATAFORMAT_MANIFEST_CXX
+
+#include "larcv3/core/dataformat/Manifest.h"
+#include "larcv3/core/dataformat/IOManager.h"
+#include "larcv3/core/base/larbys.h"
+
+#include <algorithm>
+#include <set>
+#include <sys/stat.h>
+
+namespace larcv3 {
+
+  // Version of the manifest layout, stored as an attribute of /Manifest:
+  static const int kManifestVersion = 1;
+
+  namespace {
+
+    // Strings are stored as one fixed length string dataset, padded to the longest:
+    void write_strings(hid_t group, const char * name, const std::vector<std::string> & strings) {
+      size_t length = 1;
+      for (auto const & s : strings) length = std::max(length, s.size() + 1);
+      std::vector<char> buffer(length * strings.size(), '\0');
+      for (size_t i = 0; i < strings.size(); ++i)
+        std::copy(strings[i].begin(), strings[i].end(), buffer.begin() + i * length);
+
+      hid_t type = H5Tcopy(H5T_C_S1);
+      H5Tset_size(type, length);
+      hsize_t dims[1] = {strings.size()};
+      hid_t space   = H5Screate_simple(1, dims, NULL);
+      hid_t dataset = H5Dcreate(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      if (!strings.empty()) H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+      H5Dclose(dataset);
+      H5Sclose(space);
+      H5Tclose(type);
+    }
+
+    std::vector<std::string> read_strings(hid_t group, const char * name) {
+      hid_t dataset = H5Dopen(group, name, H5P_DEFAULT);
+      hid_t type    = H5Dget_type(dataset);
+      hid_t space   = H5Dget_space(dataset);
+      hsize_t dims[1];
+      H5Sget_simple_extent_dims(space, dims, NULL);
+      size_t length = H5Tget_size(type);
+
+      std::vector<char> buffer(length * dims[0], '\0');
+      if (dims[0]) H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+      std::vector<std::string> strings;
+      strings.reserve(dims[0]);
+      for (size_t i = 0; i < dims[0]; ++i) {
+        const char * s = buffer.data() + i * length;
+        strings.emplace_back(s, std::find(s, s + length, '\0'));
+      }
+      H5Sclose(space);
+      H5Tclose(type);
+      H5Dclose(dataset);
+      return strings;
+    }
+
+    template <class T>
+    void write_values(hid_t group, const char * name, hid_t type,
+                      const std::vector<T> & values, size_t n_columns = 0) {
+      hsize_t dims[2] = {values.size(), n_columns};
+      if (n_columns) dims[0] = values.size() / n_columns;
+      hid_t space   = H5Screate_simple(n_columns ? 2 : 1, dims, NULL);
+      hid_t dataset = H5Dcreate(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      if (!values.empty()) H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+      H5Dclose(dataset);
+      H5Sclose(space);
+    }
+
+    template <class T>
+    std::vector<T> read_values(hid_t group, const char * name, hid_t type) {
+      hid_t dataset = H5Dopen(group, name, H5P_DEFAULT);
+      hid_t space   = H5Dget_space(dataset);
+      std::vector<T> values(H5Sget_simple_extent_npoints(space));
+      if (!values.empty()) H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+      H5Sclose(space);
+      H5Dclose(dataset);
+      return values;
+    }
+
+    // Names of the objects in a group, in the order HDF5 lists them:
+    std::vector<std::string> object_names(hid_t group) {
+      hsize_t num_objects[1] = {0};
+      H5Gget_num_objs(group, num_objects);
+      std::vector<std::string> names;
+      for (size_t i_obj = 0; i_obj < num_objects[0]; ++i_obj) {
+        char temp_name[128];
+        H5Gget_objname_by_idx(group, i_obj, temp_name, 128);
+        names.push_back(temp_name);
+      }
+      return names;
+    }
+  }
+
+  Manifest::Manifest(std::string name)
+    : larcv_base(name)
+  {}
+
+  bool Manifest::file_status(const std::string & file, long long & bytes, long long & mtime) {
+    struct stat status;
+    if (stat(file.c_str(), &status) != 0) return false;
+    bytes = status.st_size;
+    mtime = status.st_mtime;
+    return true;
+  }
+
+  void Manifest::build(const std::vector<std::string> & files, bool voxel_counts) {
+
+    _files = files;
+    _entries.clear();
+    _offsets.assign(1, 0);
+    _file_bytes.clear();
+    _file_mtimes.clear();
+    _products.clear();
+    _datasets.clear();
+    _dataset_sizes.clear();
+    _voxel_counts.clear();
+
+    // Rows per dataset of each file, merged into one table at the end:
+    std::vector<std::map<std::string, size_t> > file_dataset_sizes;
+    std::set<std::string> dataset_names;
+
+    for (auto const & fname : _files) {
+
+      long long bytes, mtime;
+      if (!file_status(fname, bytes, mtime)) {
+        LARCV_CRITICAL() << "Can not stat the file " << fname << std::endl;
+        throw larbys();
+      }
+      _file_bytes.push_back(bytes);
+      _file_mtimes.push_back(mtime);
+
+      LARCV_INFO() << "Inspecting " << fname << std::endl;
+      auto h5 = IOManager::h5_lock();
+      hid_t file = H5Fopen(fname.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+      if (file < 0) {
+        LARCV_CRITICAL() << "Open attempt failed for a file: " << fname << std::endl;
+        throw larbys();
+      }
+      hid_t event_id  = H5Dopen(file, "/Events/event_id", H5P_DEFAULT);
+      hid_t data_group = H5Gopen(file, "/Data", H5P_DEFAULT);
+      if (event_id < 0 || data_group < 0) {
+        LARCV_CRITICAL() << "File " << fname
+                         << " does not appear to be a larcv3 file, exiting." << std::endl;
+        throw larbys();
+      }
+
+      // The size of the event ID dataset is the number of events:
+      hid_t event_id_space = H5Dget_space(event_id);
+      hsize_t dims[1];
+      H5Sget_simple_extent_dims(event_id_space, dims, NULL);
+      H5Sclose(event_id_space);
+      H5Dclose(event_id);
+      _entries.push_back(dims[0]);
+      _offsets.push_back(_offsets.back() + dims[0]);
+
+      // Products are the "type_producer_group" groups under /Data, the same in all files:
+      std::vector<ProducerName_t> products;
+      file_dataset_sizes.emplace_back();
+      for (auto const & group_name : object_names(data_group)) {
+        size_t first = group_name.find_first_of('_');
+        size_t last  = group_name.find_last_of('_');
+        if (first == std::string::npos || first == last || group_name.substr(last + 1) != "group") {
+          LARCV_CRITICAL() << "Skipping " << group_name << " ... (not LArCV3 Group)" << std::endl;
+          continue;
+        }
+        ProducerName_t name(group_name.substr(0, first), group_name.substr(first + 1, last - first - 1));
+        products.push_back(name);
+
+        hid_t group = H5Gopen(data_group, group_name.c_str(), H5P_DEFAULT);
+        for (auto const & dataset_name : object_names(group)) {
+          hid_t dataset = H5Dopen(group, dataset_name.c_str(), H5P_DEFAULT);
+          hid_t space   = H5Dget_space(dataset);
+          hsize_t rows[H5S_MAX_RANK];
+          H5Sget_simple_extent_dims(space, rows, NULL);
+          H5Sclose(space);
+          H5Dclose(dataset);
+
+          std::string key = group_name + "/" + dataset_name;
+          file_dataset_sizes.back()[key] = rows[0];
+          dataset_names.insert(key);
+        }
+
+        if (voxel_counts && (name.first == "sparse2d"  || name.first == "sparse3d" ||
+                             name.first == "cluster2d" || name.first == "cluster3d"))
+          count_voxels(group, name.first, dims[0], _voxel_counts[name]);
+        H5Gclose(group);
+      }
+      H5Gclose(data_group);
+      H5Fclose(file);
+
+      if (_products.empty() && file_dataset_sizes.size() == 1) {
+        _products = products;
+      }
+      else if (products != _products) {
+        LARCV_CRITICAL() << "Group number mismatch across files! (" << fname << ")" << std::endl;
+        throw larbys();
+      }
+    }
+
+    _datasets.assign(dataset_names.begin(), dataset_names.end());
+    _dataset_sizes.reserve(_files.size() * _datasets.size());
+    for (auto const & sizes : file_dataset_sizes) {
+      for (auto const & dataset : _datasets) {
+        auto iter = sizes.find(dataset);
+        _dataset_sizes.push_back(iter == sizes.end() ? 0 : iter->second);
+      }
+    }
+  }
+
+  void Manifest::count_voxels(hid_t group, const std::string & type, size_t n_entries,
+                              std::vector<size_t> & counts) const {
+
+    auto h5 = IOManager::h5_lock();
+
+    // Each entry's rows of one extents table point at a contiguous range of rows of the
+    // next one, down to the table whose rows count voxels:
+    //   sparse:   extents -> voxel_extents
+    //   cluster:  extents -> projection_extents -> cluster_extents
+    std::vector<const char *> chain;
+    if (type == "sparse2d" || type == "sparse3d") chain = {"voxel_extents"};
+    else                                          chain = {"projection_extents", "cluster_extents"};
+
+    hid_t extents_type    = larcv3::get_datatype<Extents_t>();
+    hid_t id_extents_type = larcv3::get_datatype<IDExtents_t>();
+
+    auto extents = read_values<Extents_t>(group, "extents", extents_type);
+    if (extents.size() != n_entries) {
+      LARCV_CRITICAL() << "Extents of a " << type << " product have " << extents.size()
+                       << " rows for " << n_entries << " entries" << std::endl;
+      throw larbys();
+    }
+    std::vector<std::pair<size_t, size_t> > ranges;
+    ranges.reserve(n_entries);
+    for (auto const & e : extents) ranges.emplace_back(e.first, e.first + e.n);
+
+    for (size_t level = 0; level < chain.size(); ++level) {
+      auto table = read_values<IDExtents_t>(group, chain[level], id_extents_type);
+      bool last_level = (level + 1 == chain.size());
+      for (auto & range : ranges) {
+        if (range.second > table.size()) {
+          LARCV_CRITICAL() << "Extents of a " << type << " product point past the end of "
+                           << chain[level] << std::endl;
+          throw larbys();
+        }
+        if (last_level) {
+          size_t n_voxels = 0;
+          for (size_t row = range.first; row < range.second; ++row) n_voxels += table[row].n;
+          counts.push_back(n_voxels);
+        }
+        else if (range.first == range.second) {
+          range = std::make_pair(size_t(0), size_t(0));
+        }
+        else {
+          auto const & back = table[range.second - 1];
+          range = std::make_pair(size_t(table[range.first].first), size_t(back.first + back.n));
+        }
+      }
+    }
+
+    H5Tclose(extents_type);
+    H5Tclose(id_extents_type);
+  }
+
+  void Manifest::write(const std::string & name) const {
+
+    auto h5 = IOManager::h5_lock();
+    hid_t file = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0) {
+      LARCV_CRITICAL() << "Can not create the manifest " << name << std::endl;
+      throw larbys();
+    }
+    hid_t group = H5Gcreate(file, "/Manifest", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    hid_t attr_space = H5Screate(H5S_SCALAR);
+    hid_t attr = H5Acreate(group, "version", H5T_NATIVE_INT, attr_space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attr, H5T_NATIVE_INT, &kManifestVersion);
+    H5Aclose(attr);
+    H5Sclose(attr_space);
+
+    std::vector<std::string> types, producers;
+    for (auto const & product : _products) {
+      types.push_back(product.first);
+      producers.push_back(product.second);
+    }
+
+    write_strings(group, "files",          _files);
+    write_strings(group, "product_types",  types);
+    write_strings(group, "producer_names", producers);
+    write_strings(group, "datasets",       _datasets);
+    write_values (group, "entries",        larcv3::get_datatype<size_t>(), _entries);
+    write_values (group, "file_bytes",     H5T_NATIVE_LLONG, _file_bytes);
+    write_values (group, "file_mtimes",    H5T_NATIVE_LLONG, _file_mtimes);
+    write_values (group, "dataset_sizes",  larcv3::get_datatype<size_t>(), _dataset_sizes,
+                  _datasets.size());
+
+    // One dataset of per-entry counts per product, named as the product's group:
+    hid_t counts_group = H5Gcreate(group, "voxel_counts", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    for (auto const & name_counts : _voxel_counts) {
+      std::string counts_name = name_counts.first.first + "_" + name_counts.first.second + "_group";
+      write_values(counts_group, counts_name.c_str(), larcv3::get_datatype<size_t>(), name_counts.second);
+    }
+    H5Gclose(counts_group);
+
+    H5Gclose(group);
+    H5Fclose(file);
+  }
+
+  void Manifest::read(const std::string & name) {
+
+    auto h5 = IOManager::h5_lock();
+    hid_t file = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+      LARCV_CRITICAL() << "Open attempt failed for the manifest " << name << std::endl;
+      throw larbys();
+    }
+    if (H5Lexists(file, "/Manifest", H5P_DEFAULT) <= 0) {
+      H5Fclose(file);
+      LARCV_CRITICAL() << "File " << name << " is not a larcv3 manifest" << std::endl;
+      throw larbys();
+    }
+    hid_t group = H5Gopen(file, "/Manifest", H5P_DEFAULT);
+
+    int version = 0;
+    hid_t attr = H5Aopen(group, "version", H5P_DEFAULT);
+    H5Aread(attr, H5T_NATIVE_INT, &version);
+    H5Aclose(attr);
+    if (version > kManifestVersion) {
+      H5Gclose(group);
+      H5Fclose(file);
+      LARCV_CRITICAL() << "Manifest " << name << " has version " << version
+                       << ", this larcv3 reads up to version " << kManifestVersion << std::endl;
+      throw larbys();
+    }
+
+    _files         = read_strings(group, "files");
+    _datasets      = read_strings(group, "datasets");
+    _entries       = read_values<size_t>(group, "entries", larcv3::get_datatype<size_t>());
+    _file_bytes    = read_values<long long>(group, "file_bytes", H5T_NATIVE_LLONG);
+    _file_mtimes   = read_values<long long>(group, "file_mtimes", H5T_NATIVE_LLONG);
+    _dataset_sizes = read_values<size_t>(group, "dataset_sizes", larcv3::get_datatype<size_t>());
+
+    auto types     = read_strings(group, "product_types");
+    auto producers = read_strings(group, "producer_names");
+    _products.clear();
+    for (size_t i = 0; i < types.size(); ++i) _products.emplace_back(types[i], producers[i]);
+
+    _offsets.assign(1, 0);
+    for (auto const & n : _entries) _offsets.push_back(_offsets.back() + n);
+
+    _voxel_counts.clear();
+    hid_t counts_group = H5Gopen(group, "voxel_counts", H5P_DEFAULT);
+    for (auto const & product : _products) {
+      std::string counts_name = product.first + "_" + product.second + "_group";
+      if (H5Lexists(counts_group, counts_name.c_str(), H5P_DEFAULT) <= 0) continue;
+      _voxel_counts[product] = read_values<size_t>(counts_group, counts_name.c_str(),
+                                                   larcv3::get_datatype<size_t>());
+    }
+    H5Gclose(counts_group);
+
+    H5Gclose(group);
+    H5Fclose(file);
+
+    LARCV_INFO() << "Manifest " << name << " lists " << _files.size() << " files with "
+                 << _offsets.back() << " entries" << std::endl;
+  }
+
+  size_t Manifest::dataset_size(size_t i_file, size_t i_dataset) const {
+    if (i_file >= _files.size() || i_dataset >= _datasets.size()) {
+      LARCV_CRITICAL() << "No dataset " << i_dataset << " of file " << i_file << " in the manifest" << std::endl;
+      throw larbys();
+    }
+    return _dataset_sizes[i_file * _datasets.size() + i_dataset];
+  }
+
+  size_t Manifest::dataset_size(size_t i_file, const std::string & dataset) const {
+    auto iter = std::lower_bound(_datasets.begin(), _datasets.end(), dataset);
+    if (iter == _datasets.end() || *iter != dataset) return 0;
+    return dataset_size(i_file, iter - _datasets.begin());
+  }
+
+  size_t Manifest::file_index(const std::string & file) const {
+    auto iter = std::find(_files.begin(), _files.end(), file);
+    if (iter == _files.end()) return kINVALID_SIZE;
+    return iter - _files.begin();
+  }
+
+  bool Manifest::has_voxel_counts(const ProducerName_t & name) const {
+    return _voxel_counts.find(name) != _voxel_counts.end();
+  }
+
+  const std::vector<size_t> & Manifest::voxel_counts(const ProducerName_t & name) const {
+    auto iter = _voxel_counts.find(name);
+    if (iter == _voxel_counts.end()) {
+      LARCV_CRITICAL() << "No voxel counts in the manifest for " << name.first << " "
+                       << name.second << std::endl;
+      throw larbys();
+    }
+    return iter->second;
+  }
+
+  bool Manifest::stale(size_t i_file) const {
+    long long bytes, mtime;
+    if (!file_status(_files.at(i_file), bytes, mtime)) return true;
+    return bytes != _file_bytes[i_file] || mtime != _file_mtimes[i_file];
+  }
+
+}
+
+#include <pybind11/stl.h>
+
+void init_manifest(pybind11::module m){
+
+  using Class = larcv3::Manifest;
+  pybind11::class_<Class> manifest(m, "Manifest");
+  manifest.def(pybind11::init<std::string>(),
+    pybind11::arg("name") = "Manifest");
+
+  manifest.def("build",            &Class::build,
+    pybind11::arg("files"),
+    pybind11::arg("voxel_counts") = true,
+    larcv3::release_gil());
+  manifest.def("write",            &Class::write, larcv3::release_gil());
+  manifest.def("read",             &Class::read,  larcv3::release_gil());
+  manifest.def("n_files",          &Class::n_files);
+  manifest.def("files",            &Class::files);
+  manifest.def("entries",          &Class::entries);
+  manifest.def("offsets",          &Class::offsets);
+  manifest.def("products",         &Class::products);
+  manifest.def("datasets",         &Class::datasets);
+  manifest.def("dataset_size",     (size_t (Class::*)(size_t, size_t) const)(&Class::dataset_size));
+  manifest.def("dataset_size",     (size_t (Class::*)(size_t, const std::string &) const)(&Class::dataset_size));
+  manifest.def("file_index",       &Class::file_index);
+  manifest.def("has_voxel_counts", &Class::has_voxel_counts);
+  manifest.def("voxel_counts",     &Class::voxel_counts);
+  manifest.def("stale",            &Class::stale);
+
+}
+
+#endif
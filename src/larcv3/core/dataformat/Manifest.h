@@ -0,0 +1,107 @@
+/**
+ * \file Manifest.h
+ *
+ * \ingroup core_DataFormat
+ *
+ * \brief Class def header for a class larcv3::Manifest
+ *
+ * @author cadams
+ */
+
+/** \addtogroup core_DataFormat
+
+    @{*/
+#ifndef __LARCV3DATAFORMAT_MANIFEST_H
+#define __LARCV3DATAFORMAT_MANIFEST_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hdf5.h"
+
+#include "larcv3/core/base/larcv_base.h"
+#include "larcv3/core/dataformat/DataFormatTypes.h"
+
+namespace larcv3 {
+
+  /**
+    \class Manifest
+    \brief Catalog of a list of larcv3 files, so IOManager can start without opening them.
+
+    A manifest records, for every file, its number of entries, its size and modification
+    time, and the number of rows of each dataset under /Data.  It also records the
+    products (common to all files) and, optionally, the number of voxels of every entry
+    of every sparse product.  build() opens each file once; the result is saved with
+    write() and loaded with read(), which touches only the manifest itself.
+    Like IOManager, they hold IOManager::h5_lock() around their HDF5 calls, so they can run
+    alongside IOManagers in other threads.
+  */
+  class Manifest : public larcv3::larcv_base {
+
+  public:
+    /// Default constructor
+    Manifest(std::string name = "Manifest");
+
+    /// Inspect the files, optionally counting the voxels of each entry of sparse products
+    void build(const std::vector<std::string> & files, bool voxel_counts = true);
+    /// Save the manifest as an HDF5 file
+    void write(const std::string & name) const;
+    /// Load a manifest saved by write()
+    void read(const std::string & name);
+
+    inline size_t n_files() const { return _files.size(); }
+    inline const std::vector<std::string> & files() const { return _files; }
+    /// Entries per file
+    inline const std::vector<size_t> & entries() const { return _entries; }
+    /// Entries before each file, and the total at the end
+    inline const std::vector<size_t> & offsets() const { return _offsets; }
+    /// Products found in the files
+    inline const std::vector<ProducerName_t> & products() const { return _products; }
+    /// Datasets found in any of the files, as "type_producer_group/dataset"
+    inline const std::vector<std::string> & datasets() const { return _datasets; }
+    /// Rows of dataset i_dataset in file i_file (0 if the file doesn't have it)
+    size_t dataset_size(size_t i_file, size_t i_dataset) const;
+    /// Rows of the named dataset in file i_file (0 if the file doesn't have it)
+    size_t dataset_size(size_t i_file, const std::string & dataset) const;
+    /// Index of a file in the manifest, or kINVALID_SIZE if it is not in it
+    size_t file_index(const std::string & file) const;
+
+    /// True if voxel counts are recorded for this product
+    bool has_voxel_counts(const ProducerName_t & name) const;
+    /// Voxels in each entry of a sparse product, over all files in order
+    const std::vector<size_t> & voxel_counts(const ProducerName_t & name) const;
+
+    /// True if file i_file is missing, or its size or modification time changed
+    bool stale(size_t i_file) const;
+
+  private:
+
+    /// Size and modification time of a file, false if it can't be stat'ed
+    static bool file_status(const std::string & file, long long & bytes, long long & mtime);
+    /// Voxels per entry of the sparse product in group, by following its extents tables
+    void count_voxels(hid_t group, const std::string & type, size_t n_entries,
+                      std::vector<size_t> & counts) const;
+
+    std::vector<std::string>     _files;
+    std::vector<size_t>          _entries;
+    std::vector<size_t>          _offsets;
+    std::vector<long long>       _file_bytes;
+    std::vector<long long>       _file_mtimes;
+    std::vector<ProducerName_t>  _products;
+    std::vector<std::string>     _datasets;
+    // Rows per dataset, one row of _datasets.size() values per file:
+    std::vector<size_t>          _dataset_sizes;
+    std::map<ProducerName_t, std::vector<size_t> > _voxel_counts;
+
+  };
+
+}
+
+#ifdef LARCV_INTERNAL
+#include <pybind11/pybind11.h>
+void init_manifest(pybind11::module m);
+#endif
+
+#endif
+/** @} */ // end of doxygen group
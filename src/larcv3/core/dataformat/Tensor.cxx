@@ -4,6 +4,8 @@
 
 #include "larcv3/core/base/larbys.h"
 #include "larcv3/core/base/larcv_logger.h"
+#include "larcv3/core/base/larcv_base.h"
+#include "larcv3/core/base/StridedCopy.h"
 #include "larcv3/core/dataformat/Tensor.h"
 #include <iostream>
 #include <string.h>
@@ -63,14 +65,16 @@ namespace larcv3 {
       _meta.set_dimension(dim, (double)(buffer.shape[dim]), (double)(buffer.shape[dim]));
     
 
-    // Now, we copy the data from numpy into our own buffer:
+    // Now, we copy the data from numpy into our own (row-major) buffer.  The array
+    // can have any strides, for example if it is a transposed view:
     _img.resize(_meta.total_voxels());
 
-    auto ptr = static_cast<float *>(buffer.ptr);
+    std::vector<size_t> shape(buffer.shape.begin(), buffer.shape.end());
+    std::vector<std::ptrdiff_t> strides;
+    for (auto const& stride : buffer.strides) strides.push_back(stride / std::ptrdiff_t(sizeof(float)));
 
-    for (size_t i = 0; i < _meta.total_voxels(); ++i) {
-      _img[i] = ptr[i];
-    }
+    strided_copy(static_cast<const float *>(buffer.ptr), strides,
+                 _img.data(), row_major_strides(shape), shape);
 
   }
 
@@ -431,9 +435,9 @@ Tensor<dimension> Tensor<dimension>::compress(
   // Loop over the pixels, find the position in the new tensor, and add it.
   for (size_t index = 0; index < _img.size() ;  index ++  ){
     // First, get the old coordinates of this voxel:
-    auto coordinates = this->_meta.coordinates(index);
+    auto coordinates = this->_meta.unravel(index);
     for (size_t d = 0; d < dimension; d ++) coordinates[d] = size_t(coordinates[d] / compression[d]);
-    size_t new_index = compressed_meta.index(coordinates);
+    size_t new_index = compressed_meta.ravel(coordinates);
 
     // Add the new voxel to the new set:
     if ( pool_type == larcv3::kPoolMax){
@@ -688,9 +692,11 @@ void init_tensor_base(pybind11::module m){
   tensor.def("binarize",                                   &Class::binarize);
   tensor.def("clear_data",                                 &Class::clear_data);
   tensor.def("compress",
-    (Class (Class::*)(std::array<size_t, dimension> compression, larcv3::PoolType_t)const)(&Class::compress));
+    (Class (Class::*)(std::array<size_t, dimension> compression, larcv3::PoolType_t)const)(&Class::compress),
+    larcv3::release_gil());
   tensor.def("compress", 
-    (Class (Class::*)( size_t, larcv3::PoolType_t ) const)( &Class::compress));
+    (Class (Class::*)( size_t, larcv3::PoolType_t ) const)( &Class::compress),
+    larcv3::release_gil());
 
   tensor.def(pybind11::self += float());
   tensor.def(pybind11::self + float());
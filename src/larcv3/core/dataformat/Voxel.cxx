@@ -4,13 +4,47 @@
 #include "larcv3/core/dataformat/Voxel.h"
 #include "larcv3/core/base/larbys.h"
 #include "larcv3/core/base/larcv_logger.h"
+#include "larcv3/core/base/larcv_base.h"
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 namespace larcv3 {
 
   Voxel::Voxel(VoxelID_t id, float value)
   { _id = id; _value = value; }
 
+  void Voxel::encode(const Voxel * voxels, size_t n, VoxelEncoding_t encoding,
+                     std::vector<unsigned int> & ids, std::vector<float> & values)
+  {
+    ids.reserve(ids.size() + n);
+    values.reserve(values.size() + n);
+    // Differences are taken modulo 2^32, so unsorted sets still decode exactly:
+    unsigned int previous = 0;
+    for (size_t i = 0; i < n; i ++){
+      if (voxels[i]._id > std::numeric_limits<unsigned int>::max()) {
+        LARCV_SCRITICAL() << "Voxel id " << voxels[i]._id
+                          << " does not fit the 32 bit voxel encoding, use kVoxelLegacy" << std::endl;
+        throw larbys();
+      }
+      unsigned int id = voxels[i]._id;
+      ids.push_back(encoding == kVoxelDelta32 ? id - previous : id);
+      values.push_back(voxels[i]._value);
+      previous = id;
+    }
+  }
+
+  void Voxel::decode(const unsigned int * ids, const float * values, size_t n, VoxelEncoding_t encoding,
+                     std::vector<Voxel> & voxels)
+  {
+    voxels.reserve(voxels.size() + n);
+    unsigned int id = 0;
+    for (size_t i = 0; i < n; i ++){
+      id = (encoding == kVoxelDelta32) ? id + ids[i] : ids[i];
+      voxels.emplace_back(id, values[i]);
+    }
+  }
+
   // VoxelSet::VoxelSet(pybind11::array_t<float> values, pybind11::array_t<size_t> indexes){
   //   // This constructor needs to create a Voxel from every value/index pair
 
@@ -175,6 +209,55 @@ namespace larcv3 {
     return;
   }
 
+  void VoxelSet::assign(const Voxel * first, const Voxel * last, const bool presorted)
+  {
+    _voxel_v.assign(first, last);
+    if (!presorted) sort();
+  }
+
+  void VoxelSet::assign(std::vector<larcv3::Voxel> && voxels, const bool presorted)
+  {
+    _voxel_v = std::move(voxels);
+    if (!presorted) sort();
+  }
+
+  bool VoxelSet::is_sorted() const
+  {
+    for (size_t i = 1; i < _voxel_v.size(); ++i) {
+      if ( !(_voxel_v[i-1] < _voxel_v[i]) ) return false;
+    }
+    return true;
+  }
+
+  void VoxelSet::sort()
+  {
+    reduce(kPoolSum);
+  }
+
+  void VoxelSet::reduce(PoolType_t pool_type)
+  {
+    if (_voxel_v.empty()) return;
+    // Stable, so repeated ids are summed in their original order like VoxelSet::add
+    std::stable_sort(_voxel_v.begin(), _voxel_v.end());
+
+    // Merge duplicates in place:
+    size_t last = 0;
+    for (size_t i = 1; i < _voxel_v.size(); ++i) {
+      if (_voxel_v[i].id() == _voxel_v[last].id()) {
+        if (pool_type == kPoolMax) {
+          if (_voxel_v[last].value() < _voxel_v[i].value()) _voxel_v[last] = _voxel_v[i];
+        }
+        else {
+          _voxel_v[last] += _voxel_v[i].value();
+        }
+      }
+      else {
+        _voxel_v[++last] = _voxel_v[i];
+      }
+    }
+    _voxel_v.resize(last + 1);
+  }
+
 
   // // Return a numpy array of this object (no copy by default)
   // template<size_t dimension>
@@ -448,13 +531,18 @@ pybind11::array_t<float> SparseTensor<dimension>::dense(){
   auto x = array.request();
   float * buf = (float *) x.ptr;
 
-  // Set all values to default to 0.0:
-  for (size_t i = 0; i < _meta.total_voxels(); ++i) buf[i] = 0.0;
+  // Only the allocation needs the GIL, filling the buffer does not:
+  {
+    pybind11::gil_scoped_release release;
 
-  for (auto & vox : _voxel_v){
-    buf[vox.id()] = vox.value();
+    // Set all values to default to 0.0:
+    for (size_t i = 0; i < _meta.total_voxels(); ++i) buf[i] = 0.0;
+
+    for (auto & vox : _voxel_v){
+      buf[vox.id()] = vox.value();
+    }
   }
-  
+
   return array;
 }
 
@@ -497,46 +585,34 @@ template<size_t dimension>
 SparseTensor<dimension> SparseTensor<dimension>::compress(
   std::array<size_t, dimension> compression, PoolType_t pool_type) const
 {
+  if (!this->_meta.is_valid()) {
+    LARCV_CRITICAL() << "Can't compress a sparse tensor with an invalid meta." << std::endl;
+    throw larbys();
+  }
   // First, compress the meta:
   auto compressed_meta = this->_meta.compress(compression);
-  // Create an output tensor:
-  SparseTensor<dimension> output;
-  output.meta(compressed_meta);
-  // Loop over the voxels, find the position in the new tensor, and add it.
-  for (auto & voxel : _voxel_v ){
-    // First, get the old coordinates of this voxel:
-    auto coordinates = this->_meta.coordinates(voxel.id());
+  auto const compressed_voxels = compressed_meta.number_of_voxels();
 
+  // Compute every target index in one pass.  Voxels that fall past the
+  // end of the compressed image (when compression doesn't divide it) are dropped.
+  std::vector<Voxel> pooled;
+  pooled.reserve(_voxel_v.size());
+  for (auto & voxel : _voxel_v ){
+    auto coordinates = this->_meta.unravel(voxel.id());
+    bool inside = true;
     for (size_t d = 0; d < dimension; d ++) {
       coordinates[d] = size_t(coordinates[d] / compression[d]);
+      inside = inside && coordinates[d] < compressed_voxels[d];
     }
-    size_t new_index = compressed_meta.index(coordinates);
-    // Add the new voxel to the new set:
-    if ( pool_type == larcv3::kPoolMax){
-      // Find if there is already a voxel:
-
-      auto found_voxel = output.find(new_index);
-      if ( found_voxel == larcv3::kINVALID_VOXEL::getInstance()){
-        // There is not a voxel, set this one:
-        output.insert(Voxel(new_index, voxel.value()));
-      }
-      else{
-        // There IS a voxel
-        if (found_voxel.value() < voxel.value()){
-          // Replace only if this new value is larger than the old
-          output.insert(Voxel(new_index, voxel.value()));
-        } 
-      }
-    }
-    else if ( pool_type == larcv3::kPoolAverage){
-      output.emplace(std::move(Voxel(new_index, voxel.value())), true);
-    }
-    else if (pool_type == larcv3::kPoolSum){
-      output.emplace(std::move(Voxel(new_index, voxel.value())), true);
-
-    }
+    if (inside) pooled.emplace_back(compressed_meta.ravel(coordinates), voxel.value());
   }
 
+  // Then reduce by key, which leaves the output sorted:
+  SparseTensor<dimension> output;
+  output.meta(compressed_meta);
+  output.assign(std::move(pooled));
+  output.reduce(pool_type);
+
   // Correct the output values by the total ratio of compression if averaging:
   if (pool_type == larcv3::kPoolAverage){
     float ratio = 1.0;
@@ -561,6 +637,23 @@ SparseTensor<dimension> SparseTensor<dimension>::compress(
 }
 
 
+template<size_t dimension>
+std::vector<SparseTensor<dimension> > SparseTensor<dimension>::compress_levels(
+  size_t compression, size_t levels, PoolType_t pool_type) const
+{
+  // Each level is pooled from the (smaller) level before it, not from the original.
+  // Sums, maxima and block averages all compose this way.
+  std::vector<SparseTensor<dimension> > output;
+  output.reserve(levels);
+  for (size_t level = 0; level < levels; level ++){
+    const SparseTensor<dimension> & previous = level == 0 ? *this : output.back();
+    SparseTensor<dimension> compressed = previous.compress(compression, pool_type);
+    output.emplace_back(std::move(compressed));
+  }
+  return output;
+}
+
+
 template<size_t dimension>
 SparseCluster<dimension>::SparseCluster(VoxelSetArray&& vsa, ImageMeta<dimension> meta)
 : VoxelSetArray(std::move(vsa))
@@ -637,6 +730,9 @@ void init_voxel_core(pybind11::module m){
     voxelset.def("add",            &VS::add);
     voxelset.def("insert",         &VS::insert);
     voxelset.def("emplace",        (void (VS::*)(larcv3::VoxelID_t, float, const bool))(&VS::emplace));
+    voxelset.def("is_sorted",      &VS::is_sorted);
+    voxelset.def("sort",           &VS::sort,   larcv3::release_gil());
+    voxelset.def("reduce",         &VS::reduce, larcv3::release_gil());
 
 
     voxelset.def(pybind11::self += float());
@@ -690,11 +786,15 @@ void init_sparse_tensor(pybind11::module m){
     sparsetensor.def("set",        &ST::set);
     sparsetensor.def("clear_data", &ST::clear_data);
     sparsetensor.def("dense",      &ST::dense);
-    sparsetensor.def("to_tensor",  &ST::to_tensor);
+    // dense() makes a numpy array, so it releases the GIL internally instead
+    sparsetensor.def("to_tensor",  &ST::to_tensor, larcv3::release_gil());
     sparsetensor.def("compress",
-      (ST (ST::*)(std::array<size_t, dimension> compression, larcv3::PoolType_t)const)(&ST::compress));
+      (ST (ST::*)(std::array<size_t, dimension> compression, larcv3::PoolType_t)const)(&ST::compress),
+      larcv3::release_gil());
     sparsetensor.def("compress", 
-      (ST (ST::*)( size_t, larcv3::PoolType_t ) const)( &ST::compress));
+      (ST (ST::*)( size_t, larcv3::PoolType_t ) const)( &ST::compress),
+      larcv3::release_gil());
+    sparsetensor.def("compress_levels", &ST::compress_levels, larcv3::release_gil());
 
 /*
   Not wrapped:
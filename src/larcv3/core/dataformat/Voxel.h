@@ -104,6 +104,21 @@ namespace larcv3 {
       return datatype;
     }
 
+    /// Name of the dataset that identifies each encoding in a sparse product's group.
+    /// The compact encodings store the values in a second dataset, "voxel_values".
+    static const char * dataset_name(VoxelEncoding_t encoding) {
+      return encoding == kVoxelLegacy  ? "voxels"
+           : encoding == kVoxelIndex32 ? "voxel_ids" : "voxel_id_deltas";
+    }
+
+    /// Append n voxels to the 32 bit id and float value columns of a compact encoding.
+    /// With kVoxelDelta32 the ids are stored as differences within this call, so call it once per voxel set.
+    static void encode(const Voxel * voxels, size_t n, VoxelEncoding_t encoding,
+                       std::vector<unsigned int> & ids, std::vector<float> & values);
+    /// Inverse of encode: append n voxels, decoded from one voxel set's columns, to voxels
+    static void decode(const unsigned int * ids, const float * values, size_t n, VoxelEncoding_t encoding,
+                       std::vector<Voxel> & voxels);
+
 
   };
 
@@ -223,6 +238,18 @@ namespace larcv3 {
     { emplace(Voxel(id,value),add); }
     /// InstanceID_t setter
     inline void id(const InstanceID_t id) { _id = id; }
+    /// Bulk replace the contents with a range of voxels. If presorted, the range must
+    /// already be strictly ascending in VoxelID and is copied in directly.
+    void assign(const Voxel * first, const Voxel * last, const bool presorted=true);
+    /// Same as above, but takes ownership of the vector instead of copying
+    void assign(std::vector<larcv3::Voxel> && voxels, const bool presorted=true);
+    /// Check that voxels are strictly ascending in VoxelID (the invariant assumed by find)
+    bool is_sorted() const;
+    /// Restore the ordering invariant: sort by VoxelID and sum values of duplicate ids
+    void sort();
+    /// Sort by VoxelID and combine voxels sharing an id in one pass: values are summed
+    /// for kPoolSum and kPoolAverage, and the largest one is kept for kPoolMax
+    void reduce(PoolType_t pool_type);
 
 #ifdef LARCV_INTERNAL
 
@@ -345,6 +372,8 @@ namespace larcv3 {
     // Accepts either an array of values, one per dimension, or a single value
     SparseTensor<dimension> compress(std::array<size_t, dimension> compression, PoolType_t) const;
     SparseTensor<dimension> compress(size_t compression, PoolType_t) const;
+    // Return levels sparse tensors, each one compressed by compression from the one before it
+    std::vector<SparseTensor<dimension> > compress_levels(size_t compression, size_t levels, PoolType_t) const;
 
     //
     // Write-access
@@ -58,5 +58,6 @@ void init_dataformat(pybind11::module m){
     init_eventsparsecluster(m);
     init_eventsparsetensor(m);
     init_eventtensor(m);
+    init_manifest(m);
     init_iomanager(m);
 }
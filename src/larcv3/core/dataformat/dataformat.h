@@ -26,6 +26,7 @@
 #include "EventTensor.h"
 #include "ImageMeta.h"
 #include "IOManager.h"
+#include "Manifest.h"
 #include "Particle.h"
 #include "Point.h"
 #include "Tensor.h"
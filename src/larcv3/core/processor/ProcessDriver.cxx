@@ -15,6 +15,7 @@ ProcessDriver::ProcessDriver(std::string name)
       _batch_num_entry(0),
       _enable_filter(false),
       _random_access(0),
+      _use_shard_sampler(false),
       _proc_v(),
       _processing(false) {
       }
@@ -24,6 +25,7 @@ void ProcessDriver::reset() {
   _io.reset();
   _enable_filter = false;
   _random_access = 0;
+  _use_shard_sampler = false;
   for (size_t i = 0; i < _proc_v.size(); ++i) {
     delete _proc_v[i];
     _proc_v[i] = nullptr;
@@ -162,6 +164,12 @@ void ProcessDriver::configure(const PSet& cfg) {
     if (random_access_int != 0) _random_access = random_access_int;
   } catch (...) {
   }
+  _use_shard_sampler = cfg.contains_pset("ShardSampler");
+  if (_use_shard_sampler) {
+    _shard_sampler.configure(cfg.get<larcv3::PSet>("ShardSampler"));
+    if (_random_access != 0)
+      LARCV_WARNING() << "RandomAccess is ignored, the ShardSampler chooses the order of entries" << std::endl;
+  }
   _batch_start_entry = cfg.get<int>("StartEntry", 0);
   _batch_num_entry = cfg.get<int>("NumEntries", 0);
   // Process list
@@ -285,11 +293,37 @@ void ProcessDriver::initialize(int color) {
       std::shuffle(_access_entry_v.begin(), _access_entry_v.end(),
                    std::default_random_engine(seed));
     }
+    if (_use_shard_sampler) {
+      _shard_sampler.set_input(_io);
+      _apply_shard_();
+    }
   }
 
   _current_entry = 0;
 }
 
+void ProcessDriver::set_shard(size_t shard, size_t n_shards) {
+  _shard_sampler.set_shard(shard, n_shards);
+  if (!_use_shard_sampler && _processing)
+    _shard_sampler.set_input(_io);
+  _use_shard_sampler = true;
+  if (_processing) _apply_shard_();
+}
+
+void ProcessDriver::set_epoch(size_t epoch) {
+  if (!_use_shard_sampler) {
+    LARCV_CRITICAL() << "Epochs need a shard, call set_shard or configure a ShardSampler" << std::endl;
+    throw larbys();
+  }
+  _shard_sampler.set_epoch(epoch);
+  if (_processing) _apply_shard_();
+}
+
+void ProcessDriver::_apply_shard_() {
+  _access_entry_v = _shard_sampler.entries();
+  _current_entry = 0;
+}
+
 bool ProcessDriver::_process_entry_() {
   // Private method to execute processes and change entry number record
   // This method does not perform any sanity check, hence private and
@@ -378,6 +412,23 @@ bool ProcessDriver::process_entry(size_t entry, bool force_reload) {
   return _process_entry_();
 }
 
+bool ProcessDriver::read_entries(const std::vector<size_t>& entries) {
+  LARCV_DEBUG() << "Called" << std::endl;
+
+  if (!_processing) {
+    LARCV_CRITICAL() << "Must call initialize() before start processing!"
+                     << std::endl;
+    throw larbys();
+  }
+  if (_io.io_mode() != IOManager::kREAD) return false;
+
+  std::vector<size_t> access_entries;
+  access_entries.reserve(entries.size());
+  for (auto const& entry : entries)
+    if (entry < _access_entry_v.size()) access_entries.push_back(_access_entry_v[entry]);
+  return _io.read_entries(access_entries);
+}
+
 void ProcessDriver::batch_process(size_t start_entry, size_t num_entries) {
   LARCV_DEBUG() << "Called" << std::endl;
   // Public method to execute num_entries starting from start_entry
@@ -498,27 +549,38 @@ void init_processdriver(pybind11::module m){
                     pybind11::arg("name")   = "ProcessDriver");
 
 
+    // Configuration, file handling and processing run without the GIL.
+    // No processes are implemented in python, so nothing below calls back into it.
     processdriver.def("configure",
-      (void (Class::*)( const std::string config_file ) )(&Class::configure));
+      (void (Class::*)( const std::string config_file ) )(&Class::configure),
+      larcv3::release_gil());
     processdriver.def("configure", 
-      (void (Class::*)( const larcv3::PSet& cfg))(&Class::configure));
+      (void (Class::*)( const larcv3::PSet& cfg))(&Class::configure),
+      larcv3::release_gil());
 
     processdriver.def("override_input_file", &Class::override_input_file);
     processdriver.def("override_output_file", &Class::override_output_file);
     processdriver.def("override_ana_file", &Class::override_ana_file);
     processdriver.def("random_access", &Class::random_access);
     processdriver.def("reset", &Class::reset);
-    processdriver.def("initialize", &Class::initialize,pybind11::arg("color")=0);
+    processdriver.def("initialize", &Class::initialize,pybind11::arg("color")=0,
+      larcv3::release_gil());
     processdriver.def("batch_process", &Class::batch_process,
-      pybind11::arg("start_entry")=0, pybind11::arg("num_entries")=0);
+      pybind11::arg("start_entry")=0, pybind11::arg("num_entries")=0,
+      larcv3::release_gil());
 
     processdriver.def("process_entry",
-      (bool (Class::*)() )(&Class::process_entry));
+      (bool (Class::*)() )(&Class::process_entry),
+      larcv3::release_gil());
     processdriver.def("process_entry", 
       (bool (Class::*)( size_t, bool))(&Class::process_entry),
-      pybind11::arg("entry"), pybind11::arg("force_reload")=false);
+      pybind11::arg("entry"), pybind11::arg("force_reload")=false,
+      larcv3::release_gil());
+    processdriver.def("read_entries", &Class::read_entries,
+      pybind11::arg("entries"),
+      larcv3::release_gil());
 
-    processdriver.def("finalize", &Class::finalize);
+    processdriver.def("finalize", &Class::finalize, larcv3::release_gil());
     processdriver.def("clear_entry", &Class::clear_entry);
     processdriver.def("set_id", &Class::set_id);
     processdriver.def("event_id", &Class::event_id);
@@ -526,9 +588,16 @@ void init_processdriver(pybind11::module m){
     processdriver.def("process_names", &Class::process_names);
     processdriver.def("process_map", &Class::process_map);
     processdriver.def("process_ptr", &Class::process_ptr);
-    processdriver.def("io", &Class::io);
+    processdriver.def("io", &Class::io,
+      pybind11::return_value_policy::reference_internal);
     processdriver.def("get_tree_index", &Class::get_tree_index);
     processdriver.def("processing", &Class::processing);
+    processdriver.def("set_shard", &Class::set_shard,
+      pybind11::arg("shard"), pybind11::arg("n_shards"));
+    processdriver.def("set_epoch", &Class::set_epoch);
+    processdriver.def("sharded", &Class::sharded);
+    processdriver.def("shard_sampler", &Class::shard_sampler,
+      pybind11::return_value_policy::reference_internal);
 
 
 }
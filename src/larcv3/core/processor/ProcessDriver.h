@@ -17,6 +17,7 @@
 #include <vector>
 #include "larcv3/core/dataformat/IOManager.h"
 #include "larcv3/core/processor/ProcessBase.h"
+#include "larcv3/core/processor/ShardSampler.h"
 
 namespace larcv3 {
   /**
@@ -50,6 +51,11 @@ namespace larcv3 {
     void override_ana_file(const std::string fname);
     /// When needs to override the randomized event access in IO from what's specified in the configuration
     void random_access(int flag) { _random_access = flag; }
+    /// Read only this rank's shard of the input (see ShardSampler), instead of every entry.
+    /// Also configured by a ShardSampler block.  Restarts the event loop if already initialized.
+    void set_shard(size_t shard, size_t n_shards);
+    /// Read the shard of a new epoch.  Restarts the event loop.
+    void set_epoch(size_t epoch);
 
     //
     // Process flow execution methods
@@ -67,6 +73,8 @@ namespace larcv3 {
        If calling this function with the same entry twice, the 2nd bloolean can be used to force re-loading data from disk.
     */
     bool process_entry(size_t entry,bool force_reload=false);
+    /// Read ahead the input of entries (as passed to process_entry) that are processed next, see IOManager::read_entries
+    bool read_entries(const std::vector<size_t>& entries);
     /// Must be called after initialize() or process_entry/batch_process. Closes IO and calls finalize method of process modules.
     void finalize();
 
@@ -98,16 +106,24 @@ namespace larcv3 {
     size_t get_tree_index( size_t entry ) const;
     /// Returns true if after any entry is processed (process_entry/batch_process) but not yet finalized
     inline bool processing() const { return _processing; }
+    /// Returns true if only a shard of the input is read
+    inline bool sharded() const { return _use_shard_sampler; }
+    /// Returns the sampler choosing the shard
+    inline const ShardSampler& shard_sampler() const { return _shard_sampler; }
 
   protected:
 
     bool _process_entry_();
+    /// Replace the entries to access with the shard sampler's
+    void _apply_shard_();
     size_t _batch_start_entry;
     size_t _batch_num_entry;
     size_t _current_entry;
     bool _enable_filter;
     int _random_access;
     std::vector<size_t> _access_entry_v;
+    bool _use_shard_sampler;
+    ShardSampler _shard_sampler;
     IOManager _io;
     std::map<std::string,larcv3::ProcessID_t> _proc_m;
     std::vector<larcv3::ProcessBase*> _proc_v;
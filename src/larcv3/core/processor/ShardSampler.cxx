@@ -0,0 +1,205 @@
+#ifndef __LARCV3PROCESSOR_SHARDSAMPLER_CXX
+#define __LARCV3PROCESSOR_SHARDSAMPLER_CXX
+
+#include "larcv3/core/processor/ShardSampler.h"
+#include "larcv3/core/base/larbys.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace larcv3 {
+
+ShardSampler::ShardSampler(std::string name)
+    : larcv_base(name),
+      _shard(0),
+      _n_shards(1),
+      _batch_size(0),
+      _align_to_files(true),
+      _shuffle(true),
+      _seed(0),
+      _group_size(1),
+      _window(0),
+      _epoch(0),
+      _next_entry(0) {}
+
+void ShardSampler::configure(const PSet& cfg) {
+  set_verbosity((msg::Level_t)(cfg.get<unsigned short>("Verbosity", logger().level())));
+
+  _n_shards       = cfg.get<size_t>("NumShards", 1);
+  _shard          = cfg.get<size_t>("Shard", 0);
+  _batch_size     = cfg.get<size_t>("BatchSize", 0);
+  _align_to_files = cfg.get<bool>("AlignToFiles", true);
+  _shuffle        = cfg.get<bool>("Shuffle", true);
+  _seed           = cfg.get<unsigned int>("Seed", 0);
+  _group_size     = cfg.get<size_t>("GroupSize", 1);
+  _window         = cfg.get<size_t>("Window", 0);
+  _chunk_product  = cfg.get<std::string>("ChunkProduct", "");
+  _chunk_producer = cfg.get<std::string>("ChunkProducer", "");
+
+  _epoch = 0;
+  set_shard(_shard, _n_shards);
+}
+
+void ShardSampler::set_shard(size_t shard, size_t n_shards, size_t batch_size) {
+  if (n_shards == 0 || shard >= n_shards) {
+    LARCV_CRITICAL() << "Invalid shard " << shard << " of " << n_shards << std::endl;
+    throw larbys();
+  }
+  _shard = shard;
+  _n_shards = n_shards;
+  if (batch_size) _batch_size = batch_size;
+  set_epoch(_epoch);
+}
+
+void ShardSampler::set_file_entries(const std::vector<size_t>& file_entries) {
+  _file_entries_v = file_entries;
+  set_epoch(_epoch);
+}
+
+void ShardSampler::set_input(const IOManager& io) {
+  if (!_group_size) {
+    _group_size = io.entries_per_chunk(_chunk_product, _chunk_producer);
+    LARCV_NORMAL() << "Shuffling groups of " << _group_size << " entries" << std::endl;
+  }
+  set_file_entries(io.get_n_entries_per_file());
+}
+
+void ShardSampler::set_epoch(size_t epoch) {
+  _epoch = epoch;
+  _next_entry = 0;
+  _entry_v.clear();
+
+  size_t total = std::accumulate(_file_entries_v.begin(), _file_entries_v.end(), size_t(0));
+  if (!total) return;
+
+  size_t shard_size = total / _n_shards;
+  if (!shard_size) {
+    LARCV_CRITICAL() << "Can't split " << total << " entries into " << _n_shards << " shards" << std::endl;
+    throw larbys();
+  }
+  size_t first = _shard * shard_size;
+  size_t last  = first + shard_size;
+
+  if (!_group_size) {
+    LARCV_CRITICAL() << "GroupSize 0 needs the input chunking, call set_input" << std::endl;
+    throw larbys();
+  }
+
+  std::vector<size_t> file_offsets(_file_entries_v.size(), 0);
+  for (size_t i_file = 1; i_file < _file_entries_v.size(); ++i_file)
+    file_offsets[i_file] = file_offsets[i_file - 1] + _file_entries_v[i_file - 1];
+
+  // The permutation is of whole files, or of groups (single entries by default),
+  // as (first entry, entries) pairs:
+  std::vector<std::pair<size_t, size_t> > unit_v;
+  for (size_t i_file = 0; i_file < _file_entries_v.size(); ++i_file) {
+    size_t n_entries = _file_entries_v[i_file];
+    size_t unit = _align_to_files ? n_entries : _group_size;
+    for (size_t local = 0; local < n_entries; local += unit)
+      unit_v.emplace_back(file_offsets[i_file] + local, std::min(unit, n_entries - local));
+  }
+
+  // Every shard draws the same permutation, and keeps [first, last) of it:
+  std::seed_seq seed{_seed, (unsigned int)(_epoch)};
+  std::mt19937_64 generator(seed);
+  if (_shuffle) std::shuffle(unit_v.begin(), unit_v.end(), generator);
+
+  _entry_v.reserve(shard_size);
+  size_t position = 0;
+  for (auto const& unit : unit_v) {
+    size_t begin = std::max(position, first);
+    size_t end   = std::min(position + unit.second, last);
+    for (size_t p = begin; p < end; ++p)
+      _entry_v.push_back(unit.first + p - position);
+    position += unit.second;
+    if (position >= last) break;
+  }
+
+  // The order within a shard is its own:
+  if (_shuffle) {
+    std::seed_seq shard_seed{_seed, (unsigned int)(_epoch), (unsigned int)(_shard + 1)};
+    std::mt19937_64 shard_generator(shard_seed);
+    if (_group_size > 1)
+      block_shuffle(file_offsets, shard_generator);
+    else
+      std::shuffle(_entry_v.begin(), _entry_v.end(), shard_generator);
+  }
+
+  LARCV_INFO() << "Epoch " << _epoch << ": shard " << _shard << " of " << _n_shards
+               << " has " << _entry_v.size() << " of " << total << " entries" << std::endl;
+}
+
+void ShardSampler::block_shuffle(const std::vector<size_t>& file_offsets, std::mt19937_64& generator) {
+  // Runs of consecutive entries, cut where a group starts in its file:
+  std::vector<std::pair<size_t, size_t> > group_v;
+  for (size_t i = 0; i < _entry_v.size(); ++i) {
+    size_t entry = _entry_v[i];
+    size_t i_file = std::upper_bound(file_offsets.begin(), file_offsets.end(), entry)
+                    - file_offsets.begin() - 1;
+    if (i == 0 || entry != _entry_v[i - 1] + 1 || (entry - file_offsets[i_file]) % _group_size == 0)
+      group_v.emplace_back(entry, 0);
+    group_v.back().second++;
+  }
+  std::shuffle(group_v.begin(), group_v.end(), generator);
+
+  _entry_v.clear();
+  for (auto const& group : group_v)
+    for (size_t entry = group.first; entry < group.first + group.second; ++entry)
+      _entry_v.push_back(entry);
+
+  // Mix the neighbouring groups, one window at a time:
+  size_t window_size = window();
+  for (size_t begin = 0; begin < _entry_v.size(); begin += window_size) {
+    size_t end = std::min(begin + window_size, _entry_v.size());
+    std::shuffle(_entry_v.begin() + begin, _entry_v.begin() + end, generator);
+  }
+}
+
+std::vector<size_t> ShardSampler::next_batch() {
+  if (!_batch_size) {
+    LARCV_CRITICAL() << "BatchSize must be set to draw batches!" << std::endl;
+    throw larbys();
+  }
+  if (_entry_v.size() < _batch_size) {
+    LARCV_CRITICAL() << "Shard " << _shard << " has " << _entry_v.size()
+                     << " entries, less than a batch of " << _batch_size << std::endl;
+    throw larbys();
+  }
+  // Every shard has the same number of full batches, the rest of the epoch is dropped:
+  if (_next_entry + _batch_size > _entry_v.size()) set_epoch(_epoch + 1);
+
+  std::vector<size_t> batch(_entry_v.begin() + _next_entry,
+                            _entry_v.begin() + _next_entry + _batch_size);
+  _next_entry += _batch_size;
+  return batch;
+}
+
+}  // namespace larcv3
+
+#include <pybind11/stl.h>
+
+void init_shardsampler(pybind11::module m){
+    using Class = larcv3::ShardSampler;
+    pybind11::class_<Class> shardsampler(m, "ShardSampler");
+    shardsampler.def(pybind11::init<const std::string>(),
+                    pybind11::arg("name")   = "ShardSampler");
+
+    shardsampler.def("configure", &Class::configure);
+    shardsampler.def("set_shard", &Class::set_shard,
+      pybind11::arg("shard"), pybind11::arg("n_shards"), pybind11::arg("batch_size")=0);
+    shardsampler.def("set_file_entries", &Class::set_file_entries);
+    shardsampler.def("set_input", &Class::set_input);
+    shardsampler.def("set_epoch", &Class::set_epoch);
+    shardsampler.def("entries", &Class::entries);
+    shardsampler.def("next_batch", &Class::next_batch);
+    shardsampler.def("epoch", &Class::epoch);
+    shardsampler.def("shard", &Class::shard);
+    shardsampler.def("n_shards", &Class::n_shards);
+    shardsampler.def("batch_size", &Class::batch_size);
+    shardsampler.def("group_size", &Class::group_size);
+    shardsampler.def("window", &Class::window);
+    shardsampler.def("n_batches", &Class::n_batches);
+    shardsampler.def("n_sampled", &Class::n_sampled);
+}
+
+#endif
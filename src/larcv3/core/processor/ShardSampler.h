@@ -0,0 +1,111 @@
+/**
+ * \file ShardSampler.h
+ *
+ * \ingroup core_Processor
+ *
+ * \brief Class def header for a class larcv3::ShardSampler
+ *
+ * @author cadams
+ */
+
+/** \addtogroup core_Processor
+
+    @{*/
+#ifndef __LARCV3PROCESSOR_SHARDSAMPLER_H
+#define __LARCV3PROCESSOR_SHARDSAMPLER_H
+
+#include <vector>
+#include <random>
+#include "larcv3/core/base/larcv_base.h"
+#include "larcv3/core/base/PSet.h"
+#include "larcv3/core/dataformat/IOManager.h"
+
+namespace larcv3 {
+  /**
+     \class ShardSampler
+     @brief Splits the entries into NumShards disjoint shards, one per rank, without communication.
+
+     Every rank draws the same permutation of the input from a generator seeded with
+     (Seed, epoch), and keeps its own slice of it.  With AlignToFiles the permutation is
+     of whole files, so each shard covers a run of about n_files/NumShards files;
+     otherwise it is of entries.  All shards have total/NumShards entries, so every rank
+     has the same number of batches per epoch, and the remainder of an epoch (fewer than
+     NumShards entries, different ones every epoch) is left out.  A shard is shuffled
+     before it is read unless Shuffle is false.
+
+     With a GroupSize above 1 the shuffle keeps some locality, for inputs that are read
+     a compressed chunk at a time: the entries are cut into groups of GroupSize that
+     start at multiples of GroupSize in each file, the groups (not the entries) are
+     permuted, and then the entries are shuffled inside consecutive windows of Window
+     entries (8 groups by default).  Reading a window decompresses about Window/GroupSize
+     chunks once each, instead of one chunk per entry.  GroupSize 0 takes the number of
+     entries per chunk of ChunkProduct/ChunkProducer (or of the biggest product) from the
+     input, see IOManager::entries_per_chunk.  Without AlignToFiles the shards are also
+     cut from a permutation of groups rather than of entries.
+  */
+  class ShardSampler : public larcv_base {
+
+  public:
+
+    /// Default constructor
+    ShardSampler(std::string name = "ShardSampler");
+    /// Default destructor
+    ~ShardSampler(){}
+
+    void configure(const PSet& cfg);
+
+    /// Select this rank's shard, and its batch size (0 keeps the configured one)
+    void set_shard(size_t shard, size_t n_shards, size_t batch_size = 0);
+    /// Entries in each input file, in order
+    void set_file_entries(const std::vector<size_t>& file_entries);
+    /// Entries in each input file of io, and the group size from its chunking if GroupSize is 0
+    void set_input(const IOManager& io);
+    /// Draw the shard of the given epoch, and restart its batches
+    void set_epoch(size_t epoch);
+
+    /// Entries of this rank's shard in the current epoch, in reading order
+    inline const std::vector<size_t>& entries() const { return _entry_v; }
+
+    /// Next BatchSize entries of the shard.  Starts the next epoch when fewer are left.
+    std::vector<size_t> next_batch();
+
+    inline size_t epoch() const { return _epoch; }
+    inline size_t shard() const { return _shard; }
+    inline size_t n_shards() const { return _n_shards; }
+    inline size_t batch_size() const { return _batch_size; }
+    inline size_t group_size() const { return _group_size; }
+    inline size_t window() const { return _window ? _window : 8 * _group_size; }
+    /// Full batches per epoch, and how many of this epoch's were handed out
+    inline size_t n_batches() const { return _batch_size ? _entry_v.size() / _batch_size : 0; }
+    inline size_t n_sampled() const { return _batch_size ? _next_entry / _batch_size : 0; }
+
+  private:
+
+    /// Permute the groups of the shard, then shuffle it a window at a time
+    void block_shuffle(const std::vector<size_t>& file_offsets, std::mt19937_64& generator);
+
+    size_t _shard;
+    size_t _n_shards;
+    size_t _batch_size;
+    bool _align_to_files;
+    bool _shuffle;
+    unsigned int _seed;
+    size_t _group_size;
+    size_t _window;
+    std::string _chunk_product;
+    std::string _chunk_producer;
+
+    std::vector<size_t> _file_entries_v;
+    size_t _epoch;
+    size_t _next_entry;
+    std::vector<size_t> _entry_v;
+  };
+}
+
+#ifdef LARCV_INTERNAL
+#include <pybind11/pybind11.h>
+void init_shardsampler(pybind11::module m);
+#endif
+
+#endif
+/** @} */ // end of doxygen group
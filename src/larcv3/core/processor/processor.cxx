@@ -4,6 +4,7 @@
 
 void init_processor(pybind11::module m){
     init_processbase(m);
+    init_shardsampler(m);
     init_processdriver(m);
 }
 
@@ -17,6 +17,7 @@
 
 #include "ProcessBase.h"
 #include "ProcessDriver.h"
+#include "ShardSampler.h"
 
 
 #ifndef LARCV_NO_PYBIND
@@ -2,6 +2,7 @@ import pytest
 import unittest
 import random
 import uuid
+import numpy
 
 import larcv
 from larcv import queueloader,  data_generator
@@ -87,6 +88,153 @@ def test_sparsetensor2d_queueio(tmpdir, make_copy, batch_size, n_projections, n_
         assert(data['label'].shape[0] == batch_size)
 
 
+def read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads, extra_config, make_copy=True):
+
+    # Read the first n_reads batches in order, with augmentation off and
+    # extra_config added to the top level of the queueio configuration
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    config_contents = queue_io_sparsetensor2d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        channels    = list(range(n_projections)),
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100", "MaxVoxels: 100\n      Augment: false")
+    config_contents = config_contents.replace("RandomSeed:      0", "RandomSeed:      0\n  " + extra_config)
+
+    config_file = tmpdir + "/test_queueio_sparsetensor2d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : make_copy
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface(random_access_mode="serial_access")
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+    reads = []
+    for i in range(n_reads):
+        reads.append(li.fetch_minibatch_data('primary', pop=True)['label'])
+        li.prepare_next('primary')
+    return reads
+
+
+@pytest.mark.parametrize('num_workers', [2, 3])
+def test_sparsetensor2d_queueio_num_workers(tmpdir, num_workers, batch_size=4, n_projections=2, n_reads=5):
+
+    # Parallel batch assembly must give exactly the serial result when augmentation is off
+    file_name = str(tmpdir + "/test_queueio_sparsetensor2d_workers.h5")
+    create_sparsetensor2d_file(file_name, rand_num_events=25, n_projections=n_projections)
+
+    serial   = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        "NumWorkers:      1")
+    parallel = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        "NumWorkers:      {}".format(num_workers))
+
+    for s, p in zip(serial, parallel):
+        assert((s == p).all())
+
+
+@pytest.mark.parametrize('queue_depth', [2, 4])
+def test_sparsetensor2d_queueio_queue_depth(tmpdir, queue_depth, batch_size=4, n_projections=2, n_reads=7):
+
+    # Preparing several batches ahead must not change which batches come out, or their order
+    file_name = str(tmpdir + "/test_queueio_sparsetensor2d_depth.h5")
+    create_sparsetensor2d_file(file_name, rand_num_events=25, n_projections=n_projections)
+
+    shallow = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        "QueueDepth:      1")
+    deep    = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        "QueueDepth:      {}".format(queue_depth))
+
+    for s, d in zip(shallow, deep):
+        assert((s == d).all())
+
+
+@pytest.mark.parametrize('queue_depth', [1, 3])
+def test_sparsetensor2d_queueio_zero_copy(tmpdir, queue_depth, batch_size=4, n_projections=2, n_reads=7):
+
+    # Zero-copy views are shaped like the batch and keep their data after the
+    # queue pops and refills the slot they came from
+    file_name = str(tmpdir + "/test_queueio_sparsetensor2d_zero_copy.h5")
+    create_sparsetensor2d_file(file_name, rand_num_events=25, n_projections=n_projections)
+
+    extra_config = "QueueDepth:      {}".format(queue_depth)
+    copies = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        extra_config, make_copy=True)
+    views  = read_sparsetensor2d_serial(tmpdir, file_name, batch_size, n_projections, n_reads,
+        extra_config, make_copy=False)
+
+    for c, v in zip(copies, views):
+        assert(c.shape == v.shape)
+        assert((c == v).all())
+
+
+@pytest.mark.parametrize('make_copy', [True, False])
+@pytest.mark.parametrize('merge_channels', [True, False])
+def test_sparsetensor2d_queueio_sparse_conv(tmpdir, make_copy, merge_channels, batch_size=4, n_projections=2, n_reads=5):
+
+    # Sparse convolution batches are int32 coordinates, batch index first, and float features
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    file_name = str(tmpdir + "/test_queueio_sparsetensor2d_{}.h5".format(queueio_name))
+    create_sparsetensor2d_file(file_name, rand_num_events=25, n_projections=n_projections)
+    events = data_generator.read_sparse_tensors(file_name, 2)
+
+    config_contents = queue_io_sparsetensor2d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        channels    = list(range(n_projections)),
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100",
+        "SparseConvFormat: true\n      MergeChannels: {}".format(str(merge_channels).lower()))
+
+    config_file = tmpdir + "/test_queueio_sparsetensor2d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : make_copy
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+    for i in range(n_reads):
+        data = li.fetch_minibatch_data('primary', pop=True, fetch_meta_data=True)
+        li.prepare_next('primary')
+        offsets     = data['label_offsets']
+        coordinates = data['label_coordinates']
+        features    = data['label']
+        assert(coordinates.dtype == numpy.int32)
+        assert(coordinates.shape == (offsets[-1], 3 if merge_channels else 4))
+        assert(features.shape == (offsets[-1], n_projections if merge_channels else 1))
+        for j, entry in enumerate(data['entries']):
+            if merge_channels:
+                n_rows = len(set().union(*[ p['indexes'] for p in events[entry] ]))
+            else:
+                n_rows = sum([ p['n_voxels'] for p in events[entry] ])
+            assert(offsets[j+1] - offsets[j] == n_rows)
+            assert((coordinates[offsets[j]:offsets[j+1], 0] == j).all())
+
+
 if __name__ == "__main__":
     test_sparsetensor2d_queueio("./", make_copy=False, batch_size=2, n_projections=1, n_reads=10)
     test_sparsetensor2d_queueio("./", make_copy=False, batch_size=2, n_projections=2, n_reads=10)
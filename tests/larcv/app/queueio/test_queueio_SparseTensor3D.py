@@ -86,6 +86,239 @@ def test_sparsetensor3d_queueio(tmpdir, make_copy, batch_size, n_reads=10):
         assert(data['label'].shape[0] == batch_size)
 
 
+@pytest.mark.parametrize('make_copy', [True, False])
+@pytest.mark.parametrize('batch_size', [2, 5])
+def test_sparsetensor3d_queueio_ragged(tmpdir, make_copy, batch_size, n_reads=10):
+
+    # Ragged batches hold every voxel of every entry, with per-entry offsets
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    file_name = str(tmpdir + "/test_queueio_sparsetensor3d_{}.h5".format(queueio_name))
+    create_sparsetensor3d_file(file_name, rand_num_events=25)
+    n_voxels = [ event[0]['n_voxels'] for event in data_generator.read_sparse_tensors(file_name, 3) ]
+
+    config_contents = queue_io_sparsetensor3d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100", "Ragged: true")
+
+    config_file = tmpdir + "/test_queueio_sparsetensor3d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : make_copy
+    }
+
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+    for i in range(n_reads):
+        data = li.fetch_minibatch_data('primary', pop=True, fetch_meta_data=True)
+        li.prepare_next('primary')
+        offsets = data['label_offsets']
+        assert(len(offsets) == batch_size + 1)
+        assert(data['label'].shape == (offsets[-1], 4))
+        for j, entry in enumerate(data['entries']):
+            assert(offsets[j+1] - offsets[j] == n_voxels[entry])
+
+
+@pytest.mark.parametrize('voxel_budget', [0, 150])
+def test_sparsetensor3d_queueio_sampler(tmpdir, voxel_budget, batch_size=4):
+
+    # A Sampler picks batches of similar-size entries from the manifest's voxel
+    # counts: every epoch reads each entry once, and budgets are respected
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    file_name = str(tmpdir + "/test_queueio_sparsetensor3d_{}.h5".format(queueio_name))
+    create_sparsetensor3d_file(file_name, rand_num_events=25)
+    n_voxels = [ event[0]['n_voxels'] for event in data_generator.read_sparse_tensors(file_name, 3) ]
+
+    manifest_name = str(tmpdir + "/test_queueio_sparsetensor3d_{}_manifest.h5".format(queueio_name))
+    manifest = larcv.Manifest()
+    manifest.build([file_name])
+    manifest.write(manifest_name)
+
+    config_contents = queue_io_sparsetensor3d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100", "Ragged: true")
+    config_contents = config_contents.replace("RandomSeed:      0", """RandomSeed:      0
+  Manifest:        "{}"
+  Sampler: {{
+    Product:     "sparse3d"
+    Producer:    "test"
+    BatchSize:   {}
+    VoxelBudget: {}
+    Seed:        3
+  }}""".format(manifest_name, batch_size, voxel_budget))
+
+    config_file = tmpdir + "/test_queueio_sparsetensor3d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : True
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+    # prepare_manager already made the first batch current, so read it without popping:
+    n_batches = li._queueloaders['primary']._proc.sampler().n_batches()
+    seen = []
+    for i in range(n_batches):
+        data = li.fetch_minibatch_data('primary', pop=(i > 0), fetch_meta_data=True)
+        li.prepare_next('primary')
+        entries = list(data['entries'])
+        assert(len(entries) <= batch_size)
+        if voxel_budget > 0 and len(entries) > 1:
+            assert(sum([ n_voxels[e] for e in entries ]) <= voxel_budget)
+        assert(data['label'].shape[0] == sum([ n_voxels[e] for e in entries ]))
+        seen += entries
+
+    # One epoch reads every entry once:
+    assert(sorted(seen) == list(range(25)))
+
+
+@pytest.mark.parametrize('num_workers', [1, 3])
+def test_sparsetensor3d_queueio_augment(tmpdir, num_workers, batch_size=4, n_reads=5):
+
+    # An Augment block draws one transform per entry: a ragged filler and a sparse
+    # convolution filler of the same tensor must come out with the same voxels
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    file_name = str(tmpdir + "/test_queueio_sparsetensor3d_{}.h5".format(queueio_name))
+    create_sparsetensor3d_file(file_name, rand_num_events=25)
+
+    config_contents = queue_io_sparsetensor3d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100", "Ragged: true")
+    config_contents = config_contents.replace('ProcessType:     ["BatchFillerSparseTensor3D"]',
+        'ProcessType:     ["BatchFillerSparseTensor3D", "BatchFillerSparseTensor3D"]')
+    config_contents = config_contents.replace('ProcessName:     ["test_{name}"]'.format(name=queueio_name),
+        'ProcessName:     ["test_{name}", "conv_{name}"]'.format(name=queueio_name))
+    config_contents = config_contents.replace("ProcessList: {", """ProcessList: {{
+    conv_{name}: {{
+      TensorProducer: "test"
+      SparseConvFormat: true
+    }}""".format(name=queueio_name))
+    config_contents = config_contents.replace("RandomSeed:      0", """RandomSeed:      0
+  NumWorkers:      {}
+  Augment: {{
+    Flip:     [0, 1, 2]
+    Rotate:   true
+    MaxShift: [2, 2, 2]
+    Dropout:  0.25
+    Seed:     5
+  }}""".format(num_workers))
+
+    config_file = tmpdir + "/test_queueio_sparsetensor3d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : True
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        'conv' : 'conv_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+    assert(li._queueloaders['primary']._proc.has_augmentation())
+
+    for i in range(n_reads):
+        data = li.fetch_minibatch_data('primary', pop=True, fetch_meta_data=True)
+        li.prepare_next('primary')
+        offsets = data['label_offsets']
+        assert((offsets == data['conv_offsets']).all())
+        coordinates = data['conv_coordinates']
+        for j in range(batch_size):
+            label = data['label'][offsets[j]:offsets[j+1]]
+            conv  = coordinates[offsets[j]:offsets[j+1]]
+            assert((conv[:,0] == j).all())
+            assert((conv[:,1:] == label[:,0:3]).all())
+            assert((data['conv'][offsets[j]:offsets[j+1],0] == label[:,3]).all())
+
+
+def test_sparsetensor3d_queueio_worker_flips(tmpdir, batch_size=8, n_reads=5):
+
+    # Without an Augment block, a filler flips the axes at random on its own: each
+    # worker's filler draws from its own seed, so the two halves of the batch differ
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+
+    # Every entry is the one voxel at the origin, which a flip moves to the far end:
+    file_name = str(tmpdir + "/test_queueio_sparsetensor3d_{}.h5".format(queueio_name))
+    voxel_set_list = [ [ {'values' : [1.], 'indexes' : [0], 'n_voxels' : 1} ] for i in range(25) ]
+    data_generator.write_sparse_tensors(file_name, voxel_set_list, dimension=3, n_projections=1)
+
+    config_contents = queue_io_sparsetensor3d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        )
+    config_contents = config_contents.replace("MaxVoxels: 100", "Ragged: true")
+    config_contents = config_contents.replace("RandomSeed:      0", """RandomSeed:      0
+  NumWorkers:      2""")
+
+    config_file = tmpdir + "/test_queueio_sparsetensor3d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : True
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.no_warnings()
+    li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+    # Each worker fills a contiguous half of the batch:
+    flips = [[], []]
+    for i in range(n_reads):
+        data = li.fetch_minibatch_data('primary', pop=True, fetch_meta_data=True)
+        li.prepare_next('primary')
+        assert(data['label'].shape == (batch_size, 4))
+        for j in range(batch_size):
+            flips[2 * j // batch_size].append(tuple(data['label'][j,0:3] == 127))
+
+    assert(flips[0] != flips[1])
+
+
 @pytest.mark.distributed_test
 @pytest.mark.parametrize('make_copy', [True, False])
 @pytest.mark.parametrize('local_batch_size', [2])
@@ -2,6 +2,7 @@ import pytest
 import unittest
 import random
 import uuid
+import numpy
 
 import larcv
 from larcv import queueloader,  data_generator
@@ -100,6 +101,47 @@ def test_tensor2d_queueio(tmpdir, make_copy, batch_size, n_projections, from_den
         assert(data['label'].shape[0] == batch_size)
 
 
+@pytest.mark.parametrize('n_projections', [1, 2])
+def test_tensor2d_queueio_dense_values(tmpdir, n_projections):
+
+    # The batch holds each image in its numpy orientation, with the projections last:
+    queueio_name = "queueio_{}".format(uuid.uuid4())
+    file_name = str(tmpdir + "/test_queueio_tensor2d_{}.h5".format(queueio_name))
+
+    images = data_generator.build_tensor(5, n_projections=n_projections, dimension=2, shape=[7, 13])
+    data_generator.write_tensor(file_name, images, dimension=2)
+
+    config_contents = queue_io_tensor2d_cfg_template.format(
+        name        = queueio_name,
+        input_files = file_name,
+        producer    = "test",
+        type        = "dense",
+        channels    = list(range(n_projections)),
+        )
+    config_file = tmpdir + "/test_queueio_tensor2d_{}.cfg".format(queueio_name)
+    with open(str(config_file), 'w') as _f:
+        _f.write(config_contents)
+
+    io_config = {
+        'filler_name' : queueio_name,
+        'filler_cfg'  : str(config_file),
+        'verbosity'   : 3,
+        'make_copy'   : False
+    }
+    data_keys = OrderedDict({
+        'label': 'test_{}'.format(queueio_name),
+        })
+
+    li = queueloader.queue_interface()
+    li.prepare_manager('primary', io_config, 2, data_keys)
+
+    data = li.fetch_minibatch_data('primary', pop=True, fetch_meta_data=True)
+    assert(data['label'].shape == (2, 7, 13, n_projections))
+    for i, entry in enumerate(data['entries']):
+        assert((data['label'][i] == numpy.stack(images[entry], axis=-1)).all())
+
+
+
 if __name__ == "__main__":
     test_tensor2d_queueio("./", make_copy=False, batch_size=2, n_projections=1, from_dense=False, n_reads=10)
     test_tensor2d_queueio("./", make_copy=False, batch_size=2, n_projections=2, from_dense=False, n_reads=10)
@@ -101,6 +101,54 @@ def test_tensor3d_queueio(tmpdir, make_copy, batch_size, from_dense, n_reads=2):
         assert(data['label'].shape[0] == batch_size)
 
 
+@pytest.mark.parametrize('num_workers', [2, 3])
+def test_tensor3d_queueio_num_workers(tmpdir, num_workers, batch_size=4, n_reads=3):
+
+    # Every worker's dense filler must size itself, and give exactly the serial result
+    file_name = str(tmpdir + "/test_queueio_tensor3d_workers.h5")
+    create_dense_tensor3d_file(file_name, rand_num_events=25, n_projections=2)
+
+    results = []
+    for workers in [1, num_workers]:
+        queueio_name = "queueio_{}".format(uuid.uuid4())
+
+        config_contents = queue_io_tensor3d_cfg_template.format(
+            name        = queueio_name,
+            input_files = file_name,
+            producer    = "test",
+            type        = "dense",
+            )
+        config_contents = config_contents.replace("RandomSeed:      0", "RandomSeed:      0\n  NumWorkers:      {}".format(workers))
+
+        config_file = tmpdir + "/test_queueio_tensor3d_{}.cfg".format(queueio_name)
+        with open(str(config_file), 'w') as _f:
+            _f.write(config_contents)
+
+        io_config = {
+            'filler_name' : queueio_name,
+            'filler_cfg'  : str(config_file),
+            'verbosity'   : 3,
+            'make_copy'   : True
+        }
+        data_keys = OrderedDict({
+            'label': 'test_{}'.format(queueio_name),
+            })
+
+        li = queueloader.queue_interface(random_access_mode="serial_access")
+        li.no_warnings()
+        li.prepare_manager('primary', io_config, batch_size, data_keys)
+
+        reads = []
+        for i in range(n_reads):
+            reads.append(li.fetch_minibatch_data('primary', pop=True)['label'])
+            li.prepare_next('primary')
+        results.append(reads)
+
+    for serial, parallel in zip(*results):
+        assert(serial.shape[-1] == 2)
+        assert((serial == parallel).all())
+
+
 if __name__ == "__main__":
     test_tensor3d_queueio("./", make_copy=False, batch_size=1, from_dense=False, n_reads=2)
     print("Success")
@@ -165,6 +165,36 @@ def test_ravel(dimension, execution_number):
             assert(np_raveled == im_raveled)
 
 
+@pytest.mark.parametrize('dimension', [1,2,3,4])
+@pytest.mark.parametrize('execution_number', range(N_CHECKS))
+def test_unravel_ravel_kernels(dimension, execution_number):
+
+    im = image_meta_factory(dimension)
+
+    total_voxels = 1
+    dims = []
+
+    for dim in range(dimension):
+        L = random.uniform(0.001, 1e4)
+        N = random.randint(1, 2e4)
+        im.set_dimension(dim, L, N)
+        total_voxels *= N
+        dims.append(N)
+
+    # The fixed size kernels must agree with numpy and with each other:
+    strides = im.ravel_strides()
+    for i in range(50):
+        flat_index = random.randint(0, total_voxels-1)
+        np_unraveled = numpy.unravel_index(flat_index, dims)
+        im_unraveled = im.unravel(flat_index)
+
+        for d in range(dimension):
+            assert(np_unraveled[d] == im_unraveled[d])
+
+        assert(im.ravel(im_unraveled) == flat_index)
+        assert(sum(c*s for c, s in zip(im_unraveled, strides)) == flat_index)
+
+
 @pytest.mark.parametrize('dimension', [1,2,3,4])
 @pytest.mark.parametrize('execution_number', range(N_CHECKS))
 def test_compress(dimension, execution_number):
@@ -44,6 +44,19 @@ def test_Tensor(dimension):
     # Verify the tensor and array match by checking elements:
     return True
 
+@pytest.mark.parametrize('dimension', [2, 3, 4])
+def test_Tensor_from_strided_array(dimension):
+
+    # Transposed and sliced views are copied element by element, not as raw memory:
+    shape = [ random.randint(2, 12) for dim in range(dimension) ]
+    raw_image = numpy.random.random(shape).astype("float32")
+
+    tensor_class = getattr(larcv, "Tensor{}D".format(dimension))
+    for view in [raw_image.transpose(), raw_image[::-1, ::2], numpy.moveaxis(raw_image, 0, -1)]:
+        t = tensor_class(view)
+        assert t.size() == view.size
+        assert (t.as_array() == view).all()
+
 @pytest.mark.parametrize('dimension', [1, 2, 3, 4])
 @pytest.mark.parametrize('pooling', [larcv.kPoolAverage, larcv.kPoolMax, larcv.kPoolSum])
 def test_tensor_compression(dimension, pooling):
@@ -45,6 +45,23 @@ def test_Voxel_h_VoxelSet():
     assert(vs.size() == n_voxels) 
 
 
+def test_Voxel_h_VoxelSet_sort():
+
+    vs = larcv.VoxelSet()
+
+    # Set bypasses the sorted insert, so this leaves the set out of order:
+    indexes = numpy.asarray([5, 3, 9, 3, 0], dtype=numpy.uint64)
+    values  = numpy.asarray([1, 2, 3, 4, 5], dtype=numpy.float32)
+    vs.set(indexes, values)
+    assert(not vs.is_sorted())
+
+    vs.sort()
+    assert(vs.is_sorted())
+    assert(vs.size() == 4)
+    assert(vs.find(3).value() == 6.)
+    assert(abs(vs.sum() - numpy.sum(values)) < 1e-6)
+
+
 def test_Voxel_h_VoxelSetArray():
 
     vsa = larcv.VoxelSetArray()
@@ -133,3 +150,36 @@ def test_sparse_tensor_downsample(dimension, pooling):
 
 
 
+
+@pytest.mark.parametrize('dimension', [2,3])
+@pytest.mark.parametrize('pooling', [larcv.kPoolAverage, larcv.kPoolMax, larcv.kPoolSum])
+def test_sparse_tensor_downsample_levels(dimension, pooling):
+
+    # Create image Meta:
+    meta = image_meta_factory(dimension)
+    meta.set_projection_id(0)
+    for dim in range(dimension):
+        meta.set_dimension(dim, 10., 128)
+
+    if dimension == 2:
+        st = larcv.SparseTensor2D()
+    if dimension == 3:
+        st = larcv.SparseTensor3D()
+    st.meta(meta)
+
+    voxel_set_list = data_generator.build_sparse_tensor(1, n_projections = 1)
+    indexes = voxel_set_list[0][0]['indexes']
+    values = voxel_set_list[0][0]['values']
+    n_voxels = voxel_set_list[0][0]['n_voxels']
+    for j in range(n_voxels):
+        st.emplace(larcv.Voxel(indexes[j], numpy.abs(values[j])), False)
+
+    # Each level of the pyramid must match compressing the original directly:
+    levels = st.compress_levels(2, 3, pooling)
+    assert len(levels) == 3
+    for i, level in enumerate(levels):
+        direct = st.compress(2**(i+1), pooling)
+        for dim in range(dimension):
+            assert level.meta().number_of_voxels(dim) == direct.meta().number_of_voxels(dim)
+        assert level.size() == direct.size()
+        assert numpy.allclose(level.dense(), direct.dense(), rtol=1e-5)
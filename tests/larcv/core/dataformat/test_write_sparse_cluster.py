@@ -76,6 +76,89 @@ def test_read_write_sparse_clusters(tmpdir, rand_num_events, dimension, n_projec
                 assert( abs( numpy.std(input_voxelset['values']) - numpy.std(read_voxelset['values']) ) < 1e-3 )
 
 
+@pytest.mark.parametrize('voxel_encoding', [larcv.kVoxelIndex32, larcv.kVoxelDelta32])
+@pytest.mark.parametrize('dimension', [2,3])
+def test_read_write_sparse_clusters_voxel_encoding(tmpdir, rand_num_events, voxel_encoding, dimension):
+
+    import numpy
+
+    n_projections = 3
+    voxel_set_array_list = data_generator.build_sparse_cluster_list(rand_num_events, n_projections)
+    random_file_name = str(tmpdir + "/test_write_sparse_clusters_voxel_encoding.h5")
+
+    data_generator.write_sparse_clusters(random_file_name, voxel_set_array_list, dimension, n_projections, voxel_encoding)
+    read_voxel_set_array_list = data_generator.read_sparse_clusters(random_file_name, dimension)
+
+    assert(len(read_voxel_set_array_list) == rand_num_events)
+    for event in range(rand_num_events):
+        for projection in range(n_projections):
+            assert(len(read_voxel_set_array_list[event][projection]) == len(voxel_set_array_list[event][projection]))
+            for cluster in range(len(read_voxel_set_array_list[event][projection])):
+                input_voxelset = voxel_set_array_list[event][projection][cluster]
+                read_voxelset = read_voxel_set_array_list[event][projection][cluster]
+                assert(read_voxelset['n_voxels'] == input_voxelset['n_voxels'])
+                # Deltas restart at every cluster, so every cluster must decode on its own:
+                assert(sorted(input_voxelset['indexes']) == list(read_voxelset['indexes']))
+                assert( abs( numpy.sum(input_voxelset['values']) - numpy.sum(read_voxelset['values']) ) < 1e-3 )
+
+@pytest.mark.parametrize('dimension', [2,3])
+@pytest.mark.parametrize('preload_bytes', [0, 10**6])
+def test_read_write_sparse_clusters_meta_dictionary(tmpdir, rand_num_events, dimension, preload_bytes):
+
+    # Written with a meta dictionary, every projection reads back its clusters and
+    # its own meta through either kind of index
+    n_projections = 3
+    voxel_set_array_list = data_generator.build_sparse_cluster_list(rand_num_events, n_projections)
+    random_file_name = str(tmpdir + "/test_write_sparse_clusters_meta_dictionary.h5")
+    data_generator.write_sparse_clusters(random_file_name, voxel_set_array_list, dimension, n_projections,
+                                         meta_dictionary=True)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.set_preload_index(preload_bytes)
+    io_manager.initialize()
+    assert(io_manager.get_n_entries() == rand_num_events)
+    for event in reversed(range(rand_num_events)):
+        io_manager.read_entry(event)
+        ev_cluster = io_manager.get_data("cluster{}d".format(dimension), "test")
+        assert(ev_cluster.size() == n_projections)
+        for projection in range(n_projections):
+            sparse_cluster = ev_cluster.sparse_cluster(projection)
+            assert(sparse_cluster.meta().projection_id() == projection)
+            assert([sparse_cluster.meta().number_of_voxels(d) for d in range(dimension)] == [128] * dimension)
+            assert(sparse_cluster.size() == len(voxel_set_array_list[event][projection]))
+            for cluster in range(sparse_cluster.size()):
+                input_voxelset = voxel_set_array_list[event][projection][cluster]
+                read_voxelset = sparse_cluster.voxel_set(cluster)
+                assert(sorted(input_voxelset['indexes']) == sorted([v.id() for v in read_voxelset.as_vector()]))
+    io_manager.finalize()
+
+@pytest.mark.parametrize('dimension', [2,3])
+def test_read_write_sparse_clusters_empty(tmpdir, rand_num_events, dimension):
+
+    # Events and projections without any clusters, and clusters without voxels,
+    # must read back as such and not disturb their neighbours
+    n_projections = 3
+    voxel_set_array_list = data_generator.build_sparse_cluster_list(rand_num_events, n_projections)
+    for event in range(0, rand_num_events, 2):
+        for projection in range(n_projections):
+            voxel_set_array_list[event][projection] = []
+    for event in range(1, rand_num_events, 3):
+        voxel_set_array_list[event][1] = []
+        voxel_set_array_list[event][0][0] = {'values' : [], 'indexes' : [], 'n_voxels' : 0}
+
+    random_file_name = str(tmpdir + "/test_write_sparse_clusters_empty.h5")
+    data_generator.write_sparse_clusters(random_file_name, voxel_set_array_list, dimension, n_projections)
+    read_voxel_set_array_list = data_generator.read_sparse_clusters(random_file_name, dimension)
+
+    assert(len(read_voxel_set_array_list) == rand_num_events)
+    for event in range(rand_num_events):
+        for projection in range(n_projections):
+            assert(len(read_voxel_set_array_list[event][projection]) == len(voxel_set_array_list[event][projection]))
+            for cluster in range(len(read_voxel_set_array_list[event][projection])):
+                input_voxelset = voxel_set_array_list[event][projection][cluster]
+                read_voxelset = read_voxel_set_array_list[event][projection][cluster]
+                assert(sorted(input_voxelset['indexes']) == list(read_voxelset['indexes']))
 
 
 if __name__ == '__main__':
@@ -61,6 +61,290 @@ def test_read_write_sparse_tensors(tmpdir, rand_num_events, dimension, n_project
 
 
 
+@pytest.mark.parametrize('chunk_size', [0, 7, 100000])
+@pytest.mark.parametrize('cache_bytes', [0, 1024])
+def test_read_write_sparse_tensors_chunking(tmpdir, rand_num_events, chunk_size, cache_bytes):
+
+    # Chunk and cache settings must never change what is read back
+    random_file_name = str(tmpdir + "/test_write_read_sparse_tensors_chunking.h5")
+
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 2)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, 2, 2,
+                                        chunk_size = chunk_size, index_chunk_size = 3)
+    read_voxel_set_list = data_generator.read_sparse_tensors(random_file_name, 2,
+                                                             chunk_cache_bytes = cache_bytes)
+
+    assert(len(read_voxel_set_list) == rand_num_events)
+    for i in range(rand_num_events):
+        for projection in range(2):
+            assert(read_voxel_set_list[i][projection]['n_voxels'] == voxel_set_list[i][projection]['n_voxels'])
+            assert(read_voxel_set_list[i][projection]['indexes'] == sorted(voxel_set_list[i][projection]['indexes']))
+
+
+@pytest.mark.parametrize('buffer_bytes, buffer_entries', [(0, 0), (0, 1), (0, 4), (4096, 0), (10**9, 0)])
+def test_read_write_sparse_tensors_write_buffer(tmpdir, rand_num_events, buffer_bytes, buffer_entries):
+
+    # Buffering the output must never change what is written (anything left in
+    # the buffer is written by finalize)
+    random_file_name = str(tmpdir + "/test_write_read_sparse_tensors_write_buffer.h5")
+
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 2)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, 2, 2,
+                                        write_buffer = (buffer_bytes, buffer_entries))
+    read_voxel_set_list = data_generator.read_sparse_tensors(random_file_name, 2)
+
+    # The event IDs are buffered too:
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.initialize()
+    for i in range(rand_num_events):
+        io_manager.read_entry(i)
+        assert(io_manager.event_id().event() == i)
+    io_manager.finalize()
+
+    assert(len(read_voxel_set_list) == rand_num_events)
+    for i in range(rand_num_events):
+        for projection in range(2):
+            assert(read_voxel_set_list[i][projection]['n_voxels'] == voxel_set_list[i][projection]['n_voxels'])
+            assert(read_voxel_set_list[i][projection]['indexes'] == sorted(voxel_set_list[i][projection]['indexes']))
+
+
+@pytest.mark.parametrize('voxel_encoding', [larcv.kVoxelLegacy, larcv.kVoxelIndex32, larcv.kVoxelDelta32])
+@pytest.mark.parametrize('dimension', [2, 3])
+def test_read_write_sparse_tensors_voxel_encoding(tmpdir, rand_num_events, voxel_encoding, dimension):
+
+    # Every encoding reads back the same voxels, and the reader needs no configuration
+    random_file_name = str(tmpdir + "/test_write_read_sparse_tensors_voxel_encoding.h5")
+
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 3)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, dimension, 3, voxel_encoding)
+    read_voxel_set_list = data_generator.read_sparse_tensors(random_file_name, dimension)
+
+    assert(len(read_voxel_set_list) == rand_num_events)
+    for event in range(rand_num_events):
+        for projection in range(3):
+            input_voxelset = voxel_set_list[event][projection]
+            read_voxelset = read_voxel_set_list[event][projection]
+            order = sorted(range(input_voxelset['n_voxels']), key=lambda j : input_voxelset['indexes'][j])
+            assert(list(read_voxelset['indexes']) == [input_voxelset['indexes'][j] for j in order])
+            for j, value in zip(order, read_voxelset['values']):
+                assert(abs(value - input_voxelset['values'][j]) < 1e-3)
+
+
+@pytest.mark.parametrize('n_threads', [2, 4])
+def test_read_sparse_tensors_threaded(tmpdir, rand_num_events, n_threads):
+
+    # Independent IOManagers, one per thread, must read their own files correctly.
+    # (bin/benchmark_threaded_read.py times how well they overlap.)
+    import threading
+
+    file_names = [ str(tmpdir + "/test_read_sparse_tensors_threaded_{}.h5".format(i)) for i in range(n_threads) ]
+    for file_name in file_names:
+        voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 2)
+        data_generator.write_sparse_tensors(file_name, voxel_set_list, 3, 2)
+
+    serial_results = [ data_generator.read_sparse_tensors(file_name, 3) for file_name in file_names ]
+
+    threaded_results = [ None ] * n_threads
+    def read(i):
+        threaded_results[i] = data_generator.read_sparse_tensors(file_names[i], 3)
+
+    threads = [ threading.Thread(target=read, args=(i,)) for i in range(n_threads) ]
+    for thread in threads: thread.start()
+    for thread in threads: thread.join()
+
+    assert(threaded_results == serial_results)
+
+
+@pytest.mark.parametrize('max_open_files', [0, 1, 2])
+def test_read_sparse_tensors_multi_file_random(tmpdir, max_open_files):
+
+    # Random access across files, with fewer files allowed open than there are,
+    # must find the right file and entry every time.  The files use different
+    # voxel encodings, which the products must keep track of per file.
+    encodings = [larcv.kVoxelLegacy, larcv.kVoxelIndex32, larcv.kVoxelDelta32, larcv.kVoxelLegacy]
+
+    file_names = []
+    expected = []
+    for i, voxel_encoding in enumerate(encodings):
+        file_name = str(tmpdir + "/test_read_sparse_tensors_multi_file_{}.h5".format(i))
+        voxel_set_list = data_generator.build_sparse_tensor(random.randint(1, 10), n_projections = 1)
+        data_generator.write_sparse_tensors(file_name, voxel_set_list, 3, 1, voxel_encoding)
+        file_names.append(file_name)
+        expected += data_generator.read_sparse_tensors(file_name, 3)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    for file_name in file_names:
+        io_manager.add_in_file(file_name)
+    io_manager.set_max_open_files(max_open_files)
+    io_manager.initialize()
+    assert(io_manager.get_n_entries() == len(expected))
+
+    entries = list(range(len(expected))) * 2
+    random.shuffle(entries)
+    for entry in entries:
+        io_manager.read_entry(entry)
+        ev_sparse = io_manager.get_data("sparse3d","test")
+        voxels = ev_sparse.sparse_tensor(0).as_vector()
+        assert(len(voxels) == expected[entry][0]['n_voxels'])
+        for j, voxel in enumerate(voxels):
+            assert(voxel.id() == expected[entry][0]['indexes'][j])
+            assert(voxel.value() == expected[entry][0]['values'][j])
+
+    io_manager.finalize()
+
+
+def test_read_sparse_tensors_read_entries(tmpdir):
+
+    # Entries read ahead in blocks, including blocks that cross into the next file,
+    # repeats and lone entries, must be the same as entries read one by one.
+    file_names = []
+    expected = []
+    for i in range(3):
+        file_name = str(tmpdir + "/test_read_sparse_tensors_read_entries_{}.h5".format(i))
+        voxel_set_list = data_generator.build_sparse_tensor(random.randint(1, 10), n_projections = 2)
+        data_generator.write_sparse_tensors(file_name, voxel_set_list, 3, 2)
+        file_names.append(file_name)
+        expected += data_generator.read_sparse_tensors(file_name, 3)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    for file_name in file_names:
+        io_manager.add_in_file(file_name)
+    io_manager.initialize()
+
+    entries = list(range(len(expected)))
+    blocks = [entries[i:i + 4] for i in range(0, len(entries), 4)]
+    blocks += [entries[::3], entries[::-1], [0, 0, 1]]
+    for block in blocks:
+        assert(io_manager.read_entries(block))
+        for entry in block:
+            io_manager.read_entry(entry)
+            ev_sparse = io_manager.get_data("sparse3d","test")
+            for projection in range(2):
+                voxels = ev_sparse.sparse_tensor(projection).as_vector()
+                assert(len(voxels) == expected[entry][projection]['n_voxels'])
+                assert([v.id() for v in voxels] == list(expected[entry][projection]['indexes']))
+
+    io_manager.finalize()
+
+
+@pytest.mark.parametrize('preload_bytes', [0, 64, 10**6])
+def test_read_sparse_tensors_preload_index(tmpdir, rand_num_events, preload_bytes):
+
+    # Entries read through a preloaded index are the same as entries read through the
+    # extents tables, and an index over the limit is not loaded at all
+    random_file_name = str(tmpdir + "/test_read_sparse_tensors_preload_index.h5")
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 2)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, 3, 2)
+    expected = data_generator.read_sparse_tensors(random_file_name, 3)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.set_preload_index(preload_bytes)
+    io_manager.initialize()
+    for entry in reversed(range(rand_num_events)):
+        io_manager.read_entry(entry)
+        ev_sparse = io_manager.get_data("sparse3d","test")
+        for projection in range(2):
+            voxels = ev_sparse.sparse_tensor(projection).as_vector()
+            assert([v.id() for v in voxels] == list(expected[entry][projection]['indexes']))
+
+    # 16 bytes for the extents of each entry, 16 for those of each projection:
+    index_bytes = io_manager.preloaded_index_bytes()
+    if preload_bytes >= 48 * rand_num_events:
+        assert(index_bytes == 48 * rand_num_events)
+    else:
+        assert(index_bytes == 0)
+    io_manager.finalize()
+
+
+@pytest.mark.parametrize('preload_bytes', [0, 10**6])
+def test_read_sparse_tensors_meta_dictionary(tmpdir, rand_num_events, preload_bytes):
+
+    # A file written with a meta dictionary reads back the same voxels and metas as
+    # one written with the image_meta table, through either kind of index
+    expected_file_name = str(tmpdir + "/test_read_sparse_tensors_meta_table.h5")
+    random_file_name = str(tmpdir + "/test_read_sparse_tensors_meta_dictionary.h5")
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 2)
+    data_generator.write_sparse_tensors(expected_file_name, voxel_set_list, 3, 2)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, 3, 2, meta_dictionary=True)
+    expected = data_generator.read_sparse_tensors(expected_file_name, 3)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.set_preload_index(preload_bytes)
+    io_manager.initialize()
+    for entry in reversed(range(rand_num_events)):
+        io_manager.read_entry(entry)
+        ev_sparse = io_manager.get_data("sparse3d","test")
+        for projection in range(2):
+            tensor = ev_sparse.sparse_tensor(projection)
+            assert([v.id() for v in tensor.as_vector()] == list(expected[entry][projection]['indexes']))
+            assert(tensor.meta().projection_id() == projection)
+            assert([tensor.meta().number_of_voxels(d) for d in range(3)] == [128, 128, 128])
+    io_manager.finalize()
+
+
+def test_read_sparse_tensors_manifest(tmpdir):
+
+    # Reading through a manifest must give the same entries as opening every
+    # file, its voxel counts must match what is read, and a file that changed
+    # since the manifest was made must be refused when it is opened.
+    import os
+
+    file_names = []
+    expected = []
+    for i in range(3):
+        file_name = str(tmpdir + "/test_read_sparse_tensors_manifest_{}.h5".format(i))
+        voxel_set_list = data_generator.build_sparse_tensor(random.randint(1, 10), n_projections = 1)
+        data_generator.write_sparse_tensors(file_name, voxel_set_list, 3, 1)
+        file_names.append(file_name)
+        expected += data_generator.read_sparse_tensors(file_name, 3)
+
+    manifest_name = str(tmpdir + "/test_read_sparse_tensors_manifest.h5")
+    manifest = larcv.Manifest()
+    manifest.build(file_names)
+    manifest.write(manifest_name)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.set_manifest(manifest_name)
+    io_manager.initialize()
+    assert(io_manager.get_n_entries() == len(expected))
+    counts = io_manager.voxel_counts("sparse3d", "test")
+    assert(len(counts) == len(expected))
+    for entry in range(len(expected)):
+        io_manager.read_entry(entry)
+        voxels = io_manager.get_data("sparse3d","test").sparse_tensor(0).as_vector()
+        assert(len(voxels) == expected[entry][0]['n_voxels'])
+        assert(counts[entry] == expected[entry][0]['n_voxels'])
+    io_manager.finalize()
+
+    os.utime(file_names[-1], (0, 0))
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.set_manifest(manifest_name)
+    io_manager.initialize()
+    with pytest.raises(Exception):
+        io_manager.read_entry(len(expected) - 1)
+    io_manager.finalize()
+
+
+def test_read_entry_out_of_range_releases_lock(tmpdir, rand_num_events):
+
+    # A failed read_entry must leave the IOManager usable
+    random_file_name = str(tmpdir + "/test_read_entry_out_of_range.h5")
+    voxel_set_list = data_generator.build_sparse_tensor(rand_num_events, n_projections = 1)
+    data_generator.write_sparse_tensors(random_file_name, voxel_set_list, 2, 1)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.initialize()
+    assert(not io_manager.read_entry(rand_num_events + 1))
+    assert(io_manager.read_entry(0))
+    ev_sparse = io_manager.get_data("sparse2d","test")
+    assert(ev_sparse.sparse_tensor(0).size() == voxel_set_list[0][0]['n_voxels'])
+    io_manager.finalize()
+
+
 if __name__ == '__main__':
     tmpdir = "./"
     rand_num_events = 5
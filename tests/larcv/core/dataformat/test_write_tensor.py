@@ -60,6 +60,78 @@ def test_write_read_tensor(tmpdir, rand_num_events, dimension, n_projections):
         break
 
 
+@pytest.mark.parametrize('dimension', [1, 2, 3])
+@pytest.mark.parametrize('preload_bytes', [0, 10**6])
+def test_write_read_tensor_meta_dictionary(tmpdir, rand_num_events, dimension, preload_bytes):
+
+    # Written with a meta dictionary (every image shares one meta here), the images
+    # and their shapes read back the same through either kind of index
+    import numpy
+
+    random_file_name = str(tmpdir + "/test_write_read_tensor_meta_dictionary.h5")
+
+    n_projections = 2
+    event_image_list = data_generator.build_tensor(rand_num_events, n_projections=n_projections, dimension=dimension)
+    data_generator.write_tensor(random_file_name, event_image_list, dimension, meta_dictionary=True)
+
+    io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+    io_manager.add_in_file(random_file_name)
+    io_manager.set_preload_index(preload_bytes)
+    io_manager.initialize()
+    assert(io_manager.get_n_entries() == rand_num_events)
+    product = {1 : "tensor1d", 2 : "image2d", 3 : "tensor3d"}[dimension]
+    for event in reversed(range(rand_num_events)):
+        io_manager.read_entry(event)
+        ev_tensor = io_manager.get_data(product, "test")
+        assert(ev_tensor.size() == n_projections)
+        for projection in range(n_projections):
+            input_image = event_image_list[event][projection]
+            read_image = ev_tensor.tensor(projection).as_array()
+            assert(input_image.shape == read_image.shape)
+            assert(numpy.allclose(input_image, read_image))
+    io_manager.finalize()
+
+
+def test_read_tensor_threaded(tmpdir):
+
+    # read_entry, get_data and compress all release the GIL, so two threads can drive
+    # independent IOManagers at once; each must still read exactly its own file.
+    # (bin/benchmark_threaded_read.py times how well they overlap.)
+    import threading
+    import numpy
+
+    n_events = 5
+    shape = [32, 32, 32]
+
+    file_names = [ str(tmpdir + "/test_read_tensor_threaded_{}.h5".format(i)) for i in range(2) ]
+    for file_name in file_names:
+        event_image_list = [ [ numpy.random.random_sample(shape).astype("float32") ] for i in range(n_events) ]
+        data_generator.write_tensor(file_name, event_image_list, 3)
+
+    def read(file_name, pixels):
+        io_manager = larcv.IOManager(larcv.IOManager.kREAD)
+        io_manager.add_in_file(file_name)
+        io_manager.initialize()
+        for i in range(io_manager.get_n_entries()):
+            io_manager.read_entry(i)
+            ev_tensor = io_manager.get_data("tensor3d","test")
+            compressed = ev_tensor.tensor(0).compress(2, larcv.kPoolAverage).compress(2, larcv.kPoolMax)
+            pixels.append((compressed.pixel(0), compressed.pixel(compressed.size() - 1)))
+        io_manager.finalize()
+
+    serial_pixels = [ [], [] ]
+    for file_name, pixels in zip(file_names, serial_pixels):
+        read(file_name, pixels)
+
+    threaded_pixels = [ [], [] ]
+    threads = [ threading.Thread(target=read, args=(file_name, pixels))
+                for file_name, pixels in zip(file_names, threaded_pixels) ]
+    for thread in threads: thread.start()
+    for thread in threads: thread.join()
+
+    assert(threaded_pixels == serial_pixels)
+
+
 
 
 
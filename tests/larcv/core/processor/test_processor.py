@@ -25,4 +25,62 @@ def test_process_driver():
     import larcv
 
     lib = larcv.ProcessDriver("test")
-    
\ No newline at end of file
+    
+def test_shard_sampler():
+    import larcv
+
+    # Shards of every rank are disjoint, of equal size, and the same on every call
+    file_entries = [ 5 + i % 7 for i in range(30) ]
+    total = sum(file_entries)
+    n_shards = 4
+
+    seen = set()
+    for shard in range(n_shards):
+        sampler = larcv.ShardSampler()
+        sampler.set_file_entries(file_entries)
+        sampler.set_shard(shard, n_shards, 5)
+        entries = list(sampler.entries())
+        assert(len(entries) == total // n_shards)
+        assert(seen.isdisjoint(entries))
+        seen.update(entries)
+
+        again = larcv.ShardSampler()
+        again.set_file_entries(file_entries)
+        again.set_shard(shard, n_shards, 5)
+        assert(list(again.entries()) == entries)
+
+        # The next epoch draws a new shard after the last full batch:
+        for i in range(sampler.n_batches()):
+            sampler.next_batch()
+        sampler.next_batch()
+        assert(sampler.epoch() == 1)
+
+def test_shard_sampler_block_shuffle():
+    import larcv
+
+    # Chunk-aligned groups stay close together, but every entry is read once:
+    file_entries = [ 100 + 13 * i for i in range(10) ]
+    offsets = [ sum(file_entries[:i]) for i in range(len(file_entries)) ]
+    group_size = 16
+
+    cfg = larcv.PSet("ShardSampler")
+    cfg["GroupSize"] = str(group_size)
+    cfg["Seed"]      = "3"
+    sampler = larcv.ShardSampler()
+    sampler.configure(cfg)
+    sampler.set_file_entries(file_entries)
+    assert(sampler.window() == 8 * group_size)
+
+    entries = list(sampler.entries())
+    assert(sorted(entries) == list(range(sum(file_entries))))
+    assert(entries != sorted(entries))
+
+    def group(entry):
+        i_file = max(i for i in range(len(offsets)) if offsets[i] <= entry)
+        return (i_file, (entry - offsets[i_file]) // group_size)
+
+    # A window holds its own groups, plus the partial ones at the ends of files:
+    window = sampler.window()
+    for first in range(0, len(entries), window):
+        groups = set(group(entry) for entry in entries[first:first + window])
+        assert(len(groups) <= 2 * window // group_size)